@@ -0,0 +1,290 @@
+#include "checksum.h"
+
+#include <QObject>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CHECKSUM_HAVE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+using namespace Qt::StringLiterals;
+
+namespace {
+
+// Entry k of a byte is its CRC followed by k zero bytes, so eight bytes are
+// looked up independently and XORed together
+template <typename T, int Width, T Polynomial, bool IsReflected>
+struct SlicingTables {
+    T entries[8][256];
+
+    constexpr SlicingTables() : entries() {
+        constexpr T kTopBit = T(T(1) << (Width - 1));
+        for (int value = 0; value < 256; value++) {
+            T crc = IsReflected ? T(value) : T(T(value) << (Width - 8));
+            for (int bit = 0; bit < 8; bit++) {
+                if (IsReflected == true) {
+                    crc = (crc & 1) ? T((crc >> 1) ^ Polynomial) : T(crc >> 1);
+                } else {
+                    crc = (crc & kTopBit) ? T((crc << 1) ^ Polynomial) : T(crc << 1);
+                }
+            }
+            entries[0][value] = crc;
+        }
+        for (int k = 1; k < 8; k++) {
+            for (int value = 0; value < 256; value++) {
+                const T previous = entries[k - 1][value];
+                entries[k][value] = IsReflected ? T((previous >> 8) ^ entries[0][previous & 0xFF])
+                                                : T((previous << 8) ^ entries[0][previous >> (Width - 8)]);
+            }
+        }
+    }
+};
+
+constexpr SlicingTables<quint16, 16, 0xA001, true>      kModbusTables;
+constexpr SlicingTables<quint16, 16, 0x1021, false>     kCcittTables;
+constexpr SlicingTables<quint32, 32, 0xEDB88320, true> kCrc32Tables;
+
+quint32 crc32Tables(const uchar *p, qsizetype size, quint32 crc) {
+    const auto &t = kCrc32Tables.entries;
+    for (; size >= 8; p += 8, size -= 8) {
+        crc = t[7][p[0] ^ (crc & 0xFF)] ^ t[6][p[1] ^ ((crc >> 8) & 0xFF)] ^ t[5][p[2] ^ ((crc >> 16) & 0xFF)] ^
+              t[4][p[3] ^ (crc >> 24)] ^ t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+    }
+    for (; size > 0; p++, size--) crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xFF];
+    return crc;
+}
+
+#ifdef CHECKSUM_HAVE_X86_KERNELS
+
+// x carried over 128 bits further, onto next
+__attribute__((target("pclmul"))) inline __m128i fold(__m128i x, __m128i k, __m128i next) {
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x11), next), _mm_clmulepi64_si128(x, k, 0x00));
+}
+
+// Folds 64 bytes at a time with carry-less multiplies, then reduces the
+// remaining 128 bits with Barrett's method. The constants are the powers of x
+// modulo the reflected polynomial from Intel's "Fast CRC Computation for
+// Generic Polynomials Using PCLMULQDQ". Takes and returns the CRC register,
+// not the final value; size is at least 64 and a multiple of 16.
+__attribute__((target("pclmul,sse4.1"))) quint32 crc32Pclmul(const uchar *p, qsizetype size, quint32 crc) {
+    alignas(16) static const quint64 k1k2[] = {0x0154442bd4, 0x01c6e41596};
+    alignas(16) static const quint64 k3k4[] = {0x01751997d0, 0x00ccaa009e};
+    alignas(16) static const quint64 k5k0[] = {0x0163cd6124, 0x0000000000};
+    alignas(16) static const quint64 poly[] = {0x01db710641, 0x01f7011641};
+
+    __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x00));
+    __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x10));
+    __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x20));
+    __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x30));
+    x1         = _mm_xor_si128(x1, _mm_cvtsi32_si128(int(crc)));
+    __m128i x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(k1k2));
+    p += 64;
+    size -= 64;
+
+    // Four lanes of 16 bytes, each folded over the next 64 bytes
+    for (; size >= 64; p += 64, size -= 64) {
+        x1 = fold(x1, x0, _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x00)));
+        x2 = fold(x2, x0, _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x10)));
+        x3 = fold(x3, x0, _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x20)));
+        x4 = fold(x4, x0, _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 0x30)));
+    }
+
+    // The four lanes into one, then 16 bytes at a time
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(k3k4));
+    x1 = fold(x1, x0, x2);
+    x1 = fold(x1, x0, x3);
+    x1 = fold(x1, x0, x4);
+    for (; size >= 16; p += 16, size -= 16) x1 = fold(x1, x0, _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+
+    // 128 bits to 64
+    const __m128i mask = _mm_setr_epi32(~0, 0, ~0, 0);
+    x2                 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x1                 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x0                 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(k5k0));
+    x2                 = _mm_srli_si128(x1, 4);
+    x1                 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask), x0, 0x00), x2);
+
+    // Barrett reduction to 32 bits
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(poly));
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), x0, 0x10);
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask), x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    return quint32(_mm_extract_epi32(x1, 1));
+}
+
+bool hasPclmul() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+}
+
+const bool kHasPclmul = hasPclmul();
+
+#endif  // CHECKSUM_HAVE_X86_KERNELS
+
+}  // namespace
+
+namespace Checksum {
+
+int size(Type type) {
+    switch (type) {
+        case None:
+            return 0;
+        case Xor8:
+            return 1;
+        case Crc16Modbus:
+        case Crc16Ccitt:
+            return 2;
+        case Crc32:
+            return 4;
+    }
+    return 0;
+}
+
+QString name(Type type) {
+    switch (type) {
+        case None:
+            return u"None"_s;
+        case Xor8:
+            return u"XOR"_s;
+        case Crc16Modbus:
+            return u"CRC-16/MODBUS"_s;
+        case Crc16Ccitt:
+            return u"CRC-16/CCITT"_s;
+        case Crc32:
+            return u"CRC-32"_s;
+    }
+    return QString();
+}
+
+bool parse(QStringView text, Type &type) {
+    static const struct {
+        QLatin1StringView name;
+        Type              type;
+    } kNames[] = {{"none"_L1, None}, {"xor"_L1, Xor8}, {"modbus"_L1, Crc16Modbus}, {"ccitt"_L1, Crc16Ccitt},
+                  {"crc32"_L1, Crc32}};
+    for (const auto &entry : kNames) {
+        if (text.compare(entry.name, Qt::CaseInsensitive) != 0) continue;
+        type = entry.type;
+        return true;
+    }
+    return false;
+}
+
+quint32 compute(Type type, const char *data, qsizetype size) {
+    switch (type) {
+        case None:
+            return 0;
+        case Xor8:
+            return xor8(data, size);
+        case Crc16Modbus:
+            return crc16Modbus(data, size);
+        case Crc16Ccitt:
+            return crc16Ccitt(data, size);
+        case Crc32:
+            return crc32(data, size);
+    }
+    return 0;
+}
+
+void append(Type type, QByteArray &data) {
+    const quint32 value = compute(type, data.constData(), data.size());
+    switch (type) {
+        case None:
+            break;
+        case Xor8:
+            data.append(char(value));
+            break;
+        case Crc16Ccitt:
+            data.append(char(value >> 8));
+            data.append(char(value));
+            break;
+        case Crc16Modbus:
+        case Crc32:
+            for (int i = 0; i < Checksum::size(type); i++) data.append(char(value >> (8 * i)));
+            break;
+    }
+}
+
+bool verify(Type type, QByteArrayView frame, quint32 &stored, quint32 &computed) {
+    const int checksumSize = Checksum::size(type);
+    if (checksumSize == 0 || frame.size() <= checksumSize) return false;
+
+    const qsizetype payloadSize = frame.size() - checksumSize;
+    const uchar    *tail        = reinterpret_cast<const uchar *>(frame.data()) + payloadSize;
+    stored                      = 0;
+    for (int i = 0; i < checksumSize; i++) {
+        const int shift = (type == Crc16Ccitt) ? 8 * (checksumSize - 1 - i) : 8 * i;
+        stored |= quint32(tail[i]) << shift;
+    }
+    computed = compute(type, frame.data(), payloadSize);
+    return true;
+}
+
+QString describe(Type type, QByteArrayView frame) {
+    quint32 stored   = 0;
+    quint32 computed = 0;
+    if (verify(type, frame, stored, computed) == false) {
+        return QObject::tr("%1 missing, frame too short").arg(name(type));
+    }
+
+    const auto hex = [digits = Checksum::size(type) * 2](quint32 value) {
+        return u"0x"_s + QString::number(value, 16).toUpper().rightJustified(digits, u'0');
+    };
+    if (stored == computed) return QObject::tr("%1 %2 ok").arg(name(type), hex(stored));
+    return QObject::tr("%1 %2 bad, computed %3").arg(name(type), hex(stored), hex(computed));
+}
+
+quint8 xor8(const char *data, qsizetype size) {
+    // Eight bytes at a time, folded into one at the end
+    quint64 wide = 0;
+    for (; size >= 8; data += 8, size -= 8) {
+        quint64 word;
+        std::memcpy(&word, data, sizeof(word));
+        wide ^= word;
+    }
+    wide ^= wide >> 32;
+    wide ^= wide >> 16;
+    wide ^= wide >> 8;
+    quint8 value = quint8(wide);
+    for (; size > 0; data++, size--) value ^= quint8(*data);
+    return value;
+}
+
+quint16 crc16Modbus(const char *data, qsizetype size, quint16 crc) {
+    const auto  &t = kModbusTables.entries;
+    const uchar *p = reinterpret_cast<const uchar *>(data);
+    for (; size >= 8; p += 8, size -= 8) {
+        crc = quint16(t[7][p[0] ^ (crc & 0xFF)] ^ t[6][p[1] ^ (crc >> 8)] ^ t[5][p[2]] ^ t[4][p[3]] ^ t[3][p[4]] ^
+                      t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]]);
+    }
+    for (; size > 0; p++, size--) crc = quint16((crc >> 8) ^ t[0][(crc ^ *p) & 0xFF]);
+    return crc;
+}
+
+quint16 crc16Ccitt(const char *data, qsizetype size, quint16 crc) {
+    const auto  &t = kCcittTables.entries;
+    const uchar *p = reinterpret_cast<const uchar *>(data);
+    for (; size >= 8; p += 8, size -= 8) {
+        crc = quint16(t[7][p[0] ^ (crc >> 8)] ^ t[6][p[1] ^ (crc & 0xFF)] ^ t[5][p[2]] ^ t[4][p[3]] ^ t[3][p[4]] ^
+                      t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]]);
+    }
+    for (; size > 0; p++, size--) crc = quint16((crc << 8) ^ t[0][((crc >> 8) ^ *p) & 0xFF]);
+    return crc;
+}
+
+quint32 crc32(const char *data, qsizetype size, quint32 crc) {
+    const uchar *p = reinterpret_cast<const uchar *>(data);
+    crc            = ~crc;
+#ifdef CHECKSUM_HAVE_X86_KERNELS
+    if (kHasPclmul == true && size >= 64) {
+        const qsizetype folded = size & ~qsizetype(15);
+        crc                    = crc32Pclmul(p, folded, crc);
+        p += folded;
+        size -= folded;
+    }
+#endif
+    return ~crc32Tables(p, size, crc);
+}
+
+}  // namespace Checksum
@@ -0,0 +1,57 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QStringView>
+
+// Checksums appended to sent payloads and checked at the end of received
+// frames. The CRCs run through slicing-by-8 tables, eight bytes per step, and
+// CRC-32 through PCLMULQDQ folding when the CPU has it; none of them should
+// ever be what limits the line rate.
+namespace Checksum {
+
+enum Type {
+    None,
+    Xor8,         // every byte XORed together
+    Crc16Modbus,  // sent low byte first
+    Crc16Ccitt,   // CCITT-FALSE, sent high byte first
+    Crc32,        // IEEE 802.3 as in zlib, sent low byte first
+};
+
+// Bytes the checksum takes at the end of a frame
+int size(Type type);
+
+// "CRC-16/MODBUS" and the like, "None" for none
+QString name(Type type);
+
+// none, xor, modbus, ccitt or crc32, as given on the command line
+bool parse(QStringView text, Type &type);
+
+quint32 compute(Type type, const char *data, qsizetype size);
+
+// The checksum of data appended to it, in the order it is sent
+void append(Type type, QByteArray &data);
+
+// The checksum at the end of the frame and the one computed over the rest;
+// false when the frame is too short to carry one
+bool verify(Type type, QByteArrayView frame, quint32 &stored, quint32 &computed);
+
+// What verify found, for the log: "CRC-16/MODBUS 0xCDC5 ok", "CRC-32 0x00000000 bad, computed 0x1C291CA3"
+QString describe(Type type, QByteArrayView frame);
+
+quint8 xor8(const char *data, qsizetype size);
+
+// CRC-16/MODBUS, check value 0x4B37
+quint16 crc16Modbus(const char *data, qsizetype size, quint16 crc = 0xFFFF);
+
+// CRC-16/CCITT-FALSE, check value 0x29B1
+quint16 crc16Ccitt(const char *data, qsizetype size, quint16 crc = 0xFFFF);
+
+// CRC-32, check value 0xCBF43926; a previous result continues the CRC over more data
+quint32 crc32(const char *data, qsizetype size, quint32 crc = 0);
+
+}  // namespace Checksum
+
+#endif  // CHECKSUM_H
@@ -0,0 +1,326 @@
+#include "comparewindow.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QSignalBlocker>
+#include <QVBoxLayout>
+
+#include "hexdump.h"
+#include "sessionformat.h"
+#include "widget.h"
+
+using namespace Qt::StringLiterals;
+
+// Recorded chunks closer together than this are one frame, as the worker's default packet gap does it live
+static constexpr qint64 kRecordedPacketGap_ns = 2 * 1000 * 1000;
+// Time the recorded sessions may take from the event loop at a time, and the pause while waiting for a port
+static constexpr qint64 kFeedSlice_ns = 5 * 1000 * 1000;
+static constexpr int    kFeedIdle_ms  = 20;
+// Bytes of a frame or run shown in the log, the rest is cut off
+static constexpr qsizetype kShownBytes = 256;
+
+static QString hexLine(const char *prefix, QByteArrayView data) {
+    QByteArray line = prefix;
+    line += HexDump::toSpacedHex(data.first(qMin(data.size(), kShownBytes)));
+    if (data.size() > kShownBytes) line += " ...";
+    return QString::fromLatin1(line);
+}
+
+// "^^" under every byte that differs, lined up with the hex of hexLine
+static QString markerLine(QByteArrayView a, QByteArrayView b) {
+    const qsizetype size = qMin(qMax(a.size(), b.size()), kShownBytes);
+    QByteArray      line(3 + size * 3, ' ');
+    for (qsizetype i = 0; i < size; i++) {
+        if (i < a.size() && i < b.size() && a[i] == b[i]) continue;
+        line[3 + i * 3]     = '^';
+        line[3 + i * 3 + 1] = '^';
+    }
+    while (line.endsWith(' ') == true) line.chop(1);
+    return QString::fromLatin1(line);
+}
+
+CompareWindow::CompareWindow(const QList<Widget *> &ports, QWidget *parent)
+    : QWidget(parent, Qt::Window),
+      m_logModel(new LogModel(this)),
+      m_feedTimer(new QTimer(this)),
+      m_statusTimer(new QTimer(this)) {
+    setAttribute(Qt::WA_DeleteOnClose);
+    setWindowTitle(tr("Compare Streams"));
+    resize(900, 600);
+
+    m_logView           = new LogView(this);
+    m_modeComboBox      = new QComboBox(this);
+    m_comparePushButton = new QPushButton(tr("Compare"), this);
+    m_statusLabel       = new QLabel(this);
+
+    auto *sourceLayout = new QHBoxLayout;
+    for (const StreamCompare::Side side : {StreamCompare::A, StreamCompare::B}) {
+        Source &source  = m_sources[side];
+        source.comboBox = new QComboBox(this);
+        for (Widget *port : ports) source.comboBox->addItem(port->session()->name());
+        source.comboBox->addItem(tr("Recorded session..."));
+        source.comboBox->setCurrentIndex(qMin(int(side), source.comboBox->count() - 1));
+        sourceLayout->addWidget(new QLabel((side == StreamCompare::A) ? u"A"_s : u"B"_s, this));
+        sourceLayout->addWidget(source.comboBox, 1);
+    }
+    for (Widget *port : ports) m_ports.append(port);
+
+    m_modeComboBox->addItem(tr("By frame"), int(StreamCompare::Frames));
+    m_modeComboBox->addItem(tr("By byte offset"), int(StreamCompare::Bytes));
+    m_modeComboBox->setToolTip(tr("Pair up frames, resynchronizing after frames only one side sent, "
+                                  "or compare byte for byte"));
+    m_comparePushButton->setCheckable(true);
+    sourceLayout->addWidget(m_modeComboBox);
+    sourceLayout->addWidget(m_comparePushButton);
+
+    // Only the differences are logged, so a long run that matches stays small
+    m_logModel->setMemoryBudget(16 * 1024 * 1024);
+    m_logView->setModel(m_logModel);
+    m_statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+    auto *layout = new QVBoxLayout(this);
+    layout->addLayout(sourceLayout);
+    layout->addWidget(m_logView, 1);
+    layout->addWidget(m_statusLabel);
+
+    m_sink = [this](const StreamCompare::Difference &difference) { report(difference); };
+    m_statusTimer->setInterval(200);
+
+    connect(m_comparePushButton, &QPushButton::toggled, this, &CompareWindow::compare);
+    connect(m_feedTimer, &QTimer::timeout, this, &CompareWindow::feedRecorded);
+    connect(m_statusTimer, &QTimer::timeout, this, &CompareWindow::updateStatus);
+    connect(m_logModel, &QAbstractItemModel::rowsInserted, this, [this]() {
+        if (m_logView->isAtBottom() == true) m_logView->scrollToBottom();
+    });
+}
+
+void CompareWindow::compare(bool isChecked) {
+    if (isChecked == false) {
+        stop(tr("stopped"));
+        return;
+    }
+
+    const int indexA = m_sources[StreamCompare::A].comboBox->currentIndex();
+    const int indexB = m_sources[StreamCompare::B].comboBox->currentIndex();
+    if (indexA == indexB && indexA < m_ports.size()) {
+        m_logModel->append(LogModel::Status, tr("**** Pick two different ports, or a port and a recording ****"));
+        setRunning(false);
+        return;
+    }
+
+    m_compare.setMode(StreamCompare::Mode(m_modeComboBox->currentData().toInt()));
+    m_logModel->clear();
+    if (openSource(StreamCompare::A) == false || openSource(StreamCompare::B) == false) {
+        for (Source &source : m_sources) {
+            QObject::disconnect(source.connection);
+            QObject::disconnect(source.closedConnection);
+            source.reader.reset();
+        }
+        setRunning(false);
+        return;
+    }
+
+    const Source &a    = m_sources[StreamCompare::A];
+    const Source &b    = m_sources[StreamCompare::B];
+    const QString mode = (m_compare.mode() == StreamCompare::Frames) ? tr("frame by frame") : tr("byte by byte");
+    m_logModel->append(LogModel::Status, tr("---- Comparing A %1 with B %2 %3 ----").arg(a.name, b.name, mode));
+    setRunning(true);
+    if (a.reader != nullptr || b.reader != nullptr) m_feedTimer->start(0);
+    m_statusTimer->start();
+    updateStatus();
+}
+
+bool CompareWindow::openSource(StreamCompare::Side side) {
+    Source   &source = m_sources[side];
+    const int index  = source.comboBox->currentIndex();
+    source.reader.reset();
+    source.nextRecord  = 0;
+    source.frame.clear();
+    source.lastChunkNs = 0;
+    source.isDone      = false;
+
+    if (index >= 0 && index < m_ports.size()) {
+        Widget *port = m_ports[index];
+        if (port == nullptr) {
+            m_logModel->append(LogModel::Status, tr("**** The port's tab has been closed ****"));
+            return false;
+        }
+        source.port       = port;
+        source.name       = port->session()->name();
+        const auto add    = [this, side](const SerialPacket &packet) { m_compare.add(side, packet.data, m_sink); };
+        source.connection = connect(port, &Widget::packetReceived, this, add);
+        // The comparison ends with the tab, what is still waiting for it is reported
+        source.closedConnection =
+            connect(port, &QObject::destroyed, this, [this]() { stop(tr("a port's tab was closed")); });
+        return true;
+    }
+
+    const QString title    = tr("Compare Session %1").arg((side == StreamCompare::A) ? u"A"_s : u"B"_s);
+    const QString fileName = QFileDialog::getOpenFileName(this, title, QString(), tr("ComPort Session (*.cps)"));
+    if (fileName.isEmpty() == true) return false;
+
+    QString errorString;
+    source.reader = std::make_unique<SessionReader>();
+    if (source.reader->open(fileName, &errorString) == false) {
+        m_logModel->append(LogModel::Status,
+                           tr("**** Unable to open %1: %2 ****").arg(QDir::toNativeSeparators(fileName), errorString));
+        source.reader.reset();
+        return false;
+    }
+    source.name = QFileInfo(fileName).fileName();
+    return true;
+}
+
+void CompareWindow::feedRecorded() {
+    // Read ahead of the other side only up to half of what the comparison would hold
+    const bool      isFrames = (m_compare.mode() == StreamCompare::Frames);
+    const qsizetype limit    = (isFrames ? StreamCompare::kMaxPendingFrames : StreamCompare::kMaxPendingBytes) / 2;
+    QElapsedTimer   clock;
+    clock.start();
+
+    bool isFed = true;
+    while (isFed == true && clock.nsecsElapsed() < kFeedSlice_ns) {
+        isFed = false;
+        for (const StreamCompare::Side side : {StreamCompare::A, StreamCompare::B}) {
+            Source       &source = m_sources[side];
+            const Source &other  = m_sources[(side == StreamCompare::A) ? StreamCompare::B : StreamCompare::A];
+            if (source.reader == nullptr || source.isDone == true) continue;
+            // Once the other recording has ended there is nothing left to wait for
+            if (m_compare.pending(side) >= limit && (other.reader == nullptr || other.isDone == false)) continue;
+
+            SessionReader::Record record;
+            if (source.nextRecord >= source.reader->recordCount()) {
+                if (source.frame.isEmpty() == false) m_compare.add(side, source.frame, m_sink);
+                source.isDone = true;
+                m_logModel->append(LogModel::Status, tr("---- End of %1 ----").arg(source.name));
+                continue;
+            }
+            isFed = true;
+            // A record in a damaged block is left out, as the viewer does
+            if (source.reader->record(source.nextRecord++, record) == false) continue;
+            if (record.direction != SessionFormat::Received) continue;
+
+            if (isFrames == false) {
+                m_compare.add(side, record.data, m_sink);
+                continue;
+            }
+            if (source.frame.isEmpty() == false && record.timestampNs - source.lastChunkNs > kRecordedPacketGap_ns) {
+                m_compare.add(side, source.frame, m_sink);
+                source.frame.resize(0);
+            }
+            source.frame.append(record.data);
+            source.lastChunkNs = record.timestampNs;
+        }
+    }
+
+    // Two recordings end the comparison when both are read, a port keeps it going until stopped
+    bool isFinished = true;
+    bool isReading  = false;
+    for (const Source &source : m_sources) {
+        isFinished = isFinished && source.reader != nullptr && source.isDone == true;
+        isReading  = isReading || (source.reader != nullptr && source.isDone == false);
+    }
+    if (isFinished == true) {
+        stop(tr("finished"));
+    } else if (isReading == false) {
+        m_feedTimer->stop();
+    } else {
+        // Waiting for the port on the other side to catch up
+        m_feedTimer->setInterval((isFed == true) ? 0 : kFeedIdle_ms);
+    }
+}
+
+void CompareWindow::stop(const QString &reason) {
+    if (m_isRunning == false) return;
+
+    m_feedTimer->stop();
+    m_statusTimer->stop();
+    for (Source &source : m_sources) {
+        QObject::disconnect(source.connection);
+        QObject::disconnect(source.closedConnection);
+        source.reader.reset();
+    }
+    m_compare.finish(m_sink);
+    updateStatus();
+    m_logModel->append(LogModel::Status, tr("---- Compare %1: %2 ----").arg(reason, m_statusLabel->text()));
+    setRunning(false);
+}
+
+void CompareWindow::setRunning(bool isRunning) {
+    m_isRunning = isRunning;
+    const QSignalBlocker blocker(m_comparePushButton);
+    m_comparePushButton->setChecked(isRunning);
+    m_comparePushButton->setText(isRunning ? tr("Stop") : tr("Compare"));
+    m_sources[StreamCompare::A].comboBox->setEnabled(!isRunning);
+    m_sources[StreamCompare::B].comboBox->setEnabled(!isRunning);
+    m_modeComboBox->setEnabled(!isRunning);
+}
+
+void CompareWindow::updateStatus() {
+    const StreamCompare::Stats &stats = m_compare.stats();
+    const QString unit = (m_compare.mode() == StreamCompare::Frames) ? tr("frames") : tr("bytes");
+    QString       text = tr("%1 %2 equal, %3 changed, %4 only in A, %5 only in B")
+                       .arg(stats.equal)
+                       .arg(unit)
+                       .arg(stats.changed)
+                       .arg(stats.onlyA)
+                       .arg(stats.onlyB);
+    if (stats.skipped > 0) text += tr(", %1 bytes not compared").arg(stats.skipped);
+    if (m_isRunning == true) {
+        text += tr("; waiting A %1, B %2")
+                    .arg(m_compare.pending(StreamCompare::A))
+                    .arg(m_compare.pending(StreamCompare::B));
+    }
+    m_statusLabel->setText(text);
+}
+
+void CompareWindow::report(const StreamCompare::Difference &difference) {
+    const bool   isFrames = (m_compare.mode() == StreamCompare::Frames);
+    const qint64 nowNs    = SessionFormat::monotonicNs();
+    const qint64 wallNs   = SessionFormat::realtimeNs();
+
+    switch (difference.kind) {
+        case StreamCompare::Difference::Changed:
+            if (isFrames == true) {
+                m_logModel->appendTimestamp(nowNs, wallNs, tr("FRAME A %1, B %2 differ from byte %3")
+                                                               .arg(difference.positionA)
+                                                               .arg(difference.positionB)
+                                                               .arg(difference.offset));
+            } else {
+                m_logModel->appendTimestamp(nowNs, wallNs,
+                                            tr("BYTES %1 to %2 differ")
+                                                .arg(difference.positionA)
+                                                .arg(difference.positionA + quint64(difference.offset) - 1));
+            }
+            m_logModel->append(LogModel::Received, hexLine("A  ", difference.a));
+            m_logModel->append(LogModel::Transmitted, hexLine("B  ", difference.b));
+            m_logModel->append(LogModel::Decoded, markerLine(difference.a, difference.b));
+            break;
+        case StreamCompare::Difference::OnlyA:
+        case StreamCompare::Difference::OnlyB: {
+            const bool  isA  = (difference.kind == StreamCompare::Difference::OnlyA);
+            const char *name = isA ? "A" : "B";
+            if (isFrames == true) {
+                m_logModel->appendTimestamp(nowNs, wallNs, tr("FRAME %1 %2 only in %1")
+                                                               .arg(QLatin1String(name))
+                                                               .arg(isA ? difference.positionA : difference.positionB));
+            } else {
+                m_logModel->appendTimestamp(nowNs, wallNs, tr("BYTES from %1 only in %2, %3 bytes")
+                                                               .arg(difference.positionA)
+                                                               .arg(QLatin1String(name))
+                                                               .arg(difference.offset));
+            }
+            m_logModel->append(isA ? LogModel::Received : LogModel::Transmitted,
+                               hexLine(isA ? "A  " : "B  ", isA ? difference.a : difference.b));
+            break;
+        }
+        case StreamCompare::Difference::Skipped:
+            m_logModel->append(LogModel::Status, tr("**** Bytes %1 to %2 not compared, one side was too far ahead ****")
+                                                     .arg(difference.positionA)
+                                                     .arg(difference.positionA + quint64(difference.offset) - 1));
+            break;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef COMPAREWINDOW_H
+#define COMPAREWINDOW_H
+
+#include <QComboBox>
+#include <QLabel>
+#include <QList>
+#include <QPointer>
+#include <QPushButton>
+#include <QTimer>
+#include <QWidget>
+#include <memory>
+
+#include "logmodel.h"
+#include "logview.h"
+#include "sessionreader.h"
+#include "streamcompare.h"
+
+class Widget;
+
+// Window comparing what two ports receive, or a port and a recorded session,
+// or two recorded sessions. Live frames are taken as the port's tab takes them
+// off the worker, with the tab's framing; recorded sessions are read in slices
+// from the event loop and only as fast as the other side keeps up. The log
+// below only shows where the streams differ.
+class CompareWindow : public QWidget {
+    Q_OBJECT
+
+   public:
+    CompareWindow(const QList<Widget *> &ports, QWidget *parent = nullptr);
+
+   private slots:
+    void compare(bool isChecked);
+    void feedRecorded();
+    void updateStatus();
+
+   private:
+    struct Source {
+        QComboBox                     *comboBox = nullptr;
+        QString                        name;
+        QPointer<Widget>               port;
+        QMetaObject::Connection        connection;
+        QMetaObject::Connection        closedConnection;
+        std::unique_ptr<SessionReader> reader;  // nullptr for a port
+        qint64                         nextRecord = 0;
+        QByteArray                     frame;  // recorded chunks gathered into a frame by packet gap
+        qint64                         lastChunkNs = 0;
+        bool                           isDone      = false;
+    };
+
+    bool openSource(StreamCompare::Side side);
+    void stop(const QString &reason);
+    void setRunning(bool isRunning);
+    void report(const StreamCompare::Difference &difference);
+
+    QList<QPointer<Widget>> m_ports;
+    Source                  m_sources[2];
+    StreamCompare           m_compare;
+    StreamCompare::Sink     m_sink;
+    bool                    m_isRunning = false;
+
+    LogModel    *m_logModel          = nullptr;
+    LogView     *m_logView           = nullptr;
+    QComboBox   *m_modeComboBox      = nullptr;
+    QPushButton *m_comparePushButton = nullptr;
+    QLabel      *m_statusLabel       = nullptr;
+    QTimer      *m_feedTimer         = nullptr;
+    QTimer      *m_statusTimer       = nullptr;
+};
+
+#endif  // COMPAREWINDOW_H
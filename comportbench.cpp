@@ -0,0 +1,1488 @@
+// Throughput and latency of the receive and transmit paths, measured over a
+// pseudo terminal so that any Linux box can run it without hardware. The worker
+// opens the slave side exactly as it opens a serial port; the far end is a
+// thread of its own on the master side; up to 32 such ports run at once on the
+// worker pool the GUI uses. Prints one JSON document to keep next to a build
+// and compare with the next one. The checksum engine, the stream comparison,
+// the hex formatter, the framers and the search index of the data log are timed
+// on their own as well, since they run on every frame, and so is a large paste
+// into the hex send field. The checksums, the hex kernels, the framers, the
+// search index and the network bridge are checked first, and the exit status is
+// 1 when a check fails.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <pty.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "checksum.h"
+#include "framer.h"
+#include "hexdump.h"
+#include "logindex.h"
+#include "metrics.h"
+#include "serialbridge.h"
+#include "serialworker.h"
+#include "serialworkerpool.h"
+#include "sessionformat.h"
+#include "streamcompare.h"
+
+using namespace Qt::StringLiterals;
+using SessionFormat::monotonicNs;
+
+// Transmit keeps the port this far ahead of the driver, like comport-cli does with stdin
+static constexpr quint64 kMaxBytesToWrite = 64 * 1024;
+
+// Every frame starts with its send time: 16 hex digits of the monotonic clock
+static constexpr int kStampSize = 16;
+
+// Longest input the checksums are checked with: several of the 64 byte blocks
+// PCLMULQDQ folds, with every tail the tables take over after them
+static constexpr int kChecksumCheckLength = 300;
+
+// Longest input the hex kernels are checked with, a few times the 32 bytes AVX2 takes at once
+static constexpr int kHexCheckLength = 200;
+
+// Frames every framer check sends, and their size limit. A length prefix has
+// only the CRC to find its way back after noise, a limit near the real frame
+// sizes keeps it from waiting on lengths made of noise.
+static constexpr int       kFramerCheckFrames  = 200;
+static constexpr qsizetype kFramerCheckMaxSize = 600;
+
+// The stalled receive runs stop taking frames this long, once every period
+static constexpr int    kStallMs        = 250;
+static constexpr qint64 kStallPeriod_ns = 1000LL * 1000 * 1000;
+
+// The gap receive runs: frames are ended by the idle line alone, at a rate that
+// leaves the line idle for several gaps between two frames
+static constexpr int kPacketGapMs   = 2;
+static constexpr int kPacketGapRate = 100;
+
+// Characters of hex text in the paste scenario
+static constexpr qsizetype kPasteSize = 64 * 1024;
+
+// Frames in the data log of the search scenario, a label line before each, and
+// the substrings of it the search check looks for
+static constexpr int kSearchFrames       = 50000;
+static constexpr int kSearchCheckQueries = 20000;
+
+// Most ports run at once, each of them takes a pty pair and a sender thread
+static constexpr int kMaxPorts = 32;
+
+// What the far end sends in the bridge check, and the backlog a client may have
+// before the policy applies. A client that does not read first fills a few MB of
+// socket buffers; the stream is well past that and the backlog together.
+static constexpr qint64 kBridgeBytes      = 32 * 1024 * 1024;
+static constexpr qint64 kBridgeMaxBacklog = 4 * 1024 * 1024;
+
+// What the client that has the port writes in the bridge check, and what another
+// one writes right after it, to be refused
+static constexpr int kBridgeWriterBytes  = 1000;
+static constexpr int kBridgeRefusedBytes = 100;
+
+// A run that has not seen all its frames this long after the sender stopped is reported incomplete
+static constexpr qint64 kDrainTimeout_ns = 5LL * 1000 * 1000 * 1000;
+
+static qint64 cpuTimeNs(int who) {
+    rusage usage{};
+    getrusage(who, &usage);
+    return (qint64(usage.ru_utime.tv_sec) + usage.ru_stime.tv_sec) * 1000000000LL +
+           (qint64(usage.ru_utime.tv_usec) + usage.ru_stime.tv_usec) * 1000LL;
+}
+
+static qint64 residentBytes() {
+    QFile file(u"/proc/self/statm"_s);
+    if (file.open(QIODevice::ReadOnly) == false) return 0;
+    const QList<QByteArray> fields = file.readAll().split(' ');
+    return (fields.size() > 1) ? fields[1].toLongLong() * sysconf(_SC_PAGESIZE) : 0;
+}
+
+static bool writeAll(int fd, const char *data, qsizetype size) {
+    while (size > 0) {
+        const ssize_t written = ::write(fd, data, std::size_t(size));
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+static void stampFrame(char *frame, qint64 ns) {
+    static const char digits[] = "0123456789abcdef";
+    for (int i = kStampSize - 1; i >= 0; i--, ns >>= 4) frame[i] = digits[ns & 0xf];
+}
+
+static qint64 frameStamp(const QByteArray &frame) {
+    if (frame.size() < kStampSize) return -1;
+    return frame.first(kStampSize).toLongLong(nullptr, 16);
+}
+
+// Runs the event loop until isDone, giving up after timeoutNs; 0 waits as long as it takes
+static bool waitUntil(const std::function<bool()> &isDone, qint64 timeoutNs) {
+    QEventLoop   loop;
+    QTimer       checkTimer;
+    const qint64 endNs = monotonicNs() + timeoutNs;
+    bool         isMet = isDone();
+    QObject::connect(&checkTimer, &QTimer::timeout, &loop, [&]() {
+        isMet = isDone();
+        if (isMet == true || (timeoutNs > 0 && monotonicNs() > endNs)) loop.quit();
+    });
+    if (isMet == false) {
+        checkTimer.start(1);
+        loop.exec();
+    }
+    return isMet;
+}
+
+static QJsonObject latencyObject(const LatencyHistogram &latency) {
+    QJsonObject object;
+    object[u"samples"_s] = double(latency.count());
+    object[u"p50_us"_s]  = double(latency.percentileNs(0.50)) / 1e3;
+    object[u"p90_us"_s]  = double(latency.percentileNs(0.90)) / 1e3;
+    object[u"p99_us"_s]  = double(latency.percentileNs(0.99)) / 1e3;
+    object[u"max_us"_s]  = double(latency.percentileNs(1.0)) / 1e3;
+    return object;
+}
+
+// CPU of the process less the peer thread, per MB moved, and how far the resident size grew
+static void addCost(QJsonObject &result, qint64 cpuNs, qint64 peerCpuNs, qint64 rssBefore, quint64 bytes) {
+    const double megabytes     = qMax(1e-9, double(bytes) / (1024.0 * 1024.0));
+    result[u"cpu_ms_per_mb"_s] = double(qMax<qint64>(0, cpuNs - peerCpuNs)) / 1e6 / megabytes;
+    result[u"rss_growth_kb"_s] = double(residentBytes() - rssBefore) / 1024.0;
+}
+
+// One bit at a time, straight from the polynomial; CRC-32 without its final inversion
+static quint32 bitwiseCrc(Checksum::Type type, const uchar *data, qsizetype size) {
+    quint32 crc = (type == Checksum::Crc32) ? 0xFFFFFFFF : 0xFFFF;
+    for (qsizetype i = 0; i < size; i++) {
+        if (type == Checksum::Crc16Ccitt) {
+            crc ^= quint32(data[i]) << 8;
+            for (int bit = 0; bit < 8; bit++) crc = ((crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1) & 0xFFFF;
+        } else {
+            const quint32 polynomial = (type == Checksum::Crc32) ? 0xEDB88320 : 0xA001;
+            crc ^= data[i];
+            for (int bit = 0; bit < 8; bit++) crc = (crc & 1) ? (crc >> 1) ^ polynomial : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+// Every CRC against its check value and against the bitwise one, for every
+// length up to a few folding blocks and at every misalignment within 16 bytes.
+// CRC-32 is also continued from a first half to the whole.
+static QJsonObject checksumCheck(Checksum::Type type) {
+    QByteArray bytes(kChecksumCheckLength + 16, Qt::Uninitialized);
+    for (qsizetype i = 0; i < bytes.size(); i++) bytes[i] = char(i * 167 + 13);  // every byte value, no pattern
+
+    // The published check values, the CRCs of "123456789"
+    const quint32 checkValue =
+        (type == Checksum::Crc32) ? 0xCBF43926 : (type == Checksum::Crc16Modbus) ? 0x4B37 : 0x29B1;
+    quint64 cases    = 1;
+    quint64 failures = (Checksum::compute(type, "123456789", 9) != checkValue) ? 1 : 0;
+    for (int length = 0; length <= kChecksumCheckLength; length++) {
+        for (int alignment = 0; alignment < 16; alignment++, cases++) {
+            const char *data     = bytes.constData() + alignment;
+            quint32     expected = bitwiseCrc(type, reinterpret_cast<const uchar *>(data), length);
+            if (type == Checksum::Crc32) expected = ~expected;
+            if (Checksum::compute(type, data, length) != expected) {
+                failures++;
+            } else if (type == Checksum::Crc32 &&
+                       Checksum::crc32(data + length / 2, length - length / 2, Checksum::crc32(data, length / 2)) !=
+                           expected) {
+                failures++;
+            }
+        }
+    }
+
+    QJsonObject result;
+    result[u"scenario"_s] = u"checksum"_s;
+    result[u"mode"_s]     = Checksum::name(type);
+    result[u"cases"_s]    = double(cases);
+    result[u"failures"_s] = double(failures);
+    return result;
+}
+
+// The checksum engine alone, over frames that stay in cache: what it costs per frame at line rate
+static QJsonObject checksumThroughput(Checksum::Type type, int payload, double seconds) {
+    const QByteArray frame(payload, 'x');
+    const qint64     startNs = monotonicNs();
+    const qint64     endNs   = startNs + qint64(seconds * 1e9);
+    quint64          frames  = 0;
+    volatile quint32 sink    = 0;  // keeps the work from being optimized away
+    qint64           nowNs   = startNs;
+    for (; nowNs < endNs; nowNs = monotonicNs()) {
+        for (int i = 0; i < 256; i++, frames++) sink = Checksum::compute(type, frame.constData(), frame.size());
+    }
+
+    QJsonObject result;
+    result[u"scenario"_s] = u"checksum"_s;
+    result[u"mode"_s]     = Checksum::name(type);
+    result[u"payload"_s]  = payload;
+    result[u"mb_per_s"_s] = double(frames) * payload / (1024.0 * 1024.0) / (double(nowNs - startNs) / 1e9);
+    return result;
+}
+
+// Two streams that differ in one frame out of a thousand, compared frame by frame or byte by byte
+static QJsonObject compareThroughput(StreamCompare::Mode mode, int payload, double seconds) {
+    QByteArray          frame(payload, 'x');
+    QByteArray          changed(payload, 'x');
+    StreamCompare       compare(mode);
+    quint64             differences = 0;
+    StreamCompare::Sink sink        = [&differences](const StreamCompare::Difference &) { differences++; };
+    changed[payload / 2] = 'y';
+
+    const qint64 startNs = monotonicNs();
+    const qint64 endNs   = startNs + qint64(seconds * 1e9);
+    quint64      frames  = 0;
+    qint64       nowNs   = startNs;
+    for (; nowNs < endNs; nowNs = monotonicNs()) {
+        for (int i = 0; i < 256; i++, frames++) {
+            compare.add(StreamCompare::A, frame, sink);
+            compare.add(StreamCompare::B, (frames % 1000 == 999) ? changed : frame, sink);
+        }
+    }
+    compare.finish(sink);
+
+    QJsonObject result;
+    result[u"scenario"_s]    = u"compare"_s;
+    result[u"mode"_s]        = (mode == StreamCompare::Frames) ? u"frames"_s : u"bytes"_s;
+    result[u"payload"_s]     = payload;
+    result[u"differences"_s] = double(differences);
+    // Frames of one stream, each compared with its pair in the other
+    result[u"frames_per_s"_s] = double(frames) / (double(nowNs - startNs) / 1e9);
+    // Both streams together
+    result[u"mb_per_s"_s] = 2.0 * double(frames) * payload / (1024.0 * 1024.0) / (double(nowNs - startNs) / 1e9);
+    return result;
+}
+
+// How the receive view turned bytes into hex before HexDump, the baseline the kernels are measured against
+static QByteArray insertSpaceBetweenByte(QByteArray input) {
+    quint8     cursorSpace = 0;
+    QByteArray output      = nullptr;
+    for (int index = 0; index < input.toHex().size(); index++) {
+        output.append(input.toHex().toUpper().at(index));
+        if ((++cursorSpace >= 2) && (index < (input.toHex().size() - 1))) {
+            cursorSpace = 0;
+            output.append(' ');
+        }
+    }
+    return output;
+}
+
+// Every kernel against Qt's own hex conversion, which gives the same text as
+// the baseline, for every length up to a few AVX2 blocks and at every
+// alignment, so the vector loops and the odd tails behind them all get a turn
+static QJsonObject hexCheck(HexDump::Kernel kernel) {
+    QByteArray bytes(kHexCheckLength + 32, Qt::Uninitialized);
+    for (qsizetype i = 0; i < bytes.size(); i++) bytes[i] = char(i * 167 + 13);  // every byte value, no pattern
+
+    QByteArray out;
+    quint64    cases    = 0;
+    quint64    failures = 0;
+    for (int length = 0; length <= kHexCheckLength; length++) {
+        for (int alignment = 0; alignment < 32; alignment++, cases++) {
+            const QByteArray expected = bytes.sliced(alignment, length).toHex(' ').toUpper();
+            const uchar     *data     = reinterpret_cast<const uchar *>(bytes.constData()) + alignment;
+            out.fill('?', expected.size() + 16);
+            const char *end = HexDump::writeSpacedHex(kernel, data, length, out.data());
+            // Nothing written past the end either
+            if (end - out.constData() != expected.size() || out.first(expected.size()) != expected ||
+                out.sliced(expected.size()) != QByteArray(16, '?')) {
+                failures++;
+            }
+        }
+    }
+
+    QJsonObject result;
+    result[u"scenario"_s] = u"hex"_s;
+    result[u"mode"_s]     = HexDump::kernelName(kernel);
+    result[u"cases"_s]    = double(cases);
+    result[u"failures"_s] = double(failures);
+    return result;
+}
+
+// Formatting one received frame as hex, with the given kernel or, with none, the old way
+static QJsonObject hexThroughput(std::optional<HexDump::Kernel> kernel, int payload, double seconds) {
+    QByteArray frame(payload, Qt::Uninitialized);
+    for (int i = 0; i < payload; i++) frame[i] = char(i * 167 + 13);
+    QByteArray out(HexDump::spacedHexSize(payload), Qt::Uninitialized);
+
+    const uchar  *data    = reinterpret_cast<const uchar *>(frame.constData());
+    const qint64  startNs = monotonicNs();
+    const qint64  endNs   = startNs + qint64(seconds * 1e9);
+    quint64       frames  = 0;
+    volatile char sink    = 0;  // keeps the work from being optimized away
+    qint64        nowNs   = startNs;
+    for (; nowNs < endNs; nowNs = monotonicNs()) {
+        if (kernel.has_value() == false) {
+            sink = insertSpaceBetweenByte(frame).back();
+            frames++;
+            continue;
+        }
+        for (int i = 0; i < 256; i++, frames++) {
+            HexDump::writeSpacedHex(*kernel, data, payload, out.data());
+            sink = out.back();
+        }
+    }
+
+    QJsonObject result;
+    result[u"scenario"_s] = u"hex"_s;
+    result[u"mode"_s]     = kernel.has_value() ? HexDump::kernelName(*kernel) : u"insertSpaceBetweenByte"_s;
+    result[u"payload"_s]  = payload;
+    result[u"mb_per_s"_s] = double(frames) * payload / (1024.0 * 1024.0) / (double(nowNs - startNs) / 1e9);
+    return result;
+}
+
+// Deterministic, so a check that fails fails the same way on every run
+static quint32 nextRandom(quint32 &state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static QString framingName(Framer::Type type) {
+    switch (type) {
+        case Framer::Delimiter:
+            return u"delimiter"_s;
+        case Framer::Slip:
+            return u"slip"_s;
+        case Framer::Cobs:
+            return u"cobs"_s;
+        case Framer::LengthPrefixCrc:
+            return u"length-crc"_s;
+        case Framer::PacketGap:
+        default:
+            return u"gap"_s;
+    }
+}
+
+// Random bytes with plenty of the ones the framings treat specially; never the
+// end of the delimiter, since a delimited frame cannot hold its delimiter
+static QByteArray framerPayload(const Framer::Options &options, qsizetype size, quint32 &state) {
+    static const char special[] = {'\0', '\xC0', '\xDB', '\xDC', '\xDD', '\r', '\n'};
+
+    QByteArray payload(size, Qt::Uninitialized);
+    for (char &c : payload) {
+        const quint32 value = nextRandom(state);
+        c = (value % 4 == 0) ? special[(value >> 8) % sizeof(special)] : char(value >> 16);
+        if (options.type == Framer::Delimiter && c == options.delimiter.back()) c = 'x';
+    }
+    return payload;
+}
+
+// What the framer hands out for the wire fed in reads of chunkSize
+static QList<QByteArray> feedFramer(Framer &framer, QByteArrayView wire, qsizetype chunkSize) {
+    QList<QByteArray> frames;
+    for (qsizetype pos = 0; pos < wire.size(); pos += chunkSize) {
+        framer.feed(wire.sliced(pos, qMin(chunkSize, wire.size() - pos)),
+                    [&frames](QByteArrayView frame) { frames.append(frame.toByteArray()); });
+    }
+    return frames;
+}
+
+// Encoded frames decoded again, the wire fed whole, in reads of one byte and
+// up, and split in two at every position; then with line noise in front, and
+// with a frame over the size limit in between
+static QJsonObject framerCheck(Framer::Type type) {
+    Framer::Options options;
+    options.type         = type;
+    options.delimiter    = "\r\n";
+    options.maxFrameSize = kFramerCheckMaxSize;
+
+    quint32           state    = 0x2545F491;
+    qsizetype         headSize = 0;  // the first three frames
+    QList<QByteArray> payloads;
+    QByteArray        wire;
+    for (int i = 0; i < kFramerCheckFrames; i++) {
+        // SLIP has no empty frames, END after END is only idle line
+        const qsizetype size = (type == Framer::Slip ? 1 : 0) + nextRandom(state) % kFramerCheckMaxSize;
+        payloads.append(framerPayload(options, size, state));
+        wire.append(Framer::encode(options, payloads.back()));
+        if (i < 3) headSize = wire.size();
+    }
+
+    quint64    cases    = 0;
+    quint64    failures = 0;
+    const auto expect   = [&](bool isPassed) {
+        cases++;
+        if (isPassed == false) failures++;
+    };
+
+    for (const qsizetype chunkSize : QList<qsizetype>{wire.size(), 1, 2, 3, 7, 64, 4093}) {
+        std::unique_ptr<Framer> framer = Framer::create(options);
+        expect(feedFramer(*framer, wire, chunkSize) == payloads && framer->stats().errors == 0);
+    }
+    // Every byte of the framing ends a read once
+    const QByteArrayView head(wire.constData(), headSize);
+    for (qsizetype split = 0; split <= head.size(); split++) {
+        std::unique_ptr<Framer> framer = Framer::create(options);
+        QList<QByteArray>       frames = feedFramer(*framer, head.first(split), qMax<qsizetype>(1, split));
+        frames.append(feedFramer(*framer, head.sliced(split), qMax<qsizetype>(1, head.size() - split)));
+        expect(frames == payloads.first(3) && framer->stats().errors == 0);
+    }
+
+    // Line noise up to a frame boundary: whatever it turned into, all frames after it come through
+    QByteArray noisy = framerPayload(options, 300, state);
+    noisy.append(Framer::encode(options, QByteArrayView()));
+    noisy.append(wire);
+    for (const qsizetype chunkSize : QList<qsizetype>{noisy.size(), 1, 64}) {
+        std::unique_ptr<Framer> framer = Framer::create(options);
+        const QList<QByteArray> frames = feedFramer(*framer, noisy, chunkSize);
+        expect(frames.size() >= payloads.size() && frames.last(payloads.size()) == payloads);
+    }
+
+    // A frame over the limit is one error and the frames around it still come
+    // through. Enough follows it for a length prefix to find its way back.
+    QList<QByteArray> kept;
+    QByteArray        oversized;
+    for (int i = 0; i < 4; i++) {
+        if (i == 1) oversized.append(Framer::encode(options, framerPayload(options, kFramerCheckMaxSize + 1, state)));
+        kept.append(framerPayload(options, kFramerCheckMaxSize, state));
+        oversized.append(Framer::encode(options, kept.back()));
+    }
+    for (const qsizetype chunkSize : QList<qsizetype>{oversized.size(), 1, 64}) {
+        std::unique_ptr<Framer> framer = Framer::create(options);
+        expect(feedFramer(*framer, oversized, chunkSize) == kept && framer->stats().errors == 1);
+    }
+
+    QJsonObject result;
+    result[u"scenario"_s] = u"framer"_s;
+    result[u"mode"_s]     = framingName(type);
+    result[u"cases"_s]    = double(cases);
+    result[u"failures"_s] = double(failures);
+    return result;
+}
+
+// Frames of the given size taken apart as they come off the port, in reads of 4 KB
+static QJsonObject framerThroughput(Framer::Type type, int payload, double seconds) {
+    Framer::Options options;
+    options.type      = type;
+    options.delimiter = "\r\n";
+
+    quint32    state = 0x2545F491;
+    QByteArray wire;
+    while (wire.size() < 256 * 1024) {
+        const QByteArray frame = Framer::encode(options, framerPayload(options, payload, state));
+        if (frame.isEmpty() == true) break;  // too long for a length prefix, nothing to measure
+        wire.append(frame);
+    }
+
+    std::unique_ptr<Framer> framer = Framer::create(options);
+    quint64                 frames = 0;
+    const Framer::Sink      sink   = [&frames](QByteArrayView) { frames++; };
+
+    const qint64 startNs = monotonicNs();
+    const qint64 endNs   = startNs + qint64(seconds * 1e9);
+    quint64      bytes   = 0;
+    qint64       nowNs   = startNs;
+    for (; nowNs < endNs; nowNs = monotonicNs()) {
+        for (qsizetype pos = 0; pos < wire.size(); pos += 4096) {
+            framer->feed(QByteArrayView(wire).sliced(pos, qMin<qsizetype>(4096, wire.size() - pos)), sink);
+        }
+        bytes += quint64(wire.size());
+    }
+
+    QJsonObject result;
+    result[u"scenario"_s]     = u"framer"_s;
+    result[u"mode"_s]         = framingName(type);
+    result[u"payload"_s]      = payload;
+    result[u"errors"_s]       = double(framer->stats().errors);
+    result[u"frames_per_s"_s] = double(frames) / (double(nowNs - startNs) / 1e9);
+    // Bytes as they come off the port, framing included
+    result[u"mb_per_s"_s] = double(bytes) / (1024.0 * 1024.0) / (double(nowNs - startNs) / 1e9);
+    return result;
+}
+
+// A 64 KB paste into the hex send field: normalized by the validator, checked
+// again by the next keystroke, then parsed and shown spaced when it is sent
+static QJsonObject pasteThroughput(const QString &layout, double seconds) {
+    quint32    state = 0x2545F491;
+    QByteArray bytes;
+    QString    paste;
+    while (paste.size() < kPasteSize) {
+        const char byte = char(nextRandom(state));
+        bytes.append(byte);
+        if (layout == u"lines"_s && bytes.size() % 16 == 1 && bytes.size() > 1) {
+            paste += u"\r\n"_s;
+        } else if (layout != u"unspaced"_s && bytes.size() > 1) {
+            paste += u' ';
+        }
+        paste += QString::fromLatin1(QByteArray(1, byte).toHex());
+    }
+
+    QByteArray   payload;
+    QByteArray   spaced;
+    quint64      pastes  = 0;
+    bool         isValid = true;
+    const qint64 startNs = monotonicNs();
+    const qint64 endNs   = startNs + qint64(seconds * 1e9);
+    qint64       nowNs   = startNs;
+    for (; nowNs < endNs; nowNs = monotonicNs(), pastes++) {
+        QString text = paste;
+        int     pos  = int(text.size());
+        HexDump::normalizeHexInput(text, pos);
+        HexDump::normalizeHexInput(text, pos);
+        isValid = HexDump::fromHexText(text, payload) == true && payload == bytes && isValid == true;
+        HexDump::toSpacedHex(payload, spaced);
+    }
+
+    QJsonObject result;
+    result[u"scenario"_s]     = u"paste"_s;
+    result[u"mode"_s]         = layout;
+    result[u"payload"_s]      = double(paste.size());
+    result[u"valid"_s]        = isValid;
+    result[u"ms_per_paste"_s] = double(nowNs - startNs) / 1e6 / double(qMax<quint64>(1, pastes));
+    // Characters pasted, one byte each
+    result[u"mb_per_s"_s] = double(pastes) * paste.size() / (1024.0 * 1024.0) / (double(nowNs - startNs) / 1e9);
+    return result;
+}
+
+// The data log as the receive view fills it: a label line, then the frame in
+// hex or, for ASCII, readings as a device would print them
+static QStringList searchLog(bool isHex, int payload) {
+    const QString states[] = {u"idle"_s, u"run"_s, u"stop"_s};
+
+    quint32     state = 0x9E3779B9;
+    QStringList lines;
+    QByteArray  frame(payload, Qt::Uninitialized);
+    for (int i = 0; i < kSearchFrames; i++) {
+        lines.append(isHex ? u"RECV HEX"_s : u"RECV ASCII"_s);
+        if (isHex == true) {
+            for (char &c : frame) c = char(nextRandom(state) >> 16);
+            lines.append(QString::fromLatin1(HexDump::toSpacedHex(frame)));
+            continue;
+        }
+        QString text;
+        while (text.size() < payload) {
+            const quint32 value = nextRandom(state);
+            text += u"temp=%1 rpm=%2 state=%3 "_s.arg((value >> 8) % 100).arg((value >> 16) % 4000).arg(
+                states[value % 3]);
+        }
+        lines.append(text.left(payload));
+    }
+    return lines;
+}
+
+// Every substring of the log must be let through by the index whatever its case
+static QJsonObject searchCheck(bool isHex) {
+    const QStringList lines = searchLog(isHex, 64);
+    LogIndex          index;
+    for (qsizetype i = 0; i < lines.size(); i++) index.add(quint64(i), lines[i]);
+
+    quint32 state    = 0x1B873593;
+    quint64 failures = 0;
+    for (int query = 0; query < kSearchCheckQueries; query++) {
+        const qsizetype line   = nextRandom(state) % lines.size();
+        const QString  &text   = lines[line];
+        const qsizetype start  = nextRandom(state) % text.size();
+        const qsizetype length = 1 + nextRandom(state) % qMin<qsizetype>(16, text.size() - start);
+        QString         needle = text.sliced(start, length);
+        for (QChar &c : needle) c = (nextRandom(state) % 2 == 0) ? c.toUpper() : c.toLower();
+        if (index.mayContain(quint64(line), LogIndex::signature(needle)) == false) failures++;
+    }
+
+    QJsonObject result;
+    result[u"scenario"_s] = u"search"_s;
+    result[u"mode"_s]     = isHex ? u"hex"_s : u"ascii"_s;
+    result[u"cases"_s]    = kSearchCheckQueries;
+    result[u"failures"_s] = double(failures);
+    return result;
+}
+
+// Lines indexed as the data log takes them, and how many blocks of the log a
+// search for words that are not in it still has to look at
+static QJsonObject searchThroughput(bool isHex, int payload, double seconds) {
+    const QStringList lines      = searchLog(isHex, payload);
+    qsizetype         characters = 0;
+    for (const QString &line : lines) characters += line.size();
+
+    LogIndex     index;
+    quint64      passes  = 0;
+    const qint64 startNs = monotonicNs();
+    const qint64 endNs   = startNs + qint64(seconds * 1e9);
+    qint64       nowNs   = startNs;
+    do {
+        index.clear();
+        for (qsizetype i = 0; i < lines.size(); i++) index.add(quint64(i), lines[i]);
+        passes++;
+        nowNs = monotonicNs();
+    } while (nowNs < endNs);
+
+    const quint64 blocks = (quint64(lines.size()) + LogIndex::kBlockLines - 1) / LogIndex::kBlockLines;
+    QJsonObject   visited;
+    for (const QString &word : {u"ERROR"_s, u"timeout"_s}) {
+        const LogIndex::Signature signature = LogIndex::signature(word);
+        quint64                   count     = 0;
+        for (quint64 block = 0; block < blocks; block++) {
+            if (index.mayContain(block * LogIndex::kBlockLines, signature) == true) count++;
+        }
+        visited[word] = double(count);
+    }
+
+    const double elapsed = double(nowNs - startNs);
+    QJsonObject  result;
+    result[u"scenario"_s]       = u"search"_s;
+    result[u"mode"_s]           = isHex ? u"hex"_s : u"ascii"_s;
+    result[u"payload"_s]        = payload;
+    result[u"lines"_s]          = double(lines.size());
+    result[u"blocks"_s]         = double(blocks);
+    result[u"blocks_visited"_s] = visited;
+    result[u"ns_per_char"_s]    = elapsed / double(passes) / double(characters);
+    // Characters indexed, one byte each
+    result[u"mb_per_s"_s] = double(passes) * double(characters) / (1024.0 * 1024.0) / (elapsed / 1e9);
+    return result;
+}
+
+class Bench {
+   public:
+    Bench(SerialWorker *worker, int masterFd, double seconds)
+        : m_worker(worker), m_masterFd(masterFd), m_durationNs(qint64(seconds * 1e9)) {}
+
+    // Frames of the given size from the far end as fast as the pty takes them,
+    // or at a fixed rate; every one is formatted the way the receive view does.
+    // With stallMs the receiving thread stops taking frames that long once a
+    // second, like a GUI busy with something else, and no frame may be lost.
+    // Under packet gap framing the frames keep their delimiter.
+    QJsonObject receive(int payload, bool isHex, int framesPerSecond, int stallMs = 0) {
+        std::atomic<quint64> framesSent{0};
+        std::atomic<bool>    isSenderDone{false};
+        qint64               peerCpuNs = 0;
+
+        const qint64 rssBefore = residentBytes();
+        const qint64 cpuBefore = cpuTimeNs(RUSAGE_SELF);
+        const qint64 startNs   = monotonicNs();
+
+        std::thread sender([&]() {
+            const qint64 threadCpuNs = cpuTimeNs(RUSAGE_THREAD);
+            const qint64 endNs       = startNs + m_durationNs;
+            const qint64 periodNs    = (framesPerSecond > 0) ? 1000000000LL / framesPerSecond : 0;
+            qint64       nextNs      = startNs;
+            QByteArray   frame(payload, 'x');
+            frame[payload - 1] = '\n';
+
+            for (qint64 nowNs = monotonicNs(); nowNs < endNs; nowNs = monotonicNs()) {
+                if (periodNs > 0) {
+                    if (nowNs < nextNs) {
+                        QThread::usleep(qMax<qint64>(1, (nextNs - nowNs) / 1000));
+                        continue;
+                    }
+                    nextNs += periodNs;
+                }
+                stampFrame(frame.data(), monotonicNs());
+                if (writeAll(m_masterFd, frame.constData(), frame.size()) == false) break;
+                framesSent.fetch_add(1, std::memory_order_release);
+            }
+            peerCpuNs = cpuTimeNs(RUSAGE_THREAD) - threadCpuNs;
+            isSenderDone.store(true, std::memory_order_release);
+        });
+
+        // The same drain as the receive view: take everything queued, format it once
+        const qsizetype  frameSize = (m_packetGap_ms > 0) ? payload : payload - 1;
+        LatencyHistogram latency;
+        quint64          frames      = 0;
+        quint64          bytes       = 0;
+        quint64          badFrames   = 0;
+        qint64           lastFrameNs = startNs;
+        QByteArray       hexBuffer;
+        QString          line;
+        SerialPacket     packet;
+        const auto       drain = [&]() {
+            m_worker->acknowledgePackets();
+            while (m_worker->takePacket(packet) == true) {
+                if (isHex == true) {
+                    HexDump::toSpacedHex(packet.data, hexBuffer);
+                    line = QString::fromLatin1(hexBuffer);
+                } else {
+                    line = QString::fromUtf8(packet.data);
+                }
+                lastFrameNs          = monotonicNs();
+                const qint64 stampNs = frameStamp(packet.data);
+                if (packet.data.size() != frameSize || stampNs < 0) {
+                    badFrames++;
+                } else {
+                    latency.record(lastFrameNs - stampNs);
+                }
+                frames++;
+                // With the delimiter, unless the frame still holds it
+                bytes += quint64(packet.data.size() + payload - frameSize);
+            }
+        };
+
+        QEventLoop loop;
+        QTimer     checkTimer;
+        qint64     senderDoneNs    = 0;
+        qint64     stallNs         = startNs;
+        quint64    maxQueueDepth   = 0;
+        quint64    maxBacklogDepth = 0;
+        bool       isComplete      = true;
+        QObject::connect(m_worker, &SerialWorker::packetsAvailable, &loop, drain);
+        QObject::connect(&checkTimer, &QTimer::timeout, &loop, [&]() {
+            if (stallMs > 0 && isSenderDone.load(std::memory_order_acquire) == false &&
+                monotonicNs() - stallNs >= kStallPeriod_ns) {
+                QThread::msleep(stallMs);
+                stallNs         = monotonicNs();
+                maxQueueDepth   = qMax(maxQueueDepth, m_worker->queueDepth());
+                maxBacklogDepth = qMax(maxBacklogDepth, m_worker->backlogDepth());
+            }
+            drain();
+            if (isSenderDone.load(std::memory_order_acquire) == false) return;
+            if (senderDoneNs == 0) senderDoneNs = monotonicNs();
+            if (frames + m_worker->frameErrors() - m_frameErrors >= framesSent.load(std::memory_order_acquire)) {
+                loop.quit();
+            } else if (monotonicNs() - senderDoneNs > kDrainTimeout_ns) {
+                isComplete = false;
+                loop.quit();
+            }
+        });
+        checkTimer.start(10);
+        loop.exec();
+        sender.join();
+
+        const qint64  cpuNs   = cpuTimeNs(RUSAGE_SELF) - cpuBefore;
+        const double  seconds = qMax(1e-9, double(lastFrameNs - startNs) / 1e9);
+        const quint64 errors  = m_worker->frameErrors() - m_frameErrors;
+        m_frameErrors         = m_worker->frameErrors();
+
+        QJsonObject result;
+        result[u"scenario"_s]     = (m_packetGap_ms > 0)    ? u"rx-gap"_s
+                                    : (stallMs > 0)         ? u"rx-stall"_s
+                                    : (framesPerSecond > 0) ? u"rx-paced"_s
+                                                            : u"rx"_s;
+        result[u"mode"_s]         = isHex ? u"hex"_s : u"ascii"_s;
+        result[u"payload"_s]      = payload;
+        result[u"seconds"_s]      = seconds;
+        result[u"frames_sent"_s]  = double(framesSent.load());
+        result[u"frames"_s]       = double(frames);
+        result[u"bytes"_s]        = double(bytes);
+        result[u"bad_frames"_s]   = double(badFrames + errors);
+        result[u"complete"_s]     = isComplete;
+        result[u"mb_per_s"_s]     = double(bytes) / (1024.0 * 1024.0) / seconds;
+        result[u"frames_per_s"_s] = double(frames) / seconds;
+        result[u"latency"_s]      = latencyObject(latency);
+        if (m_packetGap_ms > 0) result[u"packet_gap_ms"_s] = m_packetGap_ms;
+        if (stallMs > 0) {
+            // The worker holds what the GUI does not take, in its queue and then in its backlog.
+            // Every frame sent has to come through whole: one missing or cut short is a failure.
+            const qint64 dropped           = qint64(framesSent.load()) - qint64(frames + errors);
+            const qint64 intact            = qint64(frames) - qint64(badFrames);
+            result[u"stall_ms"_s]          = stallMs;
+            result[u"max_queue_depth"_s]   = double(maxQueueDepth);
+            result[u"max_backlog_depth"_s] = double(maxBacklogDepth);
+            result[u"dropped"_s]           = double(qMax<qint64>(0, dropped));
+            result[u"cases"_s]             = double(framesSent.load());
+            result[u"failures"_s]          = double(qMax<qint64>(0, qint64(framesSent.load()) - intact));
+        }
+        addCost(result, cpuNs, peerCpuNs, rssBefore, bytes);
+        return result;
+    }
+
+    // Messages of the given size written through the worker, hex messages
+    // parsed from their text each time as the send button does; the far end
+    // only counts what arrives
+    QJsonObject transmit(int payload, bool isHex) {
+        QByteArray message(payload, 'x');
+        for (int i = 0; i < payload; i++) message[i] = char('a' + i % 26);
+        const QString text = isHex ? QString::fromLatin1(HexDump::toSpacedHex(message)) : QString::fromLatin1(message);
+
+        std::atomic<quint64> bytesQueued{0};
+        std::atomic<quint64> messages{0};
+        std::atomic<bool>    isSenderDone{false};
+        qint64               peerCpuNs = 0;
+        quint64              received  = 0;
+
+        const qint64 rssBefore  = residentBytes();
+        const qint64 cpuBefore  = cpuTimeNs(RUSAGE_SELF);
+        const qint64 startNs    = monotonicNs();
+        const qint64 endNs      = startNs + m_durationNs;
+        qint64       lastByteNs = startNs;
+
+        std::thread reader([&]() {
+            const qint64 threadCpuNs = cpuTimeNs(RUSAGE_THREAD);
+            QByteArray   buffer(64 * 1024, Qt::Uninitialized);
+            qint64       senderDoneNs = 0;
+            for (;;) {
+                if (isSenderDone.load(std::memory_order_acquire) == true) {
+                    if (received >= bytesQueued.load(std::memory_order_acquire)) break;
+                    if (senderDoneNs == 0) senderDoneNs = monotonicNs();
+                    if (monotonicNs() - senderDoneNs > kDrainTimeout_ns) break;
+                }
+                pollfd fd{m_masterFd, POLLIN, 0};
+                if (::poll(&fd, 1, 10) <= 0) continue;
+                const ssize_t size = ::read(m_masterFd, buffer.data(), std::size_t(buffer.size()));
+                if (size > 0) {
+                    received += quint64(size);
+                    lastByteNs = monotonicNs();
+                }
+            }
+            peerCpuNs = cpuTimeNs(RUSAGE_THREAD) - threadCpuNs;
+        });
+
+        // Runs in the worker thread, topped up whenever the driver has taken some
+        QByteArray data;
+        const auto pump = [&]() {
+            if (isSenderDone.load(std::memory_order_relaxed) == true) return;
+            if (monotonicNs() >= endNs || m_worker->isOpen() == false) {
+                isSenderDone.store(true, std::memory_order_release);
+                return;
+            }
+            while (m_worker->bytesToWrite() < kMaxBytesToWrite) {
+                if (isHex == true) {
+                    HexDump::fromHexText(text, data);
+                } else {
+                    data = text.toUtf8();
+                }
+                m_worker->write(data);
+                bytesQueued.fetch_add(quint64(data.size()), std::memory_order_release);
+                messages.fetch_add(1, std::memory_order_relaxed);
+            }
+        };
+        const QMetaObject::Connection connection =
+            QObject::connect(m_worker, &SerialWorker::bytesAccepted, m_worker, pump);
+        QMetaObject::invokeMethod(m_worker, pump);
+
+        // Once the port runs dry no bytesWritten comes to notice the end, so it is ended from here
+        while (monotonicNs() < endNs) QThread::msleep(10);
+        QMetaObject::invokeMethod(
+            m_worker,
+            [&]() {
+                QObject::disconnect(connection);
+                isSenderDone.store(true, std::memory_order_release);
+            },
+            Qt::BlockingQueuedConnection);
+        reader.join();
+
+        const qint64 cpuNs   = cpuTimeNs(RUSAGE_SELF) - cpuBefore;
+        const double seconds = qMax(1e-9, double(lastByteNs - startNs) / 1e9);
+
+        QJsonObject result;
+        result[u"scenario"_s]       = u"tx"_s;
+        result[u"mode"_s]           = isHex ? u"hex"_s : u"ascii"_s;
+        result[u"payload"_s]        = payload;
+        result[u"seconds"_s]        = seconds;
+        result[u"messages"_s]       = double(messages.load());
+        result[u"bytes_queued"_s]   = double(bytesQueued.load());
+        result[u"bytes"_s]          = double(received);
+        result[u"complete"_s]       = received >= bytesQueued.load();
+        result[u"mb_per_s"_s]       = double(received) / (1024.0 * 1024.0) / seconds;
+        result[u"messages_per_s"_s] = double(messages.load()) / seconds;
+        addCost(result, cpuNs, peerCpuNs, rssBefore, received);
+        return result;
+    }
+
+    // The framing of the receive runs; with a packet gap the idle line ends the frames
+    void setFraming(const Framer::Options &options, int packetGapMs) {
+        QMetaObject::invokeMethod(
+            m_worker,
+            [this, options, packetGapMs]() {
+                m_worker->setPacketGap(packetGapMs);
+                m_worker->setFraming(options);
+            },
+            Qt::BlockingQueuedConnection);
+        m_packetGap_ms = (options.type == Framer::PacketGap) ? packetGapMs : 0;
+    }
+
+   private:
+    SerialWorker *m_worker;
+    int           m_masterFd;
+    qint64        m_durationNs;
+    quint64       m_frameErrors  = 0;
+    int           m_packetGap_ms = 0;
+};
+
+// Ports at once on the shared worker pool, the way as many tabs run them.
+// Every port has a pty of its own and gets frames at the given rate from a
+// thread of its own; all of them are drained by this thread like the tabs do.
+static QJsonObject portsThroughput(int portCount, int payload, int framesPerSecond, double seconds) {
+    struct Port {
+        int                  masterFd = -1;
+        int                  slaveFd  = -1;
+        SerialWorker        *worker   = nullptr;
+        std::atomic<quint64> framesSent{0};
+        quint64              frames    = 0;
+        qint64               peerCpuNs = 0;
+    };
+
+    Framer::Options framing;
+    framing.type      = Framer::Delimiter;
+    framing.delimiter = "\n";
+
+    QJsonObject result;
+    result[u"scenario"_s] = u"ports"_s;
+    result[u"mode"_s]     = u"ports=%1"_s.arg(portCount);
+    result[u"payload"_s]  = payload;
+
+    SerialWorkerPool                   pool;
+    std::vector<std::unique_ptr<Port>> ports;
+    bool                               isOpen = true;
+    for (int i = 0; i < portCount && isOpen == true; i++) {
+        auto   &port = *ports.emplace_back(std::make_unique<Port>());
+        termios attributes{};
+        cfmakeraw(&attributes);
+        if (openpty(&port.masterFd, &port.slaveFd, nullptr, &attributes, nullptr) < 0) {
+            result[u"error"_s] = u"openpty: %1"_s.arg(QString::fromLocal8Bit(std::strerror(errno)));
+            isOpen             = false;
+            break;
+        }
+        SerialSettings settings;
+        settings.portName = QString::fromLocal8Bit(ttyname(port.slaveFd));
+        port.worker       = pool.createWorker();
+        QMetaObject::invokeMethod(
+            port.worker,
+            [&]() {
+                port.worker->setFraming(framing);
+                isOpen = port.worker->open(settings);
+            },
+            Qt::BlockingQueuedConnection);
+        if (isOpen == false) result[u"error"_s] = u"Unable to open %1"_s.arg(settings.portName);
+    }
+
+    std::atomic<int>         sendersDone{0};
+    std::vector<std::thread> senders;
+    LatencyHistogram         latency;
+    quint64                  frames      = 0;
+    quint64                  bytes       = 0;
+    quint64                  badFrames   = 0;
+    const qint64             rssBefore   = residentBytes();
+    const qint64             cpuBefore   = cpuTimeNs(RUSAGE_SELF);
+    const qint64             startNs     = monotonicNs();
+    qint64                   lastFrameNs = startNs;
+    bool                     isComplete  = isOpen;
+
+    if (isOpen == true) {
+        for (const std::unique_ptr<Port> &port : ports) {
+            senders.emplace_back([&, port = port.get()]() {
+                const qint64 threadCpuNs = cpuTimeNs(RUSAGE_THREAD);
+                const qint64 endNs       = startNs + qint64(seconds * 1e9);
+                const qint64 periodNs    = 1000000000LL / framesPerSecond;
+                QByteArray   frame(payload, 'x');
+                frame[payload - 1] = '\n';
+
+                for (qint64 nextNs = startNs, nowNs = monotonicNs(); nowNs < endNs; nowNs = monotonicNs()) {
+                    if (nowNs < nextNs) {
+                        QThread::usleep(qMax<qint64>(1, (nextNs - nowNs) / 1000));
+                        continue;
+                    }
+                    nextNs += periodNs;
+                    stampFrame(frame.data(), monotonicNs());
+                    if (writeAll(port->masterFd, frame.constData(), frame.size()) == false) break;
+                    port->framesSent.fetch_add(1, std::memory_order_release);
+                }
+                port->peerCpuNs = cpuTimeNs(RUSAGE_THREAD) - threadCpuNs;
+                sendersDone.fetch_add(1, std::memory_order_release);
+            });
+        }
+
+        SerialPacket packet;
+        const auto   drain = [&](Port &port) {
+            port.worker->acknowledgePackets();
+            while (port.worker->takePacket(packet) == true) {
+                lastFrameNs          = monotonicNs();
+                const qint64 stampNs = frameStamp(packet.data);
+                if (packet.data.size() != payload - 1 || stampNs < 0) {
+                    badFrames++;
+                } else {
+                    latency.record(lastFrameNs - stampNs);
+                }
+                port.frames++;
+                frames++;
+                bytes += quint64(packet.data.size()) + 1;
+            }
+        };
+
+        QEventLoop loop;
+        QTimer     checkTimer;
+        qint64     sendersDoneNs = 0;
+        for (const std::unique_ptr<Port> &port : ports) {
+            QObject::connect(port->worker, &SerialWorker::packetsAvailable, &loop,
+                             [&drain, port = port.get()]() { drain(*port); });
+        }
+        QObject::connect(&checkTimer, &QTimer::timeout, &loop, [&]() {
+            for (const std::unique_ptr<Port> &port : ports) drain(*port);
+            if (sendersDone.load(std::memory_order_acquire) < portCount) return;
+            if (sendersDoneNs == 0) sendersDoneNs = monotonicNs();
+            const bool isAllReceived = std::all_of(ports.begin(), ports.end(), [](const std::unique_ptr<Port> &port) {
+                return port->frames + port->worker->frameErrors() >= port->framesSent.load(std::memory_order_acquire);
+            });
+            if (isAllReceived == true) {
+                loop.quit();
+            } else if (monotonicNs() - sendersDoneNs > kDrainTimeout_ns) {
+                isComplete = false;
+                loop.quit();
+            }
+        });
+        checkTimer.start(10);
+        loop.exec();
+        for (std::thread &sender : senders) sender.join();
+    }
+
+    const qint64 cpuNs      = cpuTimeNs(RUSAGE_SELF) - cpuBefore;
+    const double elapsed    = qMax(1e-9, double(lastFrameNs - startNs) / 1e9);
+    quint64      framesSent = 0;
+    quint64      errors     = 0;
+    qint64       peerCpuNs  = 0;
+    for (const std::unique_ptr<Port> &port : ports) {
+        framesSent += port->framesSent.load();
+        peerCpuNs += port->peerCpuNs;
+        if (port->worker != nullptr) {
+            errors += port->worker->frameErrors();
+            pool.releaseWorker(port->worker);
+        }
+        if (port->slaveFd >= 0) ::close(port->slaveFd);
+        if (port->masterFd >= 0) ::close(port->masterFd);
+    }
+
+    result[u"ports"_s]        = portCount;
+    result[u"threads"_s]      = pool.threadCount();
+    result[u"seconds"_s]      = elapsed;
+    result[u"frames_sent"_s]  = double(framesSent);
+    result[u"frames"_s]       = double(frames);
+    result[u"bytes"_s]        = double(bytes);
+    result[u"bad_frames"_s]   = double(badFrames + errors);
+    result[u"complete"_s]     = isComplete;
+    result[u"mb_per_s"_s]     = double(bytes) / (1024.0 * 1024.0) / elapsed;
+    result[u"frames_per_s"_s] = double(frames) / elapsed;
+    result[u"latency"_s]      = latencyObject(latency);
+    addCost(result, cpuNs, peerCpuNs, rssBefore, bytes);
+    return result;
+}
+
+// Byte of the bridge check stream at the given position, no two the same within 256
+static char bridgeByte(quint64 position) {
+    return char(position * 167 + 13);
+}
+
+// One port shared with two raw TCP clients and a WebSocket client on loopback.
+// The far end sends a fixed stream: the TCP client that reads and the WebSocket
+// client must get every byte of it in order, and the TCP client that never reads
+// must lose data or be disconnected, as the policy says. Then the reading TCP
+// client writes to the port, and a write of the WebSocket client right after it
+// must be refused and never reach the far end.
+static QJsonObject bridgeCheck(SerialBridge::SlowClientPolicy policy) {
+    const bool isDisconnect = (policy == SerialBridge::Disconnect);
+
+    QJsonObject result;
+    result[u"scenario"_s] = u"bridge"_s;
+    result[u"mode"_s]     = isDisconnect ? u"disconnect"_s : u"drop-oldest"_s;
+    result[u"cases"_s]    = 1;
+    result[u"failures"_s] = 1;
+
+    termios attributes{};
+    cfmakeraw(&attributes);
+    int masterFd = -1;
+    int slaveFd  = -1;
+    if (openpty(&masterFd, &slaveFd, nullptr, &attributes, nullptr) < 0) {
+        result[u"error"_s] = u"openpty: %1"_s.arg(QString::fromLocal8Bit(std::strerror(errno)));
+        return result;
+    }
+
+    // The bridge takes port 0 for no server, so it is given ports nothing listens on right now
+    QTcpServer tcpProbe;
+    QTcpServer webSocketProbe;
+    tcpProbe.listen(QHostAddress::LocalHost, 0);
+    webSocketProbe.listen(QHostAddress::LocalHost, 0);
+    SerialBridge::Options options;
+    options.address       = QHostAddress::LocalHost;
+    options.tcpPort       = tcpProbe.serverPort();
+    options.webSocketPort = webSocketProbe.serverPort();
+    options.maxBacklog    = kBridgeMaxBacklog;
+    options.policy        = policy;
+    tcpProbe.close();
+    webSocketProbe.close();
+
+    SerialSettings settings;
+    settings.portName = QString::fromLocal8Bit(ttyname(slaveFd));
+
+    QThread serialThread;
+    auto   *worker = new SerialWorker;
+    worker->moveToThread(&serialThread);
+    QObject::connect(&serialThread, &QThread::finished, worker, &QObject::deleteLater);
+    serialThread.start(QThread::TimeCriticalPriority);
+
+    // The bridge lives in the worker's thread, as it does for a tab
+    SerialBridge *bridge    = nullptr;
+    bool          isStarted = false;
+    QString       errorString;
+    QMetaObject::invokeMethod(
+        worker,
+        [&]() {
+            bridge = new SerialBridge(worker);
+            if (worker->open(settings) == false) {
+                errorString = u"Unable to open %1"_s.arg(settings.portName);
+                return;
+            }
+            isStarted = bridge->start(options, &errorString);
+        },
+        Qt::BlockingQueuedConnection);
+    if (isStarted == false) result[u"error"_s] = errorString;
+
+    // Nobody looks at the packets, they are only taken so that the worker does not pile them up
+    QObject    context;
+    QTcpSocket tcpClient;
+    QTcpSocket webSocketClient;
+    int        slowFd = -1;
+    QObject::connect(worker, &SerialWorker::packetsAvailable, &context, [worker]() {
+        SerialPacket packet;
+        worker->acknowledgePackets();
+        while (worker->takePacket(packet) == true) continue;
+    });
+
+    if (isStarted == true) {
+        quint64    tcpBytes          = 0;
+        quint64    webSocketBytes    = 0;
+        bool       isTcpIntact       = true;
+        bool       isWebSocketIntact = true;
+        bool       isUpgraded        = false;
+        QByteArray webSocketInput;
+        const auto take = [](QByteArrayView data, quint64 &position, bool &isIntact) {
+            for (const char c : data) isIntact = isIntact && c == bridgeByte(position++);
+        };
+        QObject::connect(&tcpClient, &QTcpSocket::readyRead, &context,
+                         [&]() { take(tcpClient.readAll(), tcpBytes, isTcpIntact); });
+        QObject::connect(&webSocketClient, &QTcpSocket::readyRead, &context, [&]() {
+            webSocketInput.append(webSocketClient.readAll());
+            if (isUpgraded == false) {
+                const qsizetype end = webSocketInput.indexOf("\r\n\r\n");
+                if (end < 0) return;
+                isUpgraded        = webSocketInput.startsWith("HTTP/1.1 101");
+                isWebSocketIntact = isUpgraded;
+                webSocketInput.remove(0, end + 4);
+            }
+            // Unmasked from the server, one binary message per chunk read from the port
+            qsizetype pos = 0;
+            for (;;) {
+                const uchar    *d    = reinterpret_cast<const uchar *>(webSocketInput.constData()) + pos;
+                const qsizetype size = webSocketInput.size() - pos;
+                if (size < 2) break;
+                quint64   length = d[1] & 0x7F;
+                qsizetype header = 2;
+                if (length == 126) {
+                    if (size < 4) break;
+                    length = (quint64(d[2]) << 8) | d[3];
+                    header = 4;
+                } else if (length == 127) {
+                    if (size < 10) break;
+                    length = 0;
+                    for (int i = 0; i < 8; i++) length = (length << 8) | d[2 + i];
+                    header = 10;
+                }
+                if (quint64(size - header) < length) break;
+                if ((d[0] & 0x0F) == 0x2) {
+                    take(QByteArrayView(d + header, qsizetype(length)), webSocketBytes, isWebSocketIntact);
+                } else {
+                    isWebSocketIntact = false;
+                }
+                pos += header + qsizetype(length);
+            }
+            webSocketInput.remove(0, pos);
+        });
+
+        tcpClient.connectToHost(QHostAddress::LocalHost, options.tcpPort);
+        webSocketClient.connectToHost(QHostAddress::LocalHost, options.webSocketPort);
+        webSocketClient.write("GET / HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                              "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n");
+        // Never reads, and its receive buffer is small, so the stream piles up in the bridge
+        const int   receiveBuffer = 4096;
+        sockaddr_in address{};
+        address.sin_family      = AF_INET;
+        address.sin_port        = htons(options.tcpPort);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        slowFd                  = ::socket(AF_INET, SOCK_STREAM, 0);
+        ::setsockopt(slowFd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+        const bool isConnected =
+            ::connect(slowFd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0 &&
+            waitUntil([&]() { return bridge->clientCount() == 3 && isUpgraded == true; }, kDrainTimeout_ns);
+
+        std::atomic<quint64> bytesSent{0};
+        std::atomic<bool>    isSenderDone{false};
+        const qint64         startNs = monotonicNs();
+        std::thread          sender([&]() {
+            QByteArray chunk(4096, Qt::Uninitialized);
+            for (quint64 position = 0; isConnected == true && position < quint64(kBridgeBytes);) {
+                for (char &c : chunk) c = bridgeByte(position++);
+                if (writeAll(masterFd, chunk.constData(), chunk.size()) == false) break;
+                bytesSent.fetch_add(quint64(chunk.size()), std::memory_order_release);
+            }
+            isSenderDone.store(true, std::memory_order_release);
+        });
+        waitUntil([&]() { return isSenderDone.load(std::memory_order_acquire); }, 0);
+        sender.join();
+
+        // Everything sent reached the clients that read, and the one that does not was dealt with
+        const quint64 sent = bytesSent.load();
+        waitUntil(
+            [&]() {
+                const bool isHandled = isDisconnect ? bridge->clientCount() == 2 : bridge->droppedBytes() > 0;
+                return tcpBytes >= sent && webSocketBytes >= sent && isHandled == true;
+            },
+            kDrainTimeout_ns);
+        const double seconds = qMax(1e-9, double(monotonicNs() - startNs) / 1e9);
+        const int    clients = bridge->clientCount();
+
+        // The TCP client takes the port; the WebSocket client, masking as clients must, is too soon after it
+        quint64    farEndBytes = 0;
+        const auto readFarEnd  = [&]() {
+            char   buffer[4096];
+            pollfd fd{masterFd, POLLIN, 0};
+            while (::poll(&fd, 1, 0) > 0) {
+                const ssize_t size = ::read(masterFd, buffer, sizeof(buffer));
+                if (size <= 0) break;
+                farEndBytes += quint64(size);
+            }
+            return farEndBytes;
+        };
+        tcpClient.write(QByteArray(kBridgeWriterBytes, 'w'));
+        waitUntil([&]() { return readFarEnd() >= quint64(kBridgeWriterBytes); }, kDrainTimeout_ns);
+        const char mask[4] = {0x12, 0x34, 0x56, 0x78};
+        QByteArray message;
+        message.append(char(0x82));  // final fragment, binary
+        message.append(char(0x80 | kBridgeRefusedBytes));
+        message.append(mask, 4);
+        for (int i = 0; i < kBridgeRefusedBytes; i++) message.append(char('r' ^ mask[i % 4]));
+        webSocketClient.write(message);
+        waitUntil([&]() { return bridge->refusedBytes() >= quint64(kBridgeRefusedBytes); }, kDrainTimeout_ns);
+        readFarEnd();
+
+        const bool isTcpDelivered       = isTcpIntact == true && tcpBytes == quint64(kBridgeBytes);
+        const bool isWebSocketDelivered = isWebSocketIntact == true && webSocketBytes == quint64(kBridgeBytes);
+        const bool isSlowClientHandled  = isDisconnect ? (clients == 2 && bridge->droppedBytes() == 0)
+                                                       : (clients == 3 && bridge->droppedBytes() > 0);
+        const bool isWriterHeard        = (farEndBytes == quint64(kBridgeWriterBytes));
+        const bool isOtherRefused       = (bridge->refusedBytes() == quint64(kBridgeRefusedBytes));
+
+        const bool passes[] = {isTcpDelivered, isWebSocketDelivered, isSlowClientHandled, isWriterHeard,
+                               isOtherRefused};
+        result[u"cases"_s]           = int(std::size(passes));
+        result[u"failures"_s]        = int(std::count(std::begin(passes), std::end(passes), false));
+        result[u"bytes"_s]           = double(sent);
+        result[u"tcp_bytes"_s]       = double(tcpBytes);
+        result[u"websocket_bytes"_s] = double(webSocketBytes);
+        result[u"dropped"_s]         = double(bridge->droppedBytes());
+        result[u"clients"_s]         = clients;
+        result[u"far_end_bytes"_s]   = double(farEndBytes);
+        result[u"refused"_s]         = double(bridge->refusedBytes());
+        result[u"seconds"_s]         = seconds;
+        // Of the stream, to each of the clients that read
+        result[u"mb_per_s"_s] = double(sent) / (1024.0 * 1024.0) / seconds;
+    }
+
+    tcpClient.abort();
+    webSocketClient.abort();
+    if (slowFd >= 0) ::close(slowFd);
+    QMetaObject::invokeMethod(
+        worker,
+        [&]() {
+            delete bridge;
+            worker->close();
+        },
+        Qt::BlockingQueuedConnection);
+    serialThread.quit();
+    serialThread.wait();
+    ::close(slaveFd);
+    ::close(masterFd);
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(u"comport-bench"_s);
+    QCoreApplication::setApplicationVersion(QStringLiteral(PROJECT_VERSION));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        u"Receive and transmit benchmarks over a pseudo terminal, results as JSON on stdout."_s);
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    const QCommandLineOption secondsOption(u"seconds"_s, u"Length of every run."_s, u"s"_s, u"2"_s);
+    const QCommandLineOption payloadsOption(u"payloads"_s, u"Frame sizes in bytes, comma separated."_s,
+                                            u"list"_s, u"32,256,4096"_s);
+    const QCommandLineOption rateOption(u"rate"_s, u"Frames per second of the paced receive runs."_s, u"n"_s,
+                                        u"1000"_s);
+    const QCommandLineOption portsOption(u"ports"_s,
+                                         u"Port counts of the paced runs on the shared worker pool, comma separated."_s,
+                                         u"list"_s, u"1,8,32"_s);
+    const QCommandLineOption outputOption({u"o"_s, u"output"_s}, u"Write the results to a file."_s, u"file"_s);
+    parser.addOptions({secondsOption, payloadsOption, rateOption, portsOption, outputOption});
+    parser.process(app);
+
+    bool         isSecondsNumber = false;
+    bool         isRateNumber    = false;
+    const double seconds         = parser.value(secondsOption).toDouble(&isSecondsNumber);
+    const int    rate            = parser.value(rateOption).toInt(&isRateNumber);
+    QList<int>   payloads;
+    bool         isPayloadValid = true;
+    for (const QString &item : parser.value(payloadsOption).split(u',', Qt::SkipEmptyParts)) {
+        bool      isNumber = false;
+        const int payload  = item.trimmed().toInt(&isNumber);
+        // Room for the time stamp and the delimiter
+        isPayloadValid = isPayloadValid && isNumber == true && payload > kStampSize && payload <= 64 * 1024;
+        payloads.append(payload);
+    }
+    QList<int> portCounts;
+    bool       isPortsValid = true;
+    for (const QString &item : parser.value(portsOption).split(u',', Qt::SkipEmptyParts)) {
+        bool      isNumber  = false;
+        const int portCount = item.trimmed().toInt(&isNumber);
+        isPortsValid        = isPortsValid && isNumber == true && portCount >= 1 && portCount <= kMaxPorts;
+        portCounts.append(portCount);
+    }
+    if (isSecondsNumber == false || seconds <= 0 || isRateNumber == false || rate <= 0 || isPayloadValid == false ||
+        payloads.isEmpty() == true || isPortsValid == false || portCounts.isEmpty() == true) {
+        qCritical("Invalid option value, see --help");
+        return 2;
+    }
+
+    // Raw from the start, the far end never sees an echo
+    termios attributes{};
+    cfmakeraw(&attributes);
+    int masterFd = -1;
+    int slaveFd  = -1;
+    if (openpty(&masterFd, &slaveFd, nullptr, &attributes, nullptr) < 0) {
+        qCritical("openpty: %s", std::strerror(errno));
+        return 1;
+    }
+
+    // The slave stays open here as well, so closing the port never hangs up the master
+    SerialSettings settings;
+    settings.portName = QString::fromLocal8Bit(ttyname(slaveFd));
+
+    Framer::Options framing;
+    framing.type      = Framer::Delimiter;
+    framing.delimiter = "\n";
+    Framer::Options gapFraming;
+    gapFraming.type = Framer::PacketGap;
+
+    QThread serialThread;
+    auto   *serialWorker = new SerialWorker;
+    serialWorker->setFraming(framing);
+    serialWorker->moveToThread(&serialThread);
+    QObject::connect(&serialThread, &QThread::finished, serialWorker, &QObject::deleteLater);
+    serialThread.start(QThread::TimeCriticalPriority);
+
+    bool isOpen = false;
+    QMetaObject::invokeMethod(
+        serialWorker, [&]() { isOpen = serialWorker->open(settings); }, Qt::BlockingQueuedConnection);
+    if (isOpen == false) {
+        qCritical("Unable to open %s", qPrintable(settings.portName));
+        serialThread.quit();
+        serialThread.wait();
+        return 1;
+    }
+
+    Bench      bench(serialWorker, masterFd, seconds);
+    QJsonArray results;
+    QJsonArray checks;
+    bool       isCheckFailed = false;
+    const auto run           = [&](const QJsonObject &result) {
+        std::fprintf(stderr, "%s %s %d: %.1f MB/s\n", qPrintable(result[u"scenario"_s].toString()),
+                     qPrintable(result[u"mode"_s].toString()), result[u"payload"_s].toInt(),
+                     result[u"mb_per_s"_s].toDouble());
+        results.append(result);
+    };
+    // Results are only worth keeping from code that does what it should
+    const auto check = [&](const QJsonObject &result) {
+        const qint64 failures = result[u"failures"_s].toInteger();
+        std::fprintf(stderr, "check %s %s: %lld of %lld failed\n", qPrintable(result[u"scenario"_s].toString()),
+                     qPrintable(result[u"mode"_s].toString()), failures, result[u"cases"_s].toInteger());
+        isCheckFailed = isCheckFailed || failures > 0;
+        checks.append(result);
+    };
+
+    for (const Checksum::Type type : {Checksum::Crc16Modbus, Checksum::Crc16Ccitt, Checksum::Crc32}) {
+        check(checksumCheck(type));
+    }
+    for (const HexDump::Kernel kernel : HexDump::supportedKernels()) check(hexCheck(kernel));
+    for (const Framer::Type type : {Framer::Delimiter, Framer::Slip, Framer::Cobs, Framer::LengthPrefixCrc}) {
+        check(framerCheck(type));
+    }
+    for (const bool isHex : {false, true}) check(searchCheck(isHex));
+    for (const SerialBridge::SlowClientPolicy policy : {SerialBridge::DropOldest, SerialBridge::Disconnect}) {
+        check(bridgeCheck(policy));
+    }
+
+    for (const bool isHex : {false, true}) {
+        for (const int payload : payloads) run(bench.receive(payload, isHex, 0));
+        run(bench.receive(payloads.first(), isHex, rate));
+        // A stall may slow the receive path down, it must not cost a frame
+        check(bench.receive(payloads.first(), isHex, 0, kStallMs));
+        // The end of every frame only found by the packet gap timer
+        bench.setFraming(gapFraming, kPacketGapMs);
+        run(bench.receive(payloads.first(), isHex, kPacketGapRate));
+        bench.setFraming(framing, 0);
+        for (const int payload : payloads) run(bench.transmit(payload, isHex));
+    }
+    for (const int portCount : portCounts) run(portsThroughput(portCount, payloads.first(), rate, seconds));
+    for (const Checksum::Type type : {Checksum::Xor8, Checksum::Crc16Modbus, Checksum::Crc16Ccitt, Checksum::Crc32}) {
+        for (const int payload : payloads) run(checksumThroughput(type, payload, qMin(seconds, 0.5)));
+    }
+    for (const StreamCompare::Mode mode : {StreamCompare::Frames, StreamCompare::Bytes}) {
+        for (const int payload : payloads) run(compareThroughput(mode, payload, qMin(seconds, 0.5)));
+    }
+    for (const int payload : payloads) {
+        run(hexThroughput(std::nullopt, payload, qMin(seconds, 0.5)));
+        for (const HexDump::Kernel kernel : HexDump::supportedKernels()) {
+            run(hexThroughput(kernel, payload, qMin(seconds, 0.5)));
+        }
+    }
+    for (const Framer::Type type : {Framer::Delimiter, Framer::Slip, Framer::Cobs, Framer::LengthPrefixCrc}) {
+        for (const int payload : payloads) run(framerThroughput(type, payload, qMin(seconds, 0.5)));
+    }
+    for (const QString &layout : {u"spaced"_s, u"unspaced"_s, u"lines"_s}) {
+        run(pasteThroughput(layout, qMin(seconds, 0.5)));
+    }
+    for (const bool isHex : {false, true}) run(searchThroughput(isHex, payloads.first(), qMin(seconds, 0.5)));
+
+    QMetaObject::invokeMethod(
+        serialWorker, [serialWorker]() { serialWorker->close(); }, Qt::BlockingQueuedConnection);
+    serialThread.quit();
+    serialThread.wait();
+    ::close(slaveFd);
+    ::close(masterFd);
+
+    QJsonObject document;
+    document[u"version"_s] = QStringLiteral(PROJECT_VERSION);
+    document[u"qt"_s]      = QString::fromLatin1(qVersion());
+    document[u"time"_s]    = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    document[u"cpus"_s]    = QThread::idealThreadCount();
+    document[u"seconds"_s] = seconds;
+    document[u"results"_s] = results;
+    document[u"checks"_s]  = checks;
+    const QByteArray json  = QJsonDocument(document).toJson();
+
+    if (parser.isSet(outputOption) == false) {
+        std::fwrite(json.constData(), 1, std::size_t(json.size()), stdout);
+        return isCheckFailed ? 1 : 0;
+    }
+    QFile file(parser.value(outputOption));
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate) == false || file.write(json) != json.size()) {
+        qCritical("%s: %s", qPrintable(file.fileName()), qPrintable(file.errorString()));
+        return 1;
+    }
+    return isCheckFailed ? 1 : 0;
+}
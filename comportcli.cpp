@@ -0,0 +1,520 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QThread>
+#include <QTimer>
+#include <QtSerialPort/QSerialPortInfo>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <memory>
+
+#include "checksum.h"
+#include "dissector.h"
+#include "filesender.h"
+#include "hexdump.h"
+#include "metrics.h"
+#include "portreconnector.h"
+#include "sequence.h"
+#include "sequencerunner.h"
+#include "serialbridge.h"
+#include "serialworker.h"
+#include "triggercapture.h"
+
+#ifdef Q_OS_UNIX
+#include <QSocketNotifier>
+#include <unistd.h>
+
+#include <cerrno>
+#else
+#include <fcntl.h>
+#include <io.h>
+
+#include <thread>
+#endif
+
+using namespace Qt::StringLiterals;
+
+// Stdin is only read while the port has less than this waiting to go out
+static constexpr quint64 kMaxBytesToWrite = 64 * 1024;
+
+static volatile std::sig_atomic_t g_quitRequested = 0;
+
+static void requestQuit(int) {
+    g_quitRequested = 1;
+}
+
+static int listPorts() {
+    const auto infos = QSerialPortInfo::availablePorts();
+    for (const QSerialPortInfo &info : infos) {
+        std::printf("%s\t%s\t%04x:%04x\t%s\n", qPrintable(info.portName()), qPrintable(info.description()),
+                    info.vendorIdentifier(), info.productIdentifier(), qPrintable(info.serialNumber()));
+    }
+    return 0;
+}
+
+static bool parseFraming(const QString &name, Framer::Type &type) {
+    static const QList<std::pair<QString, Framer::Type>> names = {
+        {u"gap"_s, Framer::PacketGap},  {u"delimiter"_s, Framer::Delimiter},     {u"slip"_s, Framer::Slip},
+        {u"cobs"_s, Framer::Cobs},      {u"length-crc"_s, Framer::LengthPrefixCrc},
+    };
+    for (const auto &[text, value] : names) {
+        if (text == name) {
+            type = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// text=<escaped>, hex=<bytes>, regex=<expression> or gap=<ms>
+static bool parseTrigger(const QString &spec, TriggerCapture::Options &options) {
+    const qsizetype split = spec.indexOf(u'=');
+    if (split < 0) return false;
+
+    const QString kind    = spec.left(split);
+    const QString value   = spec.mid(split + 1);
+    bool          isValid = false;
+
+    if (kind == "text"_L1 || kind == "hex"_L1) {
+        options.type = TriggerCapture::Pattern;
+        if (kind == "text"_L1) options.pattern = Sequence::unescape(value.toUtf8());
+        isValid = (kind == "text"_L1) || HexDump::fromHexText(value, options.pattern);
+        return isValid && options.pattern.isEmpty() == false;
+    }
+    if (kind == "regex"_L1) {
+        options.type  = TriggerCapture::Regex;
+        options.regex = value;
+        return true;
+    }
+    if (kind == "gap"_L1) {
+        options.type   = TriggerCapture::Gap;
+        options.gap_ms = value.toInt(&isValid);
+        return isValid && options.gap_ms > 0;
+    }
+    return false;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(u"comport-cli"_s);
+    QCoreApplication::setApplicationVersion(QStringLiteral(PROJECT_VERSION));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        u"Headless serial terminal. Received frames go to stdout, stdin is written to the port."_s);
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    const QCommandLineOption listOption({u"l"_s, u"list"_s}, u"List the available serial ports and exit."_s);
+    const QCommandLineOption portOption({u"p"_s, u"port"_s}, u"Serial port to open."_s, u"name"_s);
+    const QCommandLineOption lineOption({u"b"_s, u"line"_s}, u"Line settings, e.g. 115200,8N1."_s, u"spec"_s,
+                                        u"115200,8N1"_s);
+    const QCommandLineOption flowOption(u"flow"_s, u"Flow control: none, hw or sw."_s, u"mode"_s, u"none"_s);
+    const QCommandLineOption framingOption(u"framing"_s, u"Receive framing: gap, delimiter, slip, cobs or length-crc."_s,
+                                           u"mode"_s, u"gap"_s);
+    const QCommandLineOption delimiterOption(u"delimiter"_s, u"Frame delimiter, C escapes allowed."_s, u"text"_s,
+                                             u"\\n"_s);
+    const QCommandLineOption gapOption(u"gap"_s, u"Idle time in ms that ends a frame in gap framing."_s, u"ms"_s,
+                                       u"2"_s);
+    const QCommandLineOption hexOption(u"hex"_s, u"Print every received frame as a line of hex bytes."_s);
+    const QCommandLineOption recordOption(u"record"_s, u"Record the session to a .cps file."_s, u"file"_s);
+    const QCommandLineOption sendOption(u"send"_s, u"Send this text once after opening, C escapes allowed."_s,
+                                        u"text"_s);
+    const QCommandLineOption sequenceOption(u"sequence"_s, u"Run a sequence file and exit when it is done."_s,
+                                            u"file"_s);
+    const QCommandLineOption noStdinOption(u"no-stdin"_s, u"Do not forward stdin to the port."_s);
+    const QCommandLineOption exitOnEofOption(u"exit-on-eof"_s, u"Exit once stdin is exhausted and sent."_s);
+    const QCommandLineOption sendFileOption(u"send-file"_s, u"Stream a file to the port and exit when it is sent."_s,
+                                            u"file"_s);
+    const QCommandLineOption chunkSizeOption(u"chunk-size"_s, u"Bytes handed to the port at a time by --send-file."_s,
+                                             u"bytes"_s, u"4096"_s);
+    const QCommandLineOption chunkDelayOption(u"chunk-delay"_s, u"Pause after every --send-file chunk has left."_s,
+                                              u"ms"_s, u"0"_s);
+    const QCommandLineOption metricsOption(
+        u"metrics"_s, u"Write metrics every second: rows appended to a .csv, else a Prometheus text file."_s,
+        u"file"_s);
+    const QCommandLineOption reconnectOption(
+        u"reconnect"_s, u"Reopen the port when its device comes back, give up after this many seconds."_s, u"s"_s);
+    const QCommandLineOption dissectOption(
+        u"dissect"_s, u"Print frames decoded, as modbus or by a field layout file; others are printed as hex."_s,
+        u"protocol"_s);
+    const QCommandLineOption triggerOption(
+        u"trigger"_s, u"Keep recent traffic in memory, save it when text=, hex=, regex= or gap=<ms> fires."_s,
+        u"spec"_s);
+    const QCommandLineOption triggerDirOption(u"trigger-dir"_s, u"Folder trigger captures are saved to."_s, u"dir"_s,
+                                              u"."_s);
+    const QCommandLineOption preTriggerOption(u"pre-trigger"_s, u"Megabytes kept ahead of a trigger."_s, u"MB"_s,
+                                              u"4"_s);
+    const QCommandLineOption postTriggerOption(u"post-trigger"_s, u"Time captured after a trigger."_s, u"ms"_s,
+                                               u"2000"_s);
+    const QCommandLineOption checksumOption(
+        u"checksum"_s, u"Append none, xor, modbus, ccitt or crc32 to --send, check it on received frames."_s,
+        u"type"_s, u"none"_s);
+    const QCommandLineOption bridgeTcpOption(u"bridge-tcp"_s, u"Share the port with raw TCP clients on this port."_s,
+                                             u"port"_s, u"0"_s);
+    const QCommandLineOption bridgeWebSocketOption(
+        u"bridge-ws"_s, u"Share the port with WebSocket clients on this port."_s, u"port"_s, u"0"_s);
+    const QCommandLineOption bridgeAddressOption(u"bridge-address"_s,
+                                                 u"Address the bridge listens on, all interfaces if not given."_s,
+                                                 u"address"_s);
+    const QCommandLineOption bridgeSlowOption(u"bridge-slow"_s, u"Clients that fall behind: drop or disconnect."_s,
+                                              u"policy"_s, u"drop"_s);
+    parser.addOptions({listOption, portOption, lineOption, flowOption, framingOption, delimiterOption, gapOption,
+                       hexOption, recordOption, sendOption, sequenceOption, noStdinOption, exitOnEofOption,
+                       sendFileOption, chunkSizeOption, chunkDelayOption, metricsOption, reconnectOption,
+                       dissectOption, triggerOption, triggerDirOption, preTriggerOption, postTriggerOption,
+                       checksumOption, bridgeTcpOption, bridgeWebSocketOption, bridgeAddressOption, bridgeSlowOption});
+    parser.process(app);
+
+    if (parser.isSet(listOption) == true) return listPorts();
+
+    SerialSettings      settings;
+    Framer::Options     framing;
+    FileSender::Options     sendFile;
+    TriggerCapture::Options trigger;
+    SerialBridge::Options   bridge;
+    Checksum::Type          checksum = Checksum::None;
+    bool                    isNumber      = false;
+    bool                    isChunkNumber = false;
+    bool                    isDelayNumber = false;
+    bool                    isReconnect   = parser.isSet(reconnectOption);
+    bool                    isTimeout     = true;
+    bool                    isTrigger     = parser.isSet(triggerOption);
+    bool                    isPreNumber   = false;
+    bool                    isPostNumber  = false;
+    bool                    isBridgeTcp   = false;
+    bool                    isBridgeWs    = false;
+    const int               gap_ms        = parser.value(gapOption).toInt(&isNumber);
+    const int               reconnect_s   = isReconnect ? parser.value(reconnectOption).toInt(&isTimeout) : 0;
+    const uint              bridgeTcpPort = parser.value(bridgeTcpOption).toUInt(&isBridgeTcp);
+    const uint              bridgeWsPort  = parser.value(bridgeWebSocketOption).toUInt(&isBridgeWs);
+    const QString           bridgeSlow    = parser.value(bridgeSlowOption);
+    settings.portName                     = parser.value(portOption);
+    framing.delimiter                     = Sequence::unescape(parser.value(delimiterOption).toUtf8());
+    sendFile.fileName                     = parser.value(sendFileOption);
+    sendFile.chunkSize                    = parser.value(chunkSizeOption).toInt(&isChunkNumber);
+    sendFile.chunkDelay_ms                = parser.value(chunkDelayOption).toInt(&isDelayNumber);
+    trigger.directory                     = parser.value(triggerDirOption);
+    trigger.preTriggerSize                = qint64(parser.value(preTriggerOption).toInt(&isPreNumber)) * 1024 * 1024;
+    trigger.postTrigger_ms                = parser.value(postTriggerOption).toInt(&isPostNumber);
+    bridge.tcpPort                        = quint16(bridgeTcpPort);
+    bridge.webSocketPort                  = quint16(bridgeWsPort);
+    bridge.policy = (bridgeSlow == "disconnect"_L1) ? SerialBridge::Disconnect : SerialBridge::DropOldest;
+    if (parser.isSet(bridgeAddressOption) == true) bridge.address = QHostAddress(parser.value(bridgeAddressOption));
+    if (settings.portName.isEmpty() == true) {
+        qCritical("No port given, see --help");
+        return 2;
+    }
+    if (settings.parseLine(parser.value(lineOption)) == false ||
+        settings.parseFlowControl(parser.value(flowOption)) == false ||
+        parseFraming(parser.value(framingOption), framing.type) == false || isNumber == false || gap_ms < 0 ||
+        framing.delimiter.isEmpty() == true || isChunkNumber == false || sendFile.chunkSize <= 0 ||
+        isDelayNumber == false || sendFile.chunkDelay_ms < 0 || isTimeout == false || reconnect_s < 0 ||
+        (isTrigger == true && parseTrigger(parser.value(triggerOption), trigger) == false) || isPreNumber == false ||
+        trigger.preTriggerSize <= 0 || isPostNumber == false || trigger.postTrigger_ms < 0 || isBridgeTcp == false ||
+        bridgeTcpPort > 0xFFFF || isBridgeWs == false || bridgeWsPort > 0xFFFF ||
+        (bridgeSlow != "drop"_L1 && bridgeSlow != "disconnect"_L1) || bridge.address.isNull() == true ||
+        Checksum::parse(parser.value(checksumOption), checksum) == false) {
+        qCritical("Invalid option value, see --help");
+        return 2;
+    }
+
+    Sequence sequence;
+    QString  errorString;
+    if (parser.isSet(sequenceOption) == true &&
+        Sequence::load(parser.value(sequenceOption), sequence, &errorString) == false) {
+        qCritical("%s: %s", qPrintable(parser.value(sequenceOption)), qPrintable(errorString));
+        return 2;
+    }
+
+    std::unique_ptr<Dissector> dissector;
+    if (parser.isSet(dissectOption) == true) {
+        const QString protocol = parser.value(dissectOption);
+        dissector = (protocol == "modbus"_L1) ? Dissector::modbusRtu() : Dissector::load(protocol, &errorString);
+        if (dissector == nullptr) {
+            qCritical("%s: %s", qPrintable(protocol), qPrintable(errorString));
+            return 2;
+        }
+    }
+
+    // Same split as the GUI: the port lives in its own thread, the main thread only does stdio
+    QThread serialThread;
+    auto   *serialWorker = new SerialWorker;
+    serialWorker->setPacketGap(gap_ms);
+    serialWorker->setFraming(framing);
+    serialWorker->moveToThread(&serialThread);
+    QObject::connect(&serialThread, &QThread::finished, serialWorker, &QObject::deleteLater);
+    serialThread.start(QThread::TimeCriticalPriority);
+
+    bool isOpen      = false;
+    bool isRecording = true;
+    QMetaObject::invokeMethod(
+        serialWorker,
+        [&]() {
+            isOpen = serialWorker->open(settings);
+            if (isOpen == true && parser.isSet(recordOption) == true) {
+                isRecording = serialWorker->startRecording(parser.value(recordOption), &errorString);
+            }
+        },
+        Qt::BlockingQueuedConnection);
+    if (isOpen == false || isRecording == false) {
+        if (isOpen == false) qCritical("Unable to open %s", qPrintable(settings.portName));
+        if (isRecording == false) qCritical("Unable to record: %s", qPrintable(errorString));
+        serialThread.quit();
+        serialThread.wait();
+        return 1;
+    }
+    qInfo("%s open at %s", qPrintable(settings.portName), qPrintable(settings.lineString()));
+
+    MetricsCollector metrics(serialWorker);
+    metrics.setPortName(settings.portName);
+    if (parser.isSet(metricsOption) == true && metrics.startExport(parser.value(metricsOption), &errorString) == false) {
+        qCritical("Unable to write metrics: %s", qPrintable(errorString));
+        QMetaObject::invokeMethod(
+            serialWorker, [serialWorker]() { serialWorker->close(); }, Qt::BlockingQueuedConnection);
+        serialThread.quit();
+        serialThread.wait();
+        return 1;
+    }
+
+#ifndef Q_OS_UNIX
+    _setmode(_fileno(stdout), _O_BINARY);
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    std::setvbuf(stdout, nullptr, _IOFBF, 64 * 1024);
+
+    // Received frames: drained in batches, one flush per batch
+    const bool            isHex = parser.isSet(hexOption);
+    QByteArray            hexBuffer;
+    SerialPacket          packet;
+    Dissector::Dissection dissection;
+    const auto            drain = [&]() {
+        serialWorker->acknowledgePackets();
+        while (serialWorker->takePacket(packet) == true) {
+            metrics.recordLatency(SessionFormat::monotonicNs() - packet.timestampNs);
+            if (dissector != nullptr) dissector->dissect(packet.data, dissection);
+            if (dissector != nullptr && dissection.status != Dissector::NoMatch) {
+                hexBuffer = dissector->format(dissection, packet.data).toUtf8();
+                hexBuffer.append('\n');
+                std::fwrite(hexBuffer.constData(), 1, std::size_t(hexBuffer.size()), stdout);
+            } else if (isHex == true || dissector != nullptr) {
+                HexDump::toSpacedHex(packet.data, hexBuffer);
+                hexBuffer.append('\n');
+                std::fwrite(hexBuffer.constData(), 1, std::size_t(hexBuffer.size()), stdout);
+            } else {
+                std::fwrite(packet.data.constData(), 1, std::size_t(packet.data.size()), stdout);
+            }
+            // On a line of its own after hex, on stderr where the raw bytes are not to be mixed with it
+            if (checksum != Checksum::None) {
+                const QByteArray result = Checksum::describe(checksum, packet.data).toUtf8();
+                if (isHex == true || dissector != nullptr) {
+                    std::fprintf(stdout, "%s\n", result.constData());
+                } else {
+                    std::fprintf(stderr, "%s\n", result.constData());
+                }
+            }
+        }
+        std::fflush(stdout);
+    };
+    QObject::connect(serialWorker, &SerialWorker::packetsAvailable, &app, drain);
+    QObject::connect(serialWorker, &SerialWorker::errorOccurred, &app,
+                     [isReconnect](QSerialPort::SerialPortError error) {
+                         if (error == QSerialPort::ResourceError && isReconnect == false) QCoreApplication::exit(1);
+                     });
+    QObject::connect(serialWorker, &SerialWorker::recordingFailed, &app,
+                     [](const QString &fileName, const QString &errorString) {
+                         Q_UNUSED(fileName);
+                         qCritical("Unable to record: %s", qPrintable(errorString));
+                         QCoreApplication::exit(1);
+                     });
+
+    // The port is found again by serial number and VID:PID, under whatever name it comes back.
+    // Without --reconnect nothing watches for devices coming and going.
+    std::unique_ptr<PortMonitor>     portMonitor;
+    std::unique_ptr<PortReconnector> portReconnector;
+    if (isReconnect == true) {
+        portMonitor     = std::make_unique<PortMonitor>();
+        portReconnector = std::make_unique<PortReconnector>(serialWorker, portMonitor.get());
+        portReconnector->setTimeout(reconnect_s * 1000);
+        portReconnector->setEnabled(true);
+        portReconnector->watch(settings.portName);
+        QObject::connect(portReconnector.get(), &PortReconnector::connectionLost, &app, [](const QString &portName) {
+            qWarning("%s lost, waiting for it to come back", qPrintable(portName));
+        });
+        QObject::connect(portReconnector.get(), &PortReconnector::reconnected, &app,
+                         [](const QString &portName, qint64 downtime_ms) {
+                             qInfo("%s reopened after %lld ms", qPrintable(portName), downtime_ms);
+                         });
+        QObject::connect(portReconnector.get(), &PortReconnector::gaveUp, &app, [](const QString &portName) {
+            qCritical("%s did not come back", qPrintable(portName));
+            QCoreApplication::exit(1);
+        });
+    }
+
+    if (parser.isSet(sendOption) == true) {
+        QByteArray data = Sequence::unescape(parser.value(sendOption).toUtf8());
+        Checksum::append(checksum, data);
+        QMetaObject::invokeMethod(serialWorker, [serialWorker, data]() { serialWorker->write(data); });
+    }
+
+    // A sequence and a file transfer may run side by side, the last one to finish ends the run
+    int        pendingJobs = 0;
+    const auto jobFinished = [&pendingJobs]() {
+        if (--pendingJobs == 0) QCoreApplication::quit();
+    };
+
+    if (sequence.steps.empty() == false) {
+        auto *sequenceRunner = new SequenceRunner(serialWorker);
+        sequenceRunner->moveToThread(&serialThread);
+        QObject::connect(&serialThread, &QThread::finished, sequenceRunner, &QObject::deleteLater);
+        QObject::connect(sequenceRunner, &SequenceRunner::finished, &app, [jobFinished](const QStringList &report) {
+            for (const QString &line : report) qInfo("%s", qPrintable(line));
+            jobFinished();
+        });
+        QMetaObject::invokeMethod(sequenceRunner, [sequenceRunner, sequence]() { sequenceRunner->start(sequence); });
+        pendingJobs++;
+    }
+
+    if (isTrigger == true) {
+        auto *triggerCapture = new TriggerCapture(serialWorker);
+        bool  isArmed        = false;
+        triggerCapture->moveToThread(&serialThread);
+        QObject::connect(&serialThread, &QThread::finished, triggerCapture, &QObject::deleteLater);
+        QObject::connect(triggerCapture, &TriggerCapture::triggered, &app,
+                         [](const QString &reason) { qInfo("Trigger: %s", qPrintable(reason)); });
+        QObject::connect(triggerCapture, &TriggerCapture::saved, &app, [](const QString &fileName, quint64 bytes) {
+            qInfo("Capture saved to %s, %llu bytes", qPrintable(fileName), bytes);
+        });
+        QObject::connect(triggerCapture, &TriggerCapture::failed, &app,
+                         [](const QString &errorString) { qWarning("Unable to save: %s", qPrintable(errorString)); });
+        QMetaObject::invokeMethod(
+            triggerCapture, [&]() { isArmed = triggerCapture->start(trigger, &errorString); },
+            Qt::BlockingQueuedConnection);
+        if (isArmed == false) {
+            qCritical("Unable to arm the trigger: %s", qPrintable(errorString));
+            QMetaObject::invokeMethod(
+                serialWorker, [serialWorker]() { serialWorker->close(); }, Qt::BlockingQueuedConnection);
+            serialThread.quit();
+            serialThread.wait();
+            return 1;
+        }
+    }
+
+    if (bridge.tcpPort != 0 || bridge.webSocketPort != 0) {
+        auto *serialBridge = new SerialBridge(serialWorker);
+        bool  isListening  = false;
+        serialBridge->moveToThread(&serialThread);
+        QObject::connect(&serialThread, &QThread::finished, serialBridge, &QObject::deleteLater);
+        QObject::connect(serialBridge, &SerialBridge::clientsChanged, &app,
+                         [](int count) { qInfo("Bridge clients: %d", count); });
+        QObject::connect(serialBridge, &SerialBridge::notice, &app,
+                         [](const QString &text) { qWarning("Bridge: %s", qPrintable(text)); });
+        QMetaObject::invokeMethod(
+            serialBridge, [&]() { isListening = serialBridge->start(bridge, &errorString); },
+            Qt::BlockingQueuedConnection);
+        if (isListening == false) {
+            qCritical("Unable to start the bridge: %s", qPrintable(errorString));
+            QMetaObject::invokeMethod(
+                serialWorker, [serialWorker]() { serialWorker->close(); }, Qt::BlockingQueuedConnection);
+            serialThread.quit();
+            serialThread.wait();
+            return 1;
+        }
+    }
+
+    if (sendFile.fileName.isEmpty() == false) {
+        auto *fileSender = new FileSender(serialWorker);
+        bool  isStarted  = false;
+        fileSender->moveToThread(&serialThread);
+        QObject::connect(&serialThread, &QThread::finished, fileSender, &QObject::deleteLater);
+        QObject::connect(fileSender, &FileSender::finished, &app, [jobFinished](const QString &report) {
+            qInfo("%s", qPrintable(report));
+            jobFinished();
+        });
+        QMetaObject::invokeMethod(
+            fileSender, [&]() { isStarted = fileSender->start(sendFile, &errorString); }, Qt::BlockingQueuedConnection);
+        if (isStarted == false) {
+            qCritical("%s: %s", qPrintable(sendFile.fileName), qPrintable(errorString));
+            QMetaObject::invokeMethod(
+                serialWorker, [serialWorker]() { serialWorker->close(); }, Qt::BlockingQueuedConnection);
+            serialThread.quit();
+            serialThread.wait();
+            return 1;
+        }
+        pendingJobs++;
+    }
+
+    // Stdin is forwarded in blocks as they arrive, paused while the port is still busy
+    bool             isStdinDone = parser.isSet(noStdinOption);
+    const bool       exitOnEof   = parser.isSet(exitOnEofOption);
+    std::atomic<int> blocksInFlight{0};  // handed to the worker but not written to the port yet
+    QTimer           pollTimer;
+    const auto       stdinBlock = [&](const QByteArray &block) {
+        if (block.isEmpty() == true) {
+            isStdinDone = true;
+            return;
+        }
+        blocksInFlight.fetch_add(1, std::memory_order_relaxed);
+        QMetaObject::invokeMethod(serialWorker, [serialWorker, block, &blocksInFlight]() {
+            serialWorker->write(block);
+            blocksInFlight.fetch_sub(1, std::memory_order_release);
+        });
+    };
+#ifdef Q_OS_UNIX
+    QSocketNotifier stdinNotifier(STDIN_FILENO, QSocketNotifier::Read);
+    stdinNotifier.setEnabled(isStdinDone == false);
+    QObject::connect(&stdinNotifier, &QSocketNotifier::activated, &app, [&]() {
+        QByteArray      block(64 * 1024, Qt::Uninitialized);
+        const qsizetype size = ::read(STDIN_FILENO, block.data(), std::size_t(block.size()));
+        stdinNotifier.setEnabled(false);
+        if (size < 0 && (errno == EINTR || errno == EAGAIN)) return;
+
+        block.resize(qMax<qsizetype>(size, 0));
+        stdinBlock(block);
+    });
+#else
+    // Console and pipe handles cannot be watched by the event loop here, a reader thread feeds it instead
+    if (isStdinDone == false) {
+        std::thread([&app, stdinBlock]() {
+            for (;;) {
+                QByteArray block(64 * 1024, Qt::Uninitialized);
+                const int  size = _read(_fileno(stdin), block.data(), unsigned(block.size()));
+                block.resize(qMax(size, 0));
+                QMetaObject::invokeMethod(&app, [stdinBlock, block]() { stdinBlock(block); });
+                if (size <= 0) return;
+            }
+        }).detach();
+    }
+#endif
+
+    // Signals, stdin pacing and end of input are all looked at from here
+    QObject::connect(&pollTimer, &QTimer::timeout, &app, [&]() {
+        if (g_quitRequested != 0) QCoreApplication::quit();
+#ifdef Q_OS_UNIX
+        if (isStdinDone == false && stdinNotifier.isEnabled() == false &&
+            serialWorker->bytesToWrite() < kMaxBytesToWrite) {
+            stdinNotifier.setEnabled(true);
+        }
+#endif
+        const bool isSent = (blocksInFlight.load(std::memory_order_acquire) == 0) && (serialWorker->bytesToWrite() == 0);
+        if (exitOnEof == true && isStdinDone == true && isSent == true && pendingJobs == 0) {
+            QCoreApplication::quit();
+        }
+    });
+    pollTimer.start(5);
+    std::signal(SIGINT, requestQuit);
+    std::signal(SIGTERM, requestQuit);
+
+    const int exitCode = app.exec();
+
+    // Hand over what is still buffered, then stop the thread; the recorder closes with the worker
+    QMetaObject::invokeMethod(
+        serialWorker, [serialWorker]() { serialWorker->close(); }, Qt::BlockingQueuedConnection);
+    drain();
+    qInfo("%llu frames, %llu bytes received, %llu frame errors, %llu packets sent",
+          serialWorker->packetsReceived(), serialWorker->bytesReceived(), serialWorker->frameErrors(),
+          serialWorker->packetsWritten());
+    serialThread.quit();
+    serialThread.wait();
+    return exitCode;
+}
@@ -0,0 +1,467 @@
+#include "dissector.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+#include "checksum.h"
+#include "hexdump.h"
+
+using namespace Qt::StringLiterals;
+
+namespace {
+
+struct CodeName {
+    quint8      code;
+    QStringView name;
+};
+
+constexpr CodeName kModbusFunctions[] = {
+    {0x01, u"Read Coils"},
+    {0x02, u"Read Discrete Inputs"},
+    {0x03, u"Read Holding Registers"},
+    {0x04, u"Read Input Registers"},
+    {0x05, u"Write Single Coil"},
+    {0x06, u"Write Single Register"},
+    {0x07, u"Read Exception Status"},
+    {0x08, u"Diagnostics"},
+    {0x0B, u"Get Comm Event Counter"},
+    {0x0C, u"Get Comm Event Log"},
+    {0x0F, u"Write Multiple Coils"},
+    {0x10, u"Write Multiple Registers"},
+    {0x11, u"Report Server ID"},
+    {0x14, u"Read File Record"},
+    {0x15, u"Write File Record"},
+    {0x16, u"Mask Write Register"},
+    {0x17, u"Read/Write Multiple Registers"},
+    {0x18, u"Read FIFO Queue"},
+    {0x2B, u"Encapsulated Interface Transport"},
+};
+
+constexpr CodeName kModbusExceptions[] = {
+    {0x01, u"Illegal Function"},
+    {0x02, u"Illegal Data Address"},
+    {0x03, u"Illegal Data Value"},
+    {0x04, u"Server Device Failure"},
+    {0x05, u"Acknowledge"},
+    {0x06, u"Server Device Busy"},
+    {0x08, u"Memory Parity Error"},
+    {0x0A, u"Gateway Path Unavailable"},
+    {0x0B, u"Gateway Target Device Failed to Respond"},
+};
+
+template <std::size_t N>
+QStringView nameOf(const CodeName (&names)[N], uint code) {
+    for (const CodeName &entry : names) {
+        if (entry.code == code) return entry.name;
+    }
+    return {};
+}
+
+class ModbusRtuDissector : public Dissector {
+   public:
+    ModbusRtuDissector() : Dissector(u"Modbus RTU"_s) {}
+
+    void dissect(QByteArrayView frame, Dissection &out) const override {
+        out.clear();
+        // Address, function code and CRC at the least
+        if (frame.size() < 4 || frame[1] == 0) return;
+
+        const uchar    *d        = reinterpret_cast<const uchar *>(frame.data());
+        const qsizetype end      = frame.size() - 2;  // where the CRC starts
+        const quint16   stored   = quint16(d[end] | (d[end + 1] << 8));
+        const uchar     function = d[1];
+
+        out.add(u"slave", 0, 1, d[0], Field::Decimal);
+        out.add(u"function", 1, 1, function, Field::Hex)->label = nameOf(kModbusFunctions, function & 0x7F);
+        const bool isWellFormed = addBody(d, end, function, out);
+        out.add(u"crc", quint32(end), 2, stored, Field::Hex);
+
+        if (Checksum::crc16Modbus(frame.data(), end) != stored) {
+            out.status = BadCrc;
+        } else {
+            out.status = isWellFormed ? Ok : Malformed;
+        }
+    }
+
+   private:
+    static void addWord(const uchar *d, quint32 offset, QStringView name, Dissection &out) {
+        out.add(name, offset, 2, (d[offset] << 8) | d[offset + 1], Field::Hex);
+    }
+
+    static void addData(quint32 offset, qsizetype end, QStringView name, Field::Format format, Dissection &out) {
+        if (end > offset) out.add(name, offset, quint32(end - offset), 0, format);
+    }
+
+    // The fields between function code and CRC; false when their sizes do not add up
+    static bool addBody(const uchar *d, qsizetype end, uchar function, Dissection &out) {
+        const qsizetype size = end - 2;
+
+        if ((function & 0x80) != 0) {
+            if (size >= 1) out.add(u"exception", 2, 1, d[2], Field::Hex)->label = nameOf(kModbusExceptions, d[2]);
+            return size == 1;
+        }
+
+        switch (function) {
+            case 0x01:
+            case 0x02:
+            case 0x03:
+            case 0x04: {
+                // Requests and responses share the function code: a response is its byte count and
+                // that many bytes, a request address and quantity. Register data comes in pairs.
+                const bool isRegisters = function >= 0x03;
+                const int  count       = (size >= 1) ? d[2] : -1;
+                if (size == 1 + count && (isRegisters == false || count % 2 == 0)) {
+                    out.add(u"byte count", 2, 1, count, Field::Decimal);
+                    if (isRegisters == true) {
+                        addData(3, end, u"registers", Field::Words, out);
+                    } else {
+                        addData(3, end, u"status", Field::Bytes, out);
+                    }
+                    return true;
+                }
+                if (size == 4) {
+                    addWord(d, 2, u"address", out);
+                    out.add(u"quantity", 4, 2, (d[4] << 8) | d[5], Field::Decimal);
+                    return true;
+                }
+                break;
+            }
+            case 0x05:
+            case 0x06:
+                if (size == 4) {
+                    addWord(d, 2, u"address", out);
+                    addWord(d, 4, u"value", out);
+                    return true;
+                }
+                break;
+            case 0x0F:
+            case 0x10:
+                // The response echoes address and quantity, the request adds the values
+                if (size == 4 || (size >= 5 && size == 5 + d[6])) {
+                    addWord(d, 2, u"address", out);
+                    out.add(u"quantity", 4, 2, (d[4] << 8) | d[5], Field::Decimal);
+                    if (size == 4) return true;
+                    out.add(u"byte count", 6, 1, d[6], Field::Decimal);
+                    addData(7, end, u"values", (function == 0x10) ? Field::Words : Field::Bytes, out);
+                    return true;
+                }
+                break;
+            default:
+                // Sizes are not checked for the rarer functions
+                addData(2, end, u"data", Field::Bytes, out);
+                return true;
+        }
+
+        addData(2, end, u"data", Field::Bytes, out);
+        return false;
+    }
+};
+
+// A field layout compiled into one step per field. The size of every field is
+// known when its turn comes: fixed, read from an earlier field, or whatever is
+// left ahead of the fixed size fields behind the one variable field.
+class LayoutDissector : public Dissector {
+   public:
+    struct Step {
+        enum Type : quint8 { Integer, Bytes, Crc16Modbus, Crc16Ccitt };
+
+        QString       name;
+        Type          type        = Integer;
+        Field::Format format      = Field::Decimal;
+        int           size        = 0;   // integers, checksums and bytes of fixed length
+        int           lengthField = -1;  // bytes as long as the value of this earlier field
+        bool          isRest      = false;
+        bool          isSigned    = false;
+        bool          isBigEndian = true;
+        bool          hasExpected = false;
+        qint64        expected    = 0;
+
+        std::vector<std::pair<qint64, QString>> labels;  // sorted by value
+    };
+
+    LayoutDissector(const QString &name, std::vector<Step> &&steps, int restTrailer)
+        : Dissector(name), m_steps(std::move(steps)), m_restTrailer(restTrailer) {}
+
+    void dissect(QByteArrayView frame, Dissection &out) const override {
+        out.clear();
+
+        const uchar    *d         = reinterpret_cast<const uchar *>(frame.data());
+        qsizetype       pos       = 0;
+        bool            isCrcGood = true;
+        const qsizetype size      = frame.size();
+
+        for (const Step &step : m_steps) {
+            qsizetype length = step.size;
+            if (step.lengthField >= 0) length = out.fields[step.lengthField].value;
+            if (step.isRest == true) length = size - pos - m_restTrailer;
+            if (length < 0 || length > size - pos) {
+                out.status = Malformed;
+                return;
+            }
+
+            Field *field = out.add(step.name, quint32(pos), quint32(length), 0, step.format);
+            if (step.type != Step::Bytes) {
+                field->value = readInteger(d + pos, int(length), step.isBigEndian, step.isSigned);
+                field->label = labelOf(step, field->value);
+                if (step.hasExpected == true && field->value != step.expected) {
+                    out.clear();
+                    return;
+                }
+                if (step.type == Step::Crc16Modbus) {
+                    isCrcGood = isCrcGood && Checksum::crc16Modbus(frame.data(), pos) == quint16(field->value);
+                } else if (step.type == Step::Crc16Ccitt) {
+                    isCrcGood = isCrcGood && Checksum::crc16Ccitt(frame.data(), pos) == quint16(field->value);
+                }
+            }
+            pos += length;
+        }
+
+        if (pos != size) {
+            out.status = Malformed;
+        } else {
+            out.status = isCrcGood ? Ok : BadCrc;
+        }
+    }
+
+   private:
+    static qint64 readInteger(const uchar *d, int size, bool isBigEndian, bool isSigned) {
+        quint64 value = 0;
+        for (int i = 0; i < size; i++) value |= quint64(d[isBigEndian ? i : size - 1 - i]) << (8 * (size - 1 - i));
+        if (isSigned == true && size < 8 && (value >> (8 * size - 1)) != 0) value |= ~quint64(0) << (8 * size);
+        return qint64(value);
+    }
+
+    static QStringView labelOf(const Step &step, qint64 value) {
+        const auto it = std::lower_bound(step.labels.begin(), step.labels.end(), value,
+                                         [](const auto &label, qint64 v) { return label.first < v; });
+        return (it != step.labels.end() && it->first == value) ? QStringView(it->second) : QStringView();
+    }
+
+    std::vector<Step> m_steps;
+    int               m_restTrailer = 0;  // bytes of the fixed size fields after the variable one
+};
+
+// Numbers may also be written as strings, "0xAA" for one
+bool toInteger(const QJsonValue &json, qint64 &value) {
+    bool isNumber = json.isDouble();
+    if (isNumber == true) {
+        value = json.toInteger();
+    } else if (json.isString() == true) {
+        value = json.toString().toLongLong(&isNumber, 0);
+    }
+    return isNumber;
+}
+
+bool parseStep(const QJsonObject &json, bool isBigEndian, const std::vector<LayoutDissector::Step> &steps,
+               LayoutDissector::Step &step, QString &error) {
+    using Step = LayoutDissector::Step;
+
+    struct TypeName {
+        QStringView name;
+        Step::Type  type;
+        int         size;
+        bool        isSigned;
+    };
+    static constexpr TypeName kTypes[] = {
+        {u"u8", Step::Integer, 1, false},         {u"u16", Step::Integer, 2, false},
+        {u"u32", Step::Integer, 4, false},        {u"i8", Step::Integer, 1, true},
+        {u"i16", Step::Integer, 2, true},         {u"i32", Step::Integer, 4, true},
+        {u"bytes", Step::Bytes, 0, false},        {u"crc16-modbus", Step::Crc16Modbus, 2, false},
+        {u"crc16-ccitt", Step::Crc16Ccitt, 2, false},
+    };
+
+    step.name = json.value("name"_L1).toString();
+    if (step.name.isEmpty() == true) {
+        error = QObject::tr("the field has no name");
+        return false;
+    }
+
+    const QString type   = json.value("type"_L1).toString();
+    const auto    typeIt = std::find_if(std::begin(kTypes), std::end(kTypes),
+                                        [&type](const TypeName &entry) { return entry.name == type; });
+    if (typeIt == std::end(kTypes)) {
+        error = QObject::tr("unknown type \"%1\"").arg(type);
+        return false;
+    }
+    step.type     = typeIt->type;
+    step.size     = typeIt->size;
+    step.isSigned = typeIt->isSigned;
+
+    const QString byteOrder = json.value("byteOrder"_L1).toString();
+    if (byteOrder.isEmpty() == false && byteOrder != "big"_L1 && byteOrder != "little"_L1) {
+        error = QObject::tr("byte order has to be big or little");
+        return false;
+    }
+    step.isBigEndian = byteOrder.isEmpty() ? isBigEndian : byteOrder == "big"_L1;
+
+    const QString format = json.value("format"_L1).toString();
+    if (step.type == Step::Bytes) {
+        step.format = (format == "words"_L1) ? Dissector::Field::Words : Dissector::Field::Bytes;
+    } else if (format.isEmpty() == true) {
+        step.format = (step.type == Step::Integer) ? Dissector::Field::Decimal : Dissector::Field::Hex;
+    } else {
+        step.format = (format == "hex"_L1) ? Dissector::Field::Hex : Dissector::Field::Decimal;
+    }
+
+    if (step.type == Step::Bytes) {
+        const QJsonValue length = json.value("length"_L1);
+        qint64           fixed  = 0;
+        if (length.isUndefined() == true) {
+            step.isRest = true;
+        } else if (length.isString() == true && toInteger(length, fixed) == false) {
+            const QString lengthName = length.toString();
+            const auto    fieldIt    = std::find_if(steps.begin(), steps.end(), [&lengthName](const Step &s) {
+                return s.name == lengthName && s.type == Step::Integer;
+            });
+            if (fieldIt == steps.end()) {
+                error = QObject::tr("no integer field \"%1\" ahead of it").arg(lengthName);
+                return false;
+            }
+            step.lengthField = int(fieldIt - steps.begin());
+        } else if (toInteger(length, fixed) == true && fixed >= 0 && fixed <= INT_MAX) {
+            step.size = int(fixed);
+        } else {
+            error = QObject::tr("invalid length");
+            return false;
+        }
+        return true;
+    }
+
+    const QJsonValue expected = json.value("expect"_L1);
+    step.hasExpected          = (expected.isUndefined() == false);
+    if (step.hasExpected == true && toInteger(expected, step.expected) == false) {
+        error = QObject::tr("invalid expected value");
+        return false;
+    }
+
+    const QJsonObject values = json.value("values"_L1).toObject();
+    for (auto it = values.begin(); it != values.end(); ++it) {
+        qint64 value = 0;
+        if (toInteger(QJsonValue(it.key()), value) == false) {
+            error = QObject::tr("invalid value \"%1\"").arg(it.key());
+            return false;
+        }
+        step.labels.emplace_back(value, it.value().toString());
+    }
+    std::sort(step.labels.begin(), step.labels.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+    return true;
+}
+
+}  // namespace
+
+std::unique_ptr<Dissector> Dissector::modbusRtu() {
+    return std::make_unique<ModbusRtuDissector>();
+}
+
+std::unique_ptr<Dissector> Dissector::fromLayout(const QByteArray &json, QString *errorString) {
+    using Step      = LayoutDissector::Step;
+    const auto fail = [errorString](const QString &error) {
+        if (errorString != nullptr) *errorString = error;
+        return nullptr;
+    };
+
+    QJsonParseError     parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(json, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        return fail(QObject::tr("offset %1: %2").arg(parseError.offset).arg(parseError.errorString()));
+    }
+    if (document.isObject() == false) return fail(QObject::tr("the layout is not a JSON object"));
+
+    const QJsonObject layout    = document.object();
+    const QString     name      = layout.value("name"_L1).toString(u"Layout"_s);
+    const QString     byteOrder = layout.value("byteOrder"_L1).toString(u"big"_s);
+    const QJsonArray  fields    = layout.value("fields"_L1).toArray();
+    if (byteOrder != "big"_L1 && byteOrder != "little"_L1) {
+        return fail(QObject::tr("byte order has to be big or little"));
+    }
+    if (fields.isEmpty() == true) return fail(QObject::tr("the layout has no fields"));
+    if (fields.size() > kMaxFields) return fail(QObject::tr("the layout has more than %1 fields").arg(kMaxFields));
+
+    std::vector<Step> steps;
+    int               rest        = -1;
+    int               restTrailer = 0;
+    for (qsizetype i = 0; i < fields.size(); i++) {
+        Step    step;
+        QString error;
+        if (parseStep(fields[i].toObject(), byteOrder == "big"_L1, steps, step, error) == false) {
+            return fail(QObject::tr("field %1: %2").arg(i + 1).arg(error));
+        }
+        if (rest >= 0) {
+            // Whatever follows the variable field has to be of known size to find where it ends
+            if (step.isRest == true || step.lengthField >= 0) {
+                return fail(QObject::tr("field %1: only fixed size fields can follow \"%2\"")
+                                .arg(i + 1)
+                                .arg(steps[rest].name));
+            }
+            restTrailer += step.size;
+        }
+        if (step.isRest == true) rest = int(i);
+        steps.push_back(std::move(step));
+    }
+
+    return std::make_unique<LayoutDissector>(name, std::move(steps), restTrailer);
+}
+
+std::unique_ptr<Dissector> Dissector::load(const QString &fileName, QString *errorString) {
+    QFile file(fileName);
+    if (file.open(QIODevice::ReadOnly) == false) {
+        if (errorString != nullptr) *errorString = file.errorString();
+        return nullptr;
+    }
+    return fromLayout(file.readAll(), errorString);
+}
+
+QString Dissector::format(const Dissection &dissection, QByteArrayView frame) const {
+    static constexpr char kHexDigits[] = "0123456789ABCDEF";
+
+    QString text = m_name + u':';
+    for (int i = 0; i < dissection.fieldCount; i++) {
+        const Field &field = dissection.fields[i];
+        text += (i == 0) ? u" "_s : u", "_s;
+        text += field.name;
+        if (field.offset + field.size > quint64(frame.size())) continue;
+
+        const QByteArrayView bytes = frame.sliced(field.offset, field.size);
+        switch (field.format) {
+            case Field::Decimal:
+                text += u' ';
+                text += QString::number(field.value);
+                break;
+            case Field::Hex: {
+                // Signed fields are shown as the bytes they were read from
+                const quint64 mask   = (field.size >= 8) ? ~quint64(0) : (quint64(1) << (8 * field.size)) - 1;
+                const QString digits = QString::number(quint64(field.value) & mask, 16).toUpper();
+                text += u" 0x"_s;
+                text += digits.rightJustified(qsizetype(field.size) * 2, u'0');
+                break;
+            }
+            case Field::Bytes:
+                if (bytes.isEmpty() == true) break;
+                text += u' ';
+                text += QString::fromLatin1(HexDump::toSpacedHex(bytes));
+                break;
+            case Field::Words:
+                for (qsizetype j = 0; j < bytes.size(); j++) {
+                    if (j % 2 == 0) text += u' ';
+                    text += QLatin1Char(kHexDigits[uchar(bytes[j]) >> 4]);
+                    text += QLatin1Char(kHexDigits[uchar(bytes[j]) & 0x0F]);
+                }
+                break;
+        }
+        if (field.label.isEmpty() == false) {
+            text += u' ';
+            text += field.label;
+        }
+    }
+
+    if (dissection.status == BadCrc) text += QObject::tr(" (bad CRC)");
+    if (dissection.status == Malformed) text += QObject::tr(" (malformed)");
+    return text;
+}
@@ -0,0 +1,98 @@
+#ifndef DISSECTOR_H
+#define DISSECTOR_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QStringView>
+#include <array>
+#include <memory>
+
+// Decodes complete frames, as they come out of the framer, into named fields.
+// dissect() reads the frame in place and fills a Dissection of fixed size, with
+// names and value labels viewing strings owned by the dissector, so decoding
+// allocates nothing and a dissector can be shared by any number of ports. Only
+// format() builds text. Modbus RTU is built in; other protocols are described
+// in a field layout file (see fromLayout()), compiled once into a table.
+class Dissector {
+   public:
+    enum Status : quint8 {
+        NoMatch,    // not a frame of this protocol
+        Ok,         // decoded, checksum right
+        BadCrc,     // decoded, checksum wrong
+        Malformed,  // the frame is shorter or longer than its fields say
+    };
+
+    struct Field {
+        enum Format : quint8 {
+            Decimal,
+            Hex,    // zero padded to the field size
+            Bytes,  // spaced hex of the field's bytes
+            Words,  // big endian 16 bit values, spaced hex
+        };
+
+        QStringView name;
+        QStringView label;  // what the value stands for, empty when unknown
+        quint32     offset = 0;
+        quint32     size   = 0;
+        qint64      value  = 0;  // integer fields only
+        Format      format = Decimal;
+    };
+
+    static constexpr int kMaxFields = 32;
+
+    struct Dissection {
+        Status                        status     = NoMatch;
+        int                           fieldCount = 0;
+        std::array<Field, kMaxFields> fields;
+
+        void clear() {
+            status     = NoMatch;
+            fieldCount = 0;
+        }
+        // Fields past kMaxFields are dropped
+        Field *add(QStringView name, quint32 offset, quint32 size, qint64 value, Field::Format format) {
+            if (fieldCount == kMaxFields) return nullptr;
+            fields[fieldCount] = {name, {}, offset, size, value, format};
+            return &fields[fieldCount++];
+        }
+    };
+
+    virtual ~Dissector() = default;
+
+    static std::unique_ptr<Dissector> modbusRtu();
+
+    // A layout is a JSON object:
+    //
+    //   { "name": "Sensor", "byteOrder": "big",
+    //     "fields": [
+    //       { "name": "sync",    "type": "u8", "format": "hex", "expect": 170 },
+    //       { "name": "command", "type": "u8", "values": { "1": "Ping", "2": "Read" } },
+    //       { "name": "length",  "type": "u16" },
+    //       { "name": "payload", "type": "bytes", "length": "length" },
+    //       { "name": "crc",     "type": "crc16-modbus" } ] }
+    //
+    // Integer types are u8 u16 u32 i8 i16 i32; "expect" makes frames with any
+    // other value a NoMatch. A bytes field is as long as a fixed "length", the
+    // value of an earlier integer field named by "length", or without one all
+    // that is left ahead of the fixed size fields after it; only one field may
+    // go without. crc16-modbus and crc16-ccitt are checked over everything in
+    // front of them, in the layout's byte order.
+    static std::unique_ptr<Dissector> fromLayout(const QByteArray &json, QString *errorString = nullptr);
+    static std::unique_ptr<Dissector> load(const QString &fileName, QString *errorString = nullptr);
+
+    const QString &name() const { return m_name; }
+
+    // Reentrant; the dissection views into the dissector, not into the frame
+    virtual void dissect(QByteArrayView frame, Dissection &out) const = 0;
+
+    // "Modbus RTU: slave 1, function 0x03 Read Holding Registers, ..., crc 0x85DB ok"
+    QString format(const Dissection &dissection, QByteArrayView frame) const;
+
+   protected:
+    explicit Dissector(const QString &name) : m_name(name) {}
+
+    QString m_name;
+};
+
+#endif  // DISSECTOR_H
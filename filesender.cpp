@@ -0,0 +1,127 @@
+#include "filesender.h"
+
+#include "serialworker.h"
+#include "sessionformat.h"
+
+using SessionFormat::monotonicNs;
+
+// Without a chunk delay the port is kept this many chunks ahead of the driver
+static constexpr qint64 kChunksAhead = 4;
+
+// Progress is reported at most this often
+static constexpr qint64 kProgressInterval_ns = 100 * 1000 * 1000;
+
+FileSender::FileSender(SerialWorker *worker) : m_worker(worker), m_delayTimer(new QTimer(this)) {
+    m_delayTimer->setSingleShot(true);
+    m_delayTimer->setTimerType(Qt::PreciseTimer);
+
+    connect(m_delayTimer, &QTimer::timeout, this, &FileSender::writeChunk);
+    connect(m_worker, &SerialWorker::bytesAccepted, this, &FileSender::fill);
+}
+
+bool FileSender::start(const Options &options, QString *errorString) {
+    stop();
+
+    m_file.setFileName(options.fileName);
+    if (m_file.open(QIODevice::ReadOnly) == false) {
+        if (errorString != nullptr) *errorString = m_file.errorString();
+        return false;
+    }
+    m_size = m_file.size();
+    m_data = (m_size > 0) ? m_file.map(0, m_size) : nullptr;
+    if (m_data == nullptr) {
+        if (errorString != nullptr) *errorString = (m_size > 0) ? m_file.errorString() : tr("The file is empty");
+        m_file.close();
+        return false;
+    }
+
+    m_options           = options;
+    m_options.chunkSize = qMax<qsizetype>(1, m_options.chunkSize);
+    m_offset            = 0;
+    m_startNs           = monotonicNs();
+    m_lastProgressNs    = m_startNs;
+    m_isRunning         = true;
+    reportProgress();
+
+    // Later chunks follow from bytesWritten
+    writeChunk();
+    return true;
+}
+
+void FileSender::stop() {
+    if (m_isRunning == true) finish(tr("stopped"));
+}
+
+void FileSender::fill() {
+    if (m_isRunning == false) return;
+
+    if (m_offset == m_size) {
+        if (m_worker->bytesToWrite() == 0) finish(QString());
+        return;
+    }
+
+    if (m_options.chunkDelay_ms > 0) {
+        // One chunk at a time, the pause starts once it has left
+        if (m_worker->bytesToWrite() == 0 && m_delayTimer->isActive() == false) {
+            m_delayTimer->start(m_options.chunkDelay_ms);
+        }
+        return;
+    }
+
+    const quint64 ahead = quint64(m_options.chunkSize * kChunksAhead);
+    while (m_isRunning == true && m_offset < m_size && m_worker->bytesToWrite() < ahead) writeChunk();
+}
+
+void FileSender::writeChunk() {
+    if (m_isRunning == false) return;
+    if (m_worker->isOpen() == false) {
+        finish(tr("the port was closed"));
+        return;
+    }
+
+    // A view into the mapping, the port copies it into its write buffer
+    const qint64 length = qMin<qint64>(m_options.chunkSize, m_size - m_offset);
+    m_worker->write(QByteArray::fromRawData(reinterpret_cast<const char *>(m_data + m_offset), length));
+    m_offset += length;
+
+    const qint64 nowNs = monotonicNs();
+    if (nowNs - m_lastProgressNs >= kProgressInterval_ns) {
+        m_lastProgressNs = nowNs;
+        reportProgress();
+    }
+}
+
+void FileSender::reportProgress() {
+    // Bytes still queued in the port count as not sent yet
+    emit progress(qMax<qint64>(0, m_offset - qint64(m_worker->bytesToWrite())), m_size);
+}
+
+void FileSender::finish(const QString &reason) {
+    m_isRunning = false;
+    m_delayTimer->stop();
+
+    const qint64 sent     = qMax<qint64>(0, m_offset - qint64(m_worker->bytesToWrite()));
+    const double seconds  = qMax(1e-9, double(monotonicNs() - m_startNs) / 1e9);
+    const double rate     = double(sent) / seconds;
+    const double lineRate = m_worker->settings().bytesPerSecond();
+
+    QString report = tr("%1 of %2 bytes in %3 s, %4 KB/s")
+                         .arg(sent)
+                         .arg(m_size)
+                         .arg(seconds, 0, 'f', 3)
+                         .arg(rate / 1024.0, 0, 'f', 1);
+    if (lineRate > 0) {
+        report += tr(", %1 % of the %2 KB/s line limit")
+                      .arg(rate * 100.0 / lineRate, 0, 'f', 1)
+                      .arg(lineRate / 1024.0, 0, 'f', 1);
+    }
+    if (reason.isEmpty() == false) report = tr("%1 after %2").arg(reason, report);
+
+    // The port has its own copy of whatever is still queued, the mapping can go
+    m_file.unmap(m_data);
+    m_file.close();
+    m_data = nullptr;
+
+    emit progress(sent, m_size);
+    emit finished(report);
+}
@@ -0,0 +1,58 @@
+#ifndef FILESENDER_H
+#define FILESENDER_H
+
+#include <QFile>
+#include <QObject>
+#include <QTimer>
+
+class SerialWorker;
+
+// Streams a file through one serial worker without reading it into memory. The
+// file is mapped and every chunk written is a view into the mapping, so the
+// only copy is the one the port makes into its write buffer. A new chunk goes
+// out only once the driver has taken the earlier ones off that buffer, which
+// holds the sender back whenever hardware or software flow control holds back
+// the port. Lives in the worker's thread, like the SequenceRunner.
+class FileSender : public QObject {
+    Q_OBJECT
+
+   public:
+    struct Options {
+        QString   fileName;
+        qsizetype chunkSize     = 4096;
+        int       chunkDelay_ms = 0;  // pause after each chunk has left the port, 0 keeps the port busy
+    };
+
+    explicit FileSender(SerialWorker *worker);
+
+   public slots:
+    // Called in the worker thread
+    bool start(const Options &options, QString *errorString = nullptr);
+    void stop();
+
+   signals:
+    void progress(qint64 sent, qint64 total);
+    void finished(const QString &report);
+
+   private slots:
+    void fill();
+    void writeChunk();
+
+   private:
+    void reportProgress();
+    void finish(const QString &reason);
+
+    SerialWorker *m_worker;
+    QTimer       *m_delayTimer = nullptr;
+
+    Options m_options;
+    QFile   m_file;
+    uchar  *m_data           = nullptr;  // the mapped file
+    qint64  m_size           = 0;
+    qint64  m_offset         = 0;  // handed to the port so far
+    qint64  m_startNs        = 0;
+    qint64  m_lastProgressNs = 0;
+    bool    m_isRunning      = false;
+};
+
+#endif  // FILESENDER_H
@@ -0,0 +1,419 @@
+#include "framer.h"
+
+#include <cstring>
+
+#include "checksum.h"
+
+namespace {
+
+// Frames are collected here when they span reads or have to be decoded
+class FrameBuffer {
+   public:
+    bool isEmpty() const { return m_data.isEmpty(); }
+    bool isDiscarding() const { return m_isDiscarding; }
+
+    // Returns false when the frame outgrew the limit, the rest of it is then dropped
+    bool append(QByteArrayView data, qsizetype maxFrameSize) {
+        if (m_isDiscarding == true) return true;
+        if (m_data.size() + data.size() > maxFrameSize) {
+            discard();
+            return false;
+        }
+        m_data.append(data);
+        return true;
+    }
+
+    QByteArrayView view() const { return m_data; }
+
+    void clear() {
+        m_data.resize(0);  // keeps the capacity for the next frame
+        m_isDiscarding = false;
+    }
+
+    void discard() {
+        m_data.resize(0);
+        m_isDiscarding = true;
+    }
+
+   private:
+    QByteArray m_data;
+    bool       m_isDiscarding = false;
+};
+
+class DelimiterFramer : public Framer {
+   public:
+    explicit DelimiterFramer(const Options &options) : Framer(options) {
+        if (m_options.delimiter.isEmpty() == true) m_options.delimiter = "\n";
+    }
+
+    void feed(QByteArrayView chunk, const Sink &sink) override {
+        const QByteArrayView delimiter(m_options.delimiter);
+        qsizetype            begin = 0;
+
+        if (m_frame.isEmpty() == false || m_frame.isDiscarding() == true) {
+            begin = completePending(chunk, sink);
+            if (begin < 0) return;
+        }
+
+        // Whole frames inside the chunk are handed out without copying
+        qsizetype end = chunk.indexOf(delimiter, begin);
+        while (end >= 0) {
+            if (end - begin > m_options.maxFrameSize) {
+                m_stats.errors++;
+            } else {
+                deliver(chunk.sliced(begin, end - begin), sink);
+            }
+            begin = end + delimiter.size();
+            end   = chunk.indexOf(delimiter, begin);
+        }
+        if (begin < chunk.size()) append(chunk.sliced(begin));
+    }
+
+    void reset() override {
+        m_frame.clear();
+        m_droppedTail.clear();
+    }
+
+   private:
+    // Finishes the frame carried over from earlier reads, returns where the
+    // rest of the chunk starts or -1 when the chunk did not complete it
+    qsizetype completePending(QByteArrayView chunk, const Sink &sink) {
+        const QByteArrayView delimiter(m_options.delimiter);
+        const QByteArrayView pending = m_frame.isDiscarding() ? QByteArrayView(m_droppedTail) : m_frame.view();
+
+        // The delimiter may straddle the end of the pending bytes and the start of the chunk
+        const qsizetype tail = qMin(pending.size(), delimiter.size() - 1);
+        if (tail > 0) {
+            QByteArray probe(pending.last(tail).toByteArray());
+            probe.append(chunk.first(qMin(chunk.size(), delimiter.size() - 1)));
+            const qsizetype index = QByteArrayView(probe).indexOf(delimiter);
+            if (index >= 0 && index < tail) {
+                finish(pending.first(pending.size() - tail + index), sink);
+                return index + delimiter.size() - tail;
+            }
+        }
+
+        const qsizetype end = chunk.indexOf(delimiter);
+        if (end < 0) {
+            append(chunk);
+            return -1;
+        }
+        append(chunk.first(end));
+        finish(m_frame.view(), sink);
+        return end + delimiter.size();
+    }
+
+    void append(QByteArrayView data) {
+        // The start of the delimiter may be among the bytes held, it does not count against the frame
+        const qsizetype keep = m_options.delimiter.size() - 1;
+        if (m_frame.isDiscarding() == false) {
+            const QByteArrayView held = m_frame.view();
+            if (held.size() + data.size() <= m_options.maxFrameSize + keep) {
+                m_frame.append(data, m_options.maxFrameSize + keep);
+                return;
+            }
+            m_stats.errors++;
+            m_droppedTail = held.last(qMin(keep, held.size())).toByteArray();
+            m_frame.discard();
+        }
+
+        // Only the bytes the delimiter ending the dropped frame may start among are kept
+        m_droppedTail.append(data.last(qMin(keep, data.size())));
+        if (m_droppedTail.size() > keep) m_droppedTail.remove(0, m_droppedTail.size() - keep);
+    }
+
+    void finish(QByteArrayView frame, const Sink &sink) {
+        if (m_frame.isDiscarding() == false) {
+            if (frame.size() > m_options.maxFrameSize) {
+                m_stats.errors++;
+            } else {
+                deliver(frame, sink);
+            }
+        }
+        m_frame.clear();
+        m_droppedTail.clear();
+    }
+
+    FrameBuffer m_frame;
+    QByteArray  m_droppedTail;  // while discarding
+};
+
+class SlipFramer : public Framer {
+   public:
+    explicit SlipFramer(const Options &options) : Framer(options) {}
+
+    static QByteArray encode(QByteArrayView payload) {
+        // Starting with an END as well ends whatever line noise came before
+        QByteArray out;
+        out.reserve(payload.size() + payload.size() / 16 + 2);
+        out.append(char(kEnd));
+        for (const char c : payload) {
+            if (uchar(c) == kEnd || uchar(c) == kEsc) {
+                out.append(char(kEsc));
+                out.append(char(uchar(c) == kEnd ? kEscEnd : kEscEsc));
+            } else {
+                out.append(c);
+            }
+        }
+        out.append(char(kEnd));
+        return out;
+    }
+
+    void feed(QByteArrayView chunk, const Sink &sink) override {
+        const char *p   = chunk.data();
+        const char *end = p + chunk.size();
+
+        while (p < end) {
+            if (m_isEscaped == true) {
+                unescape(uchar(*p++));
+                continue;
+            }
+
+            const char *run = p;
+            while (p < end && uchar(*p) != kEnd && uchar(*p) != kEsc) p++;
+            if (p == end) {
+                append(QByteArrayView(run, p - run));
+                break;
+            }
+
+            if (uchar(*p) == kEsc) {
+                append(QByteArrayView(run, p - run));
+                m_isEscaped = true;
+            } else if (m_frame.isEmpty() == true && m_frame.isDiscarding() == false) {
+                // No escapes and nothing carried over, the frame is a view into the chunk
+                if (p - run > m_options.maxFrameSize) {
+                    m_stats.errors++;
+                } else if (p > run) {
+                    deliver(QByteArrayView(run, p - run), sink);
+                }
+            } else {
+                append(QByteArrayView(run, p - run));
+                if (m_frame.isDiscarding() == false && m_frame.isEmpty() == false) deliver(m_frame.view(), sink);
+                m_frame.clear();
+            }
+            p++;
+        }
+    }
+
+    void reset() override {
+        m_frame.clear();
+        m_isEscaped = false;
+    }
+
+   private:
+    static constexpr uchar kEnd    = 0xC0;
+    static constexpr uchar kEsc    = 0xDB;
+    static constexpr uchar kEscEnd = 0xDC;
+    static constexpr uchar kEscEsc = 0xDD;
+
+    void unescape(uchar c) {
+        m_isEscaped = false;
+        if (c == kEscEnd || c == kEscEsc) {
+            const char decoded = char(c == kEscEnd ? kEnd : kEsc);
+            append(QByteArrayView(&decoded, 1));
+            return;
+        }
+
+        m_stats.errors++;
+        if (c == kEnd) {
+            // The frame is broken but the END still starts the next one
+            m_frame.clear();
+        } else {
+            m_frame.discard();
+        }
+    }
+
+    void append(QByteArrayView data) {
+        if (m_frame.append(data, m_options.maxFrameSize) == false) m_stats.errors++;
+    }
+
+    FrameBuffer m_frame;
+    bool        m_isEscaped = false;
+};
+
+class CobsFramer : public Framer {
+   public:
+    explicit CobsFramer(const Options &options) : Framer(options) {}
+
+    static QByteArray encode(QByteArrayView payload) {
+        QByteArray out;
+        out.reserve(payload.size() + payload.size() / 254 + 2);
+        qsizetype codeIndex = 0;
+        out.append('\x01');
+        for (const char c : payload) {
+            if (c != 0) {
+                out.append(c);
+                out[codeIndex] = char(out[codeIndex] + 1);
+                if (uchar(out[codeIndex]) != 0xFF) continue;
+            }
+            // A zero byte, or a full block, ends the block
+            codeIndex = out.size();
+            out.append('\x01');
+        }
+        out.append('\0');
+        return out;
+    }
+
+    void feed(QByteArrayView chunk, const Sink &sink) override {
+        const char *p   = chunk.data();
+        const char *end = p + chunk.size();
+
+        while (p < end) {
+            if (*p == 0) {
+                finish(sink);
+                p++;
+            } else if (m_remaining == 0) {
+                // Every block but a full one stands for its data plus a zero byte, except at the end
+                if (m_code != 0 && m_code != 0xFF) append(QByteArrayView("\0", 1));
+                m_code      = uchar(*p++);
+                m_remaining = m_code - 1;
+            } else {
+                const qsizetype available = qMin<qsizetype>(m_remaining, end - p);
+                const void     *zero      = std::memchr(p, 0, std::size_t(available));
+                const qsizetype run       = zero ? static_cast<const char *>(zero) - p : available;
+                append(QByteArrayView(p, run));
+                p += run;
+                m_remaining -= int(run);
+            }
+        }
+    }
+
+    void reset() override {
+        m_frame.clear();
+        m_code      = 0;
+        m_remaining = 0;
+    }
+
+   private:
+    void finish(const Sink &sink) {
+        // Back to back zeros are idle line, not empty frames
+        if (m_code != 0 && m_frame.isDiscarding() == false) {
+            if (m_remaining != 0) {
+                m_stats.errors++;
+            } else {
+                deliver(m_frame.view(), sink);
+            }
+        }
+        reset();
+    }
+
+    void append(QByteArrayView data) {
+        if (m_frame.append(data, m_options.maxFrameSize) == false) m_stats.errors++;
+    }
+
+    FrameBuffer m_frame;
+    int         m_code      = 0;
+    int         m_remaining = 0;
+};
+
+class LengthPrefixCrcFramer : public Framer {
+   public:
+    explicit LengthPrefixCrcFramer(const Options &options) : Framer(options) {}
+
+    static QByteArray encode(QByteArrayView payload) {
+        if (payload.size() > 0xFFFF) return QByteArray();
+
+        QByteArray out;
+        out.reserve(payload.size() + kOverhead);
+        out.append(char(payload.size() >> 8));
+        out.append(char(payload.size() & 0xFF));
+        out.append(payload);
+        const quint16 crc = Checksum::crc16Ccitt(out.constData(), out.size());
+        out.append(char(crc >> 8));
+        out.append(char(crc & 0xFF));
+        return out;
+    }
+
+    void feed(QByteArrayView chunk, const Sink &sink) override {
+        // Parse straight out of the chunk while nothing is carried over
+        if (m_buffer.isEmpty() == true) {
+            const qsizetype consumed = parse(chunk, sink);
+            if (consumed < chunk.size()) m_buffer.append(chunk.sliced(consumed));
+            return;
+        }
+        m_buffer.append(chunk);
+        m_buffer.remove(0, parse(m_buffer, sink));
+    }
+
+    void reset() override {
+        m_buffer.clear();
+        m_isResyncing = false;
+    }
+
+   private:
+    static constexpr qsizetype kOverhead = 4;
+
+    qsizetype parse(QByteArrayView data, const Sink &sink) {
+        const char *d   = data.data();
+        qsizetype   pos = 0;
+
+        while (data.size() - pos >= 2) {
+            const qsizetype length = (qsizetype(uchar(d[pos])) << 8) | uchar(d[pos + 1]);
+            if (length > m_options.maxFrameSize) {
+                resync();
+                pos++;
+                continue;
+            }
+            if (data.size() - pos < length + kOverhead) break;
+
+            const quint16 stored = quint16((uchar(d[pos + 2 + length]) << 8) | uchar(d[pos + 3 + length]));
+            if (Checksum::crc16Ccitt(d + pos, length + 2) != stored) {
+                // No sync marker in this framing, so retry one byte further on
+                resync();
+                pos++;
+                continue;
+            }
+
+            m_isResyncing = false;
+            deliver(data.sliced(pos + 2, length), sink);
+            pos += length + kOverhead;
+        }
+        return pos;
+    }
+
+    void resync() {
+        // One error per lost frame rather than one per skipped byte
+        if (m_isResyncing == false) m_stats.errors++;
+        m_isResyncing = true;
+    }
+
+    QByteArray m_buffer;
+    bool       m_isResyncing = false;
+};
+
+}  // namespace
+
+std::unique_ptr<Framer> Framer::create(const Options &options) {
+    switch (options.type) {
+        case Delimiter:
+            return std::make_unique<DelimiterFramer>(options);
+        case Slip:
+            return std::make_unique<SlipFramer>(options);
+        case Cobs:
+            return std::make_unique<CobsFramer>(options);
+        case LengthPrefixCrc:
+            return std::make_unique<LengthPrefixCrcFramer>(options);
+        case PacketGap:
+        default:
+            return nullptr;
+    }
+}
+
+QByteArray Framer::encode(const Options &options, QByteArrayView payload) {
+    switch (options.type) {
+        case Delimiter: {
+            QByteArray out = payload.toByteArray();
+            out.append(options.delimiter.isEmpty() ? QByteArray("\n") : options.delimiter);
+            return out;
+        }
+        case Slip:
+            return SlipFramer::encode(payload);
+        case Cobs:
+            return CobsFramer::encode(payload);
+        case LengthPrefixCrc:
+            return LengthPrefixCrcFramer::encode(payload);
+        case PacketGap:
+        default:
+            return QByteArray();
+    }
+}
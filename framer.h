@@ -0,0 +1,65 @@
+#ifndef FRAMER_H
+#define FRAMER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <functional>
+#include <memory>
+
+// Incremental receive framing. A framer is fed the chunks exactly as they come
+// out of the serial port and calls the sink once per complete frame, so a frame
+// may be split across any number of reads. A frame that lies within a single
+// chunk and needs no decoding is passed on as a view into that chunk.
+class Framer {
+   public:
+    enum Type {
+        PacketGap,        // time based, done by the worker: an idle line ends the frame
+        Delimiter,        // frames end with a delimiter, which is stripped
+        Slip,             // RFC 1055
+        Cobs,             // consistent overhead byte stuffing, frames end with 0x00
+        LengthPrefixCrc,  // u16 length, payload, CRC-16/CCITT-FALSE over both, big endian
+    };
+
+    struct Options {
+        Type       type         = PacketGap;
+        QByteArray delimiter    = "\n";
+        qsizetype  maxFrameSize = 64 * 1024;
+    };
+
+    struct Stats {
+        quint64 frames = 0;
+        quint64 bytes  = 0;  // payload bytes of the complete frames
+        quint64 errors = 0;  // bad CRC, invalid escape or encoding, oversized frame
+    };
+
+    using Sink = std::function<void(QByteArrayView frame)>;
+
+    virtual ~Framer() = default;
+
+    // nullptr for PacketGap
+    static std::unique_ptr<Framer> create(const Options &options);
+    // The payload framed the way the framer of the same options takes it apart,
+    // empty for PacketGap and, with LengthPrefixCrc, for more than 65535 bytes
+    static QByteArray encode(const Options &options, QByteArrayView payload);
+
+    // The frame passed to the sink is only valid for the duration of the call
+    virtual void feed(QByteArrayView chunk, const Sink &sink) = 0;
+    // Drops a partially received frame
+    virtual void reset() = 0;
+
+    const Stats &stats() const { return m_stats; }
+
+   protected:
+    explicit Framer(const Options &options) : m_options(options) {}
+
+    void deliver(QByteArrayView frame, const Sink &sink) {
+        m_stats.frames++;
+        m_stats.bytes += quint64(frame.size());
+        sink(frame);
+    }
+
+    Options m_options;
+    Stats   m_stats;
+};
+
+#endif  // FRAMER_H
@@ -0,0 +1,333 @@
+#include "hexdump.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HEXDUMP_HAVE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+using namespace Qt::StringLiterals;
+
+namespace {
+
+constexpr char kHexDigits[] = "0123456789ABCDEF";
+
+struct HexPairTable {
+    char pairs[256][2];
+
+    constexpr HexPairTable() : pairs() {
+        for (int value = 0; value < 256; value++) {
+            pairs[value][0] = kHexDigits[value >> 4];
+            pairs[value][1] = kHexDigits[value & 0x0F];
+        }
+    }
+};
+
+constexpr HexPairTable kHexPairs;
+
+// Value of an ASCII hex digit, -1 for anything else
+struct HexValueTable {
+    signed char values[128];
+
+    constexpr HexValueTable() : values() {
+        for (int c = 0; c < 128; c++) values[c] = -1;
+        for (int c = '0'; c <= '9'; c++) values[c] = static_cast<signed char>(c - '0');
+        for (int c = 'A'; c <= 'F'; c++) values[c] = static_cast<signed char>(c - 'A' + 10);
+        for (int c = 'a'; c <= 'f'; c++) values[c] = static_cast<signed char>(c - 'a' + 10);
+    }
+};
+
+constexpr HexValueTable kHexValues;
+
+inline int hexValue(char16_t c) {
+    return (c < 128) ? kHexValues.values[c] : -1;
+}
+
+inline bool isHexSpace(char16_t c) {
+    return (c == u' ') || (c == u'\t') || (c == u'\n') || (c == u'\r');
+}
+
+// Writes "XX " for every input byte, including the last one
+void writeHexTriplets(const uchar *data, qsizetype size, char *out) {
+    for (qsizetype index = 0; index < size; index++) {
+        const char *pair = kHexPairs.pairs[data[index]];
+        out[0]           = pair[0];
+        out[1]           = pair[1];
+        out[2]           = ' ';
+        out += 3;
+    }
+}
+
+#ifdef HEXDUMP_HAVE_X86_KERNELS
+
+// 16 input bytes become 48 output characters. The digits of bytes 0-7 are in
+// register a and of bytes 8-15 in register b (two characters per byte), the
+// masks below pick them into place and leave a hole for every separator.
+enum Source { FromA, FromB };
+
+constexpr std::array<char, 16> shuffleMask(int block, Source source) {
+    std::array<char, 16> mask{};
+    for (int k = 0; k < 16; k++) {
+        const int position = block * 16 + k;
+        const int byte     = position / 3;
+        const int digit    = position % 3;
+        const bool inA     = byte < 8;
+        if ((digit == 2) || (inA != (source == FromA))) {
+            mask[k] = char(0x80);
+        } else {
+            mask[k] = char(2 * (byte % 8) + digit);
+        }
+    }
+    return mask;
+}
+
+constexpr std::array<char, 16> spaceMask(int block) {
+    std::array<char, 16> mask{};
+    for (int k = 0; k < 16; k++) mask[k] = (((block * 16 + k) % 3) == 2) ? ' ' : 0;
+    return mask;
+}
+
+constexpr std::array<char, 16> kMask0A  = shuffleMask(0, FromA);
+constexpr std::array<char, 16> kMask1A  = shuffleMask(1, FromA);
+constexpr std::array<char, 16> kMask1B  = shuffleMask(1, FromB);
+constexpr std::array<char, 16> kMask2B  = shuffleMask(2, FromB);
+constexpr std::array<char, 16> kSpaces0 = spaceMask(0);
+constexpr std::array<char, 16> kSpaces1 = spaceMask(1);
+constexpr std::array<char, 16> kSpaces2 = spaceMask(2);
+
+inline __m128i load(const std::array<char, 16> &mask) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask.data()));
+}
+
+__attribute__((target("ssse3"))) inline void storeTriplets(__m128i a, __m128i b, char *out) {
+    const __m128i block0 = _mm_or_si128(_mm_shuffle_epi8(a, load(kMask0A)), load(kSpaces0));
+    const __m128i block1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, load(kMask1A)), _mm_shuffle_epi8(b, load(kMask1B))),
+                                        load(kSpaces1));
+    const __m128i block2 = _mm_or_si128(_mm_shuffle_epi8(b, load(kMask2B)), load(kSpaces2));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), block0);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16), block1);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 32), block2);
+}
+
+__attribute__((target("ssse3"))) void writeHexTripletsSsse3(const uchar *data, qsizetype size, char *out) {
+    const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i *>(kHexDigits));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+
+    qsizetype index = 0;
+    for (; index + 16 <= size; index += 16) {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + index));
+        const __m128i high  = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(value, 4), nibble));
+        const __m128i low   = _mm_shuffle_epi8(digits, _mm_and_si128(value, nibble));
+        storeTriplets(_mm_unpacklo_epi8(high, low), _mm_unpackhi_epi8(high, low), out + index * 3);
+    }
+    writeHexTriplets(data + index, size - index, out + index * 3);
+}
+
+__attribute__((target("avx2"))) void writeHexTripletsAvx2(const uchar *data, qsizetype size, char *out) {
+    const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(kHexDigits)));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+    qsizetype index = 0;
+    for (; index + 32 <= size; index += 32) {
+        const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + index));
+        const __m256i high  = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(value, 4), nibble));
+        const __m256i low   = _mm256_shuffle_epi8(digits, _mm256_and_si256(value, nibble));
+        // Unpacking works per 128-bit lane: lo = bytes 0-7 | 16-23, hi = bytes 8-15 | 24-31
+        const __m256i lo = _mm256_unpacklo_epi8(high, low);
+        const __m256i hi = _mm256_unpackhi_epi8(high, low);
+        storeTriplets(_mm256_castsi256_si128(lo), _mm256_castsi256_si128(hi), out + index * 3);
+        storeTriplets(_mm256_extracti128_si256(lo, 1), _mm256_extracti128_si256(hi, 1), out + index * 3 + 48);
+    }
+    writeHexTripletsSsse3(data + index, size - index, out + index * 3);
+}
+
+#endif  // HEXDUMP_HAVE_X86_KERNELS
+
+using TripletWriter = void (*)(const uchar *, qsizetype, char *);
+
+TripletWriter selectTripletWriter() {
+#ifdef HEXDUMP_HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return writeHexTripletsAvx2;
+    if (__builtin_cpu_supports("ssse3")) return writeHexTripletsSsse3;
+#endif
+    return writeHexTriplets;
+}
+
+const TripletWriter writeTriplets = selectTripletWriter();
+
+char *writeSpacedHexWith(TripletWriter writer, const uchar *data, qsizetype size, char *out) {
+    if (size <= 0) return out;
+
+    // The last byte goes through the table so no separator is written past the end
+    writer(data, size - 1, out);
+    out += (size - 1) * 3;
+    out[0] = kHexPairs.pairs[data[size - 1]][0];
+    out[1] = kHexPairs.pairs[data[size - 1]][1];
+    return out + 2;
+}
+
+}  // namespace
+
+namespace HexDump {
+
+qsizetype spacedHexSize(qsizetype size) {
+    return (size > 0) ? (size * 3 - 1) : 0;
+}
+
+char *writeSpacedHex(const uchar *data, qsizetype size, char *out) {
+    return writeSpacedHexWith(writeTriplets, data, size, out);
+}
+
+void toSpacedHex(QByteArrayView data, QByteArray &out) {
+    out.resize(spacedHexSize(data.size()));
+    writeSpacedHex(reinterpret_cast<const uchar *>(data.data()), data.size(), out.data());
+}
+
+QByteArray toSpacedHex(QByteArrayView data) {
+    QByteArray out;
+    toSpacedHex(data, out);
+    return out;
+}
+
+QList<Kernel> supportedKernels() {
+    QList<Kernel> kernels = {Scalar};
+#ifdef HEXDUMP_HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("ssse3")) kernels.append(Ssse3);
+    if (__builtin_cpu_supports("avx2")) kernels.append(Avx2);
+#endif
+    return kernels;
+}
+
+QString kernelName(Kernel kernel) {
+    switch (kernel) {
+        case Scalar:
+            return u"scalar"_s;
+        case Ssse3:
+            return u"ssse3"_s;
+        case Avx2:
+            return u"avx2"_s;
+    }
+    return QString();
+}
+
+char *writeSpacedHex(Kernel kernel, const uchar *data, qsizetype size, char *out) {
+    switch (kernel) {
+#ifdef HEXDUMP_HAVE_X86_KERNELS
+        case Ssse3:
+            return writeSpacedHexWith(writeHexTripletsSsse3, data, size, out);
+        case Avx2:
+            return writeSpacedHexWith(writeHexTripletsAvx2, data, size, out);
+#endif
+        case Scalar:
+        default:
+            return writeSpacedHexWith(writeHexTriplets, data, size, out);
+    }
+}
+
+QList<QByteArray> toLines(QByteArrayView data, const Options &options, quint64 baseOffset) {
+    const qsizetype perLine   = qMax(1, options.bytesPerLine);
+    const qsizetype hexWidth  = spacedHexSize(perLine);
+    const qsizetype lineCount = (data.size() + perLine - 1) / perLine;
+    const uchar    *bytes     = reinterpret_cast<const uchar *>(data.data());
+
+    QList<QByteArray> lines;
+    lines.reserve(lineCount);
+    for (qsizetype start = 0; start < data.size(); start += perLine) {
+        const qsizetype count = qMin(perLine, data.size() - start);
+        const qsizetype width = (options.showOffset ? 10 : 0) + (options.showAscii ? hexWidth + 2 + count : spacedHexSize(count));
+
+        QByteArray line(width, ' ');
+        char      *out = line.data();
+        if (options.showOffset == true) {
+            quint32 offset = quint32(baseOffset + start);
+            for (int digit = 7; digit >= 0; digit--, offset >>= 4) out[digit] = kHexDigits[offset & 0x0F];
+            out[8] = ':';
+            out += 10;
+        }
+        writeSpacedHex(bytes + start, count, out);
+        if (options.showAscii == true) {
+            // Short last line: pad the hex column so the text column stays aligned
+            out += hexWidth + 2;
+            for (qsizetype index = 0; index < count; index++) {
+                const uchar value = bytes[start + index];
+                out[index]        = ((value >= 0x20) && (value < 0x7F)) ? char(value) : '.';
+            }
+        }
+        lines.append(line);
+    }
+    return lines;
+}
+
+bool fromHexText(QStringView text, QByteArray &out, qsizetype *errorPos) {
+    out.resize(0);
+    out.reserve(text.size() / 2 + 1);
+
+    int high = -1;  // first digit of a pair that is not complete yet
+    for (qsizetype index = 0; index < text.size(); index++) {
+        const char16_t c     = text[index].unicode();
+        const int      value = hexValue(c);
+        if (value >= 0) {
+            if (high < 0) {
+                high = value;
+            } else {
+                out.append(char((high << 4) | value));
+                high = -1;
+            }
+        } else if (isHexSpace(c) == true) {
+            if (high >= 0) out.append(char(high));
+            high = -1;
+        } else {
+            if (errorPos != nullptr) *errorPos = index;
+            return false;
+        }
+    }
+    if (high >= 0) out.append(char(high));
+    return true;
+}
+
+void normalizeHexInput(QString &text, int &pos) {
+    // A first pass only checks, typing in well formed text then costs no allocation
+    const qsizetype size     = text.size();
+    bool            isNormal = true;
+    int             run      = 0;  // digits since the last space
+    for (qsizetype index = 0; (index < size) && (isNormal == true); index++) {
+        const char16_t c = text[index].unicode();
+        if (hexValue(c) >= 0) {
+            isNormal = (run < 2);
+            run++;
+        } else {
+            isNormal = (c == u' ') && (index > 0) && (text[index - 1] != u' ');
+            run      = 0;
+        }
+    }
+    if (isNormal == true) return;
+
+    QString out;
+    int     newPos = -1;
+    out.reserve(size + size / 2);
+    run = 0;
+    for (qsizetype index = 0; index < size; index++) {
+        if (index == pos) newPos = int(out.size());
+
+        const char16_t c = text[index].unicode();
+        if (hexValue(c) >= 0) {
+            if (run == 2) {
+                out.append(u' ');
+                run = 0;
+            }
+            out.append(QChar(c));
+            run++;
+        } else if ((isHexSpace(c) == true) && (out.isEmpty() == false) && (out.back() != u' ')) {
+            out.append(u' ');
+            run = 0;
+        }
+    }
+    text = out;
+    pos  = (newPos < 0) ? int(out.size()) : newPos;
+}
+
+}  // namespace HexDump
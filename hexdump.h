@@ -0,0 +1,58 @@
+#ifndef HEXDUMP_H
+#define HEXDUMP_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+#include <QString>
+#include <QStringView>
+
+// Single pass hex formatting of received data. All output is written into a
+// buffer sized up front; the hex digits come from a lookup table, or from a
+// SSSE3/AVX2 kernel when the CPU supports it. Hex typed or pasted by the user
+// goes the other way through one linear tokenizer.
+namespace HexDump {
+
+struct Options {
+    bool showOffset   = false;  // "00000010: " in front of every line
+    bool showAscii    = false;  // printable characters after the hex column, '.' otherwise
+    int  bytesPerLine = 16;
+};
+
+// "01 23 45" for {0x01, 0x23, 0x45}, uppercase, no trailing space
+qsizetype spacedHexSize(qsizetype size);
+char     *writeSpacedHex(const uchar *data, qsizetype size, char *out);
+
+void       toSpacedHex(QByteArrayView data, QByteArray &out);
+QByteArray toSpacedHex(QByteArrayView data);
+
+// The ways writeSpacedHex can go, the fastest one the CPU supports is taken.
+// Each one can be run on its own, so they can be checked against each other.
+enum Kernel {
+    Scalar,
+    Ssse3,
+    Avx2,
+};
+
+QList<Kernel> supportedKernels();
+QString       kernelName(Kernel kernel);
+// writeSpacedHex with the given kernel, which has to be supported
+char *writeSpacedHex(Kernel kernel, const uchar *data, qsizetype size, char *out);
+
+// xxd style dump, one entry per line
+QList<QByteArray> toLines(QByteArrayView data, const Options &options, quint64 baseOffset = 0);
+
+// Hex text as entered by hand: whitespace separates bytes, a run of digits is
+// split into pairs from the left and a digit left on its own is a byte by
+// itself, so "1 234" is {0x01, 0x23, 0x04}. Fails on anything else, with the
+// offending position in errorPos.
+bool fromHexText(QStringView text, QByteArray &out, qsizetype *errorPos = nullptr);
+
+// Keeps the hex digits with single spaces between the bytes, dropping
+// everything else, and moves pos along with the character it was at. Text
+// that already is in that form is left alone without allocating.
+void normalizeHexInput(QString &text, int &pos);
+
+}  // namespace HexDump
+
+#endif  // HEXDUMP_H
@@ -0,0 +1,66 @@
+#include "logindex.h"
+
+#include <QChar>
+
+static constexpr quint32 kNoCharacter = 0xffffffff;
+
+// Matches how Qt::CaseInsensitive compares, with a shortcut for ASCII. Characters
+// outside the BMP fold as pairs, they all share one value here.
+static quint32 fold(char16_t c) {
+    if (c < 0x80) return (c >= u'A' && c <= u'Z') ? quint32(c) + 0x20 : quint32(c);
+    if (QChar::isSurrogate(c) == true) return 0xd800;
+    return quint32(QChar::toCaseFolded(char32_t(c)));
+}
+
+static void setBit(LogIndex::Signature &signature, quint32 first, quint32 second) {
+    const quint32 bit = ((first * 0x9e3779b1u) ^ (second * 0x85ebca6bu)) >> 20;
+    signature[bit >> 6] |= quint64(1) << (bit & 63);
+}
+
+LogIndex::Signature LogIndex::signature(QStringView text) {
+    Signature result{};
+    addTo(result, text);
+    return result;
+}
+
+void LogIndex::addTo(Signature &signature, QStringView text) {
+    quint32 previous = kNoCharacter;
+    for (const QChar c : text) {
+        const quint32 current = fold(c.unicode());
+        setBit(signature, current, kNoCharacter);
+        if (previous != kNoCharacter) setBit(signature, previous, current);
+        previous = current;
+    }
+}
+
+void LogIndex::add(quint64 line, QStringView text) {
+    const quint64 block = line / kBlockLines;
+    if (m_blocks.empty() == true) m_firstBlock = block;
+    while (m_firstBlock + m_blocks.size() <= block) m_blocks.emplace_back();
+    addTo(m_blocks[block - m_firstBlock], text);
+}
+
+void LogIndex::removeBefore(quint64 line) {
+    // A block is dropped with its last line, until then it still covers the lines left in it
+    const quint64 block = line / kBlockLines;
+    while (m_blocks.empty() == false && m_firstBlock < block) {
+        m_blocks.pop_front();
+        m_firstBlock++;
+    }
+}
+
+void LogIndex::clear() {
+    m_blocks.clear();
+    m_firstBlock = 0;
+}
+
+bool LogIndex::mayContain(quint64 line, const Signature &signature) const {
+    const quint64 block = line / kBlockLines;
+    if (block < m_firstBlock || block - m_firstBlock >= m_blocks.size()) return true;
+
+    const Signature &bits = m_blocks[block - m_firstBlock];
+    for (std::size_t i = 0; i < bits.size(); i++) {
+        if ((bits[i] & signature[i]) != signature[i]) return false;
+    }
+    return true;
+}
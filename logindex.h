@@ -0,0 +1,38 @@
+#ifndef LOGINDEX_H
+#define LOGINDEX_H
+
+#include <QStringView>
+#include <array>
+#include <deque>
+
+// Coarse index over the lines of the data log, kept up to date as lines are
+// appended and dropped. For every block of kBlockLines lines it holds a bitmap
+// of the case folded characters and character pairs that occur in them. Text
+// can only be in a block whose bitmap has all the bits of the text, so a
+// search skips most blocks without looking at their lines and its cost follows
+// the number of candidate blocks rather than the size of the log.
+class LogIndex {
+   public:
+    static constexpr quint64 kBlockLines = 256;
+
+    using Signature = std::array<quint64, 64>;  // 4096 bits, hashed
+
+    // The bits text sets, the same for all spellings that differ only in case
+    static Signature signature(QStringView text);
+
+    // Lines are numbered from the start of the session and come in order
+    void add(quint64 line, QStringView text);
+    void removeBefore(quint64 line);
+    void clear();
+
+    // False only when no line of the block holding line can contain text with the signature
+    bool mayContain(quint64 line, const Signature &signature) const;
+
+   private:
+    static void addTo(Signature &signature, QStringView text);
+
+    std::deque<Signature> m_blocks;
+    quint64               m_firstBlock = 0;
+};
+
+#endif  // LOGINDEX_H
@@ -0,0 +1,146 @@
+#include "logmodel.h"
+
+LogModel::LogModel(QObject *parent) : QAbstractListModel(parent) {}
+
+QBrush LogModel::brush(Kind kind) {
+    switch (kind) {
+        case Timestamp:
+            return QBrush(Qt::gray);
+        case Received:
+            return QBrush(Qt::blue);
+        case Transmitted:
+            return QBrush(Qt::darkGreen);
+        case Decoded:
+            return QBrush(Qt::darkMagenta);
+        case Status:
+        default:
+            return QBrush(Qt::black);
+    }
+}
+
+int LogModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_lines.size());
+}
+
+QVariant LogModel::data(const QModelIndex &index, int role) const {
+    if ((index.isValid() == false) || (index.row() >= static_cast<int>(m_lines.size()))) return QVariant();
+
+    const Line &line = m_lines[index.row()];
+    switch (role) {
+        case Qt::DisplayRole:
+        case Qt::ToolTipRole:
+            return lineText(line);
+        case Qt::ForegroundRole:
+            return brush(line.kind);
+        default:
+            return QVariant();
+    }
+}
+
+void LogModel::append(Kind kind, const QString &text) {
+    m_pending.push_back({text, kind});
+    if (m_isFlushScheduled == false) {
+        m_isFlushScheduled = true;
+        QMetaObject::invokeMethod(this, &LogModel::flush, Qt::QueuedConnection);
+    }
+}
+
+void LogModel::appendTimestamp(qint64 monotonicNs, qint64 realtimeNs, const QString &label) {
+    const qint64 deltaNs = (m_lastTimeNs != 0) ? monotonicNs - m_lastTimeNs : 0;
+    m_lastTimeNs         = monotonicNs;
+    m_pending.push_back({label, Timestamp, monotonicNs, realtimeNs, deltaNs});
+    if (m_isFlushScheduled == false) {
+        m_isFlushScheduled = true;
+        QMetaObject::invokeMethod(this, &LogModel::flush, Qt::QueuedConnection);
+    }
+}
+
+void LogModel::flush() {
+    m_isFlushScheduled = false;
+    if (m_pending.empty() == true) return;
+
+    const int first = static_cast<int>(m_lines.size());
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(m_pending.size()) - 1);
+    for (Line &line : m_pending) {
+        // Of a Timestamp line only the label, the time is put into words when it is shown
+        m_index.add(m_firstLineNumber + m_lines.size(), line.text);
+        m_memoryUsage += lineCost(line);
+        m_lines.push_back(std::move(line));
+    }
+    m_pending.clear();
+    endInsertRows();
+
+    evict();
+}
+
+void LogModel::clear() {
+    m_pending.clear();
+    beginResetModel();
+    m_firstLineNumber += m_lines.size();
+    m_lines.clear();
+    m_index.clear();
+    m_memoryUsage = 0;
+    m_lastTimeNs  = 0;
+    endResetModel();
+}
+
+void LogModel::setMemoryBudget(qint64 bytes) {
+    m_memoryBudget = bytes;
+    evict();
+}
+
+void LogModel::setTimeFormat(TimeFormat format, TimestampFormatter::Resolution resolution) {
+    if ((format == m_timeFormat) && (resolution == m_formatter.resolution())) return;
+
+    m_timeFormat = format;
+    m_formatter.setResolution(resolution);
+    if (m_lines.empty() == true) return;
+    emit dataChanged(createIndex(0, 0), createIndex(static_cast<int>(m_lines.size()) - 1, 0));
+}
+
+QString LogModel::text(int row) const {
+    return ((row >= 0) && (row < static_cast<int>(m_lines.size()))) ? lineText(m_lines[row]) : QString();
+}
+
+LogModel::Kind LogModel::kind(int row) const {
+    return ((row >= 0) && (row < static_cast<int>(m_lines.size()))) ? m_lines[row].kind : Status;
+}
+
+QString LogModel::lineText(const Line &line) const {
+    if (line.kind != Timestamp) return line.text;
+
+    QString text;
+    text.reserve(line.text.size() + 32);
+    text += u'[';
+    if (m_timeFormat == DeltaTime) {
+        m_formatter.appendDelta(line.deltaNs, text);
+    } else {
+        m_formatter.appendAbsolute(line.realtimeNs, text);
+    }
+    text += u"]# ";
+    text += line.text;
+    return text;
+}
+
+qint64 LogModel::lineCost(const Line &line) {
+    return static_cast<qint64>(sizeof(Line)) + line.text.capacity() * static_cast<qint64>(sizeof(QChar));
+}
+
+void LogModel::evict() {
+    if ((m_memoryUsage <= m_memoryBudget) || (m_lines.size() <= 1)) return;
+
+    // Drop whole lines from the front until the log fits into the budget again
+    int    count = 0;
+    qint64 usage = m_memoryUsage;
+    while ((usage > m_memoryBudget) && (count < static_cast<int>(m_lines.size()) - 1)) {
+        usage -= lineCost(m_lines[count]);
+        count++;
+    }
+
+    beginRemoveRows(QModelIndex(), 0, count - 1);
+    m_lines.erase(m_lines.begin(), m_lines.begin() + count);
+    m_firstLineNumber += count;
+    m_index.removeBefore(m_firstLineNumber);
+    m_memoryUsage = usage;
+    endRemoveRows();
+}
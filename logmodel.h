@@ -0,0 +1,98 @@
+#ifndef LOGMODEL_H
+#define LOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QBrush>
+#include <QString>
+#include <deque>
+#include <vector>
+
+#include "logindex.h"
+#include "timestampformatter.h"
+
+// Line oriented data log kept within a fixed memory budget. Lines are stored in
+// a ring (the oldest lines are dropped once the budget is exceeded), so append
+// cost stays constant no matter how long the capture runs. Only the rows that
+// are visible in the attached view are ever laid out. Appended lines become rows
+// in batches, so the view relayouts once per batch rather than once per line.
+// Every line has a number that stays the same while older lines are dropped,
+// and is entered into a LogIndex for searching as it becomes a row. Time stamp
+// lines keep the monotonic and the wall clock time of the read or write as
+// integers and are only put into words when they are shown, in the current time
+// format; the index only knows their label.
+class LogModel : public QAbstractListModel {
+    Q_OBJECT
+
+   public:
+    enum Kind : quint8 {
+        Status,       // port opened/closed, errors
+        Timestamp,    // "[date time]# RECV HEX", or the time since the previous one
+        Received,     // RX payload
+        Transmitted,  // TX payload
+        Decoded,      // RX payload as taken apart by a dissector
+    };
+
+    enum TimeFormat {
+        AbsoluteTime,  // local date and time
+        DeltaTime,     // since the previous time stamp, for inter-frame timing
+    };
+
+    static constexpr qint64 kDefaultMemoryBudget = 64 * 1024 * 1024;
+
+    explicit LogModel(QObject *parent = nullptr);
+
+    static QBrush brush(Kind kind);
+
+    int      rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    // The line shows up as a row at the next flush, at the latest once control
+    // returns to the event loop
+    void append(Kind kind, const QString &text);
+    // A Timestamp line for something read or written at monotonicNs, with the wall
+    // clock read next to it; label is what follows the time
+    void appendTimestamp(qint64 monotonicNs, qint64 realtimeNs, const QString &label);
+    void flush();
+    void clear();
+
+    void   setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const { return m_memoryBudget; }
+    qint64 memoryUsage() const { return m_memoryUsage; }
+
+    // Rows already shown are drawn again in the new format
+    void       setTimeFormat(TimeFormat format, TimestampFormatter::Resolution resolution);
+    TimeFormat timeFormat() const { return m_timeFormat; }
+
+    QString text(int row) const;
+    Kind    kind(int row) const;
+
+    // Number of the line in row 0, counted since the model was created
+    quint64         firstLineNumber() const { return m_firstLineNumber; }
+    const LogIndex &lineIndex() const { return m_index; }
+
+   private:
+    struct Line {
+        QString text;            // the label of a Timestamp line
+        Kind    kind;
+        qint64  timeNs     = 0;  // Timestamp lines: monotonic
+        qint64  realtimeNs = 0;  // Timestamp lines: wall clock
+        qint64  deltaNs    = 0;  // Timestamp lines: since the previous one
+    };
+
+    static qint64 lineCost(const Line &line);
+    void          evict();
+    QString       lineText(const Line &line) const;
+
+    std::deque<Line>   m_lines;
+    std::vector<Line>  m_pending;  // appended since the last flush
+    LogIndex           m_index;
+    quint64            m_firstLineNumber  = 0;
+    qint64             m_memoryBudget     = kDefaultMemoryBudget;
+    qint64             m_memoryUsage      = 0;
+    bool               m_isFlushScheduled = false;
+    TimeFormat         m_timeFormat       = AbsoluteTime;
+    TimestampFormatter m_formatter;
+    qint64             m_lastTimeNs = 0;  // of the last time stamp appended, 0 before the first
+};
+
+#endif  // LOGMODEL_H
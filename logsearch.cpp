@@ -0,0 +1,252 @@
+#include "logsearch.h"
+
+#include <QElapsedTimer>
+#include <algorithm>
+#include <vector>
+
+#include "hexdump.h"
+
+// Time one scan slice may take before the event loop gets to run again
+static constexpr qint64 kScanSlice_ns = 5 * 1000 * 1000;
+
+// What the time part "[yyyy-MM-dd hh:mm:ss.zzz]# " or "[+s.zzz]# " of a time stamp line is made of
+static bool isTimeCharacter(QChar c) {
+    return c.isDigit() == true || QStringView(u"[]#:-+. ").contains(c) == true;
+}
+
+// A needle without any of them can only be in the label of a time stamp line, which the index holds
+static bool mayMatchTime(const QString &text) {
+    return std::any_of(text.begin(), text.end(), isTimeCharacter);
+}
+
+// How far above a matching payload line its time stamp line is looked for
+static constexpr int kMaxHeaderDistance = 64;
+
+LogSearch::LogSearch(LogModel *log, QObject *parent)
+    : QAbstractListModel(parent), m_log(log), m_scanTimer(new QTimer(this)) {
+    m_scanTimer->setInterval(0);
+
+    connect(m_scanTimer, &QTimer::timeout, this, &LogSearch::scan);
+    connect(m_log, &QAbstractItemModel::rowsInserted, this, &LogSearch::logRowsInserted);
+    connect(m_log, &QAbstractItemModel::rowsRemoved, this, &LogSearch::logRowsRemoved);
+    connect(m_log, &QAbstractItemModel::modelReset, this, &LogSearch::logReset);
+    // The time format changed, the rows shown here are drawn from the log
+    connect(m_log, &QAbstractItemModel::dataChanged, this, [this]() {
+        if (m_rows.empty() == false) emit dataChanged(createIndex(0, 0), createIndex(int(m_rows.size()) - 1, 0));
+    });
+}
+
+bool LogSearch::setQuery(const QString &pattern, Mode mode, QString *errorString) {
+    QList<Needle>      needles;
+    QRegularExpression regex;
+
+    if (pattern.isEmpty() == false) {
+        switch (mode) {
+            case Hex: {
+                QByteArray bytes;
+                qsizetype  errorPos = 0;
+                if (HexDump::fromHexText(pattern, bytes, &errorPos) == false || bytes.isEmpty() == true) {
+                    if (errorString != nullptr) *errorString = tr("Not a hex byte at position %1").arg(errorPos + 1);
+                    return false;
+                }
+                // Hex mode lines show the bytes as hex, the others as text
+                const QString hex  = QString::fromLatin1(HexDump::toSpacedHex(bytes));
+                const QString text = QString::fromUtf8(bytes);
+                needles.append({hex, Qt::CaseInsensitive, LogIndex::signature(hex), mayMatchTime(hex)});
+                needles.append({text, Qt::CaseSensitive, LogIndex::signature(text), mayMatchTime(text)});
+                break;
+            }
+            case Regex:
+                regex.setPattern(pattern);
+                regex.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+                if (regex.isValid() == false) {
+                    if (errorString != nullptr) *errorString = regex.errorString();
+                    return false;
+                }
+                regex.optimize();
+                break;
+            case Text:
+            default:
+                needles.append({pattern, Qt::CaseInsensitive, LogIndex::signature(pattern), mayMatchTime(pattern)});
+                break;
+        }
+    }
+
+    m_mode     = mode;
+    m_needles  = needles;
+    m_regex    = regex;
+    m_isActive = (pattern.isEmpty() == false);
+    reset();
+    return true;
+}
+
+int LogSearch::nextMatch(int logRow) const {
+    const qint64 line = qint64(m_log->firstLineNumber()) + logRow;
+    auto         it   = std::upper_bound(m_rows.begin(), m_rows.end(), line,
+                                         [](qint64 value, const Row &row) { return value < qint64(row.line); });
+    while (it != m_rows.end() && it->isMatch == false) ++it;
+    return (it != m_rows.end()) ? int(it->line - m_log->firstLineNumber()) : -1;
+}
+
+int LogSearch::previousMatch(int logRow) const {
+    const qint64 line = qint64(m_log->firstLineNumber()) + logRow;
+    auto         it   = std::lower_bound(m_rows.begin(), m_rows.end(), line,
+                                         [](const Row &row, qint64 value) { return qint64(row.line) < value; });
+    while (it != m_rows.begin()) {
+        --it;
+        if (it->isMatch == true) return int(it->line - m_log->firstLineNumber());
+    }
+    return -1;
+}
+
+int LogSearch::logRow(int row) const {
+    return ((row >= 0) && (row < static_cast<int>(m_rows.size()))) ? int(m_rows[row].line - m_log->firstLineNumber())
+                                                                    : -1;
+}
+
+int LogSearch::row(int logRow) const {
+    const qint64 line = qint64(m_log->firstLineNumber()) + logRow;
+    auto         it   = std::lower_bound(m_rows.begin(), m_rows.end(), line,
+                                         [](const Row &row, qint64 value) { return qint64(row.line) < value; });
+    return (it != m_rows.end() && qint64(it->line) == line) ? int(it - m_rows.begin()) : -1;
+}
+
+int LogSearch::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+QVariant LogSearch::data(const QModelIndex &index, int role) const {
+    if ((index.isValid() == false) || (index.row() >= static_cast<int>(m_rows.size()))) return QVariant();
+    return m_log->data(m_log->index(logRow(index.row())), role);
+}
+
+void LogSearch::scan() {
+    QElapsedTimer clock;
+    clock.start();
+
+    const quint64 first = m_log->firstLineNumber();
+    const quint64 end   = first + quint64(m_log->rowCount());
+    m_nextLine          = qMax(m_nextLine, first);
+
+    std::vector<Row> found;
+    qint64           lastLine     = m_rows.empty() ? -1 : qint64(m_rows.back().line);
+    quint64          checkedBlock = ~quint64(0);
+    bool             isTimeOnly   = false;  // the index ruled the block out, only its time stamp lines are left
+    const bool       isTimeQuery  = timeMayMatch();
+    const auto       append       = [&](quint64 line, bool isMatch) {
+        found.push_back({line, isMatch});
+        lastLine = qint64(line);
+    };
+
+    while (m_nextLine < end) {
+        if ((m_nextLine % 64) == 0 && clock.nsecsElapsed() >= kScanSlice_ns) break;
+
+        // Blocks the index rules out are passed over as a whole, or for all but their time stamp lines
+        const quint64 block = m_nextLine / LogIndex::kBlockLines;
+        if (block != checkedBlock) {
+            checkedBlock = block;
+            isTimeOnly   = (blockMayMatch(m_nextLine) == false);
+            if (isTimeOnly == true && isTimeQuery == false) {
+                m_nextLine = qMin(end, (block + 1) * LogIndex::kBlockLines);
+                continue;
+            }
+        }
+
+        const int row = int(m_nextLine - first);
+        if (isTimeOnly == true && m_log->kind(row) != LogModel::Timestamp) {
+            m_nextLine++;
+            continue;
+        }
+        if (matches(m_log->text(row)) == true) {
+            // A payload line comes with the time stamp line above it, a decoded line sits below its payload
+            const LogModel::Kind kind = m_log->kind(row);
+            if (kind == LogModel::Received || kind == LogModel::Transmitted || kind == LogModel::Decoded) {
+                for (int r = row - 1; r >= 0 && r >= row - kMaxHeaderDistance; r--) {
+                    const LogModel::Kind above = m_log->kind(r);
+                    if (above == LogModel::Timestamp && qint64(first) + r > lastLine) append(first + r, false);
+                    if (above != kind && (kind != LogModel::Decoded || above != LogModel::Received)) break;
+                }
+            }
+            append(m_nextLine, true);
+            m_matchCount++;
+        }
+        m_nextLine++;
+    }
+
+    if (found.empty() == false) {
+        const int row = static_cast<int>(m_rows.size());
+        beginInsertRows(QModelIndex(), row, row + static_cast<int>(found.size()) - 1);
+        m_rows.insert(m_rows.end(), found.begin(), found.end());
+        endInsertRows();
+    }
+    if (m_nextLine >= end) m_scanTimer->stop();
+    emit matchesChanged();
+}
+
+bool LogSearch::matches(const QString &text) const {
+    if (m_mode == Regex) return m_regex.match(text).hasMatch();
+
+    for (const Needle &needle : m_needles) {
+        if (text.contains(needle.text, needle.caseSensitivity) == true) return true;
+    }
+    return false;
+}
+
+bool LogSearch::blockMayMatch(quint64 line) const {
+    if (m_mode == Regex) return true;
+
+    for (const Needle &needle : m_needles) {
+        if (m_log->lineIndex().mayContain(line, needle.signature) == true) return true;
+    }
+    return false;
+}
+
+bool LogSearch::timeMayMatch() const {
+    if (m_mode == Regex) return true;
+
+    return std::any_of(m_needles.begin(), m_needles.end(), [](const Needle &needle) { return needle.mayMatchTime; });
+}
+
+void LogSearch::logRowsInserted() {
+    if (m_isActive == true && m_scanTimer->isActive() == false) m_scanTimer->start();
+}
+
+void LogSearch::logRowsRemoved(const QModelIndex &parent, int first, int last) {
+    Q_UNUSED(parent);
+    Q_UNUSED(first);
+    Q_UNUSED(last);
+
+    // The log only drops lines from the front, their rows go with them
+    const quint64 firstLine = m_log->firstLineNumber();
+    m_nextLine              = qMax(m_nextLine, firstLine);
+
+    const auto end   = std::lower_bound(m_rows.begin(), m_rows.end(), firstLine,
+                                        [](const Row &row, quint64 value) { return row.line < value; });
+    const int  count = static_cast<int>(end - m_rows.begin());
+    if (count == 0) return;
+
+    beginRemoveRows(QModelIndex(), 0, count - 1);
+    m_matchCount -= quint64(std::count_if(m_rows.begin(), end, [](const Row &row) { return row.isMatch; }));
+    m_rows.erase(m_rows.begin(), end);
+    endRemoveRows();
+    emit matchesChanged();
+}
+
+void LogSearch::logReset() {
+    reset();
+}
+
+void LogSearch::reset() {
+    beginResetModel();
+    m_rows.clear();
+    m_matchCount = 0;
+    m_nextLine   = m_log->firstLineNumber();
+    endResetModel();
+
+    if (m_isActive == true) {
+        m_scanTimer->start();
+    } else {
+        m_scanTimer->stop();
+    }
+    emit matchesChanged();
+}
@@ -0,0 +1,86 @@
+#ifndef LOGSEARCH_H
+#define LOGSEARCH_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QRegularExpression>
+#include <QTimer>
+#include <deque>
+
+#include "logindex.h"
+#include "logmodel.h"
+
+// Search over a LogModel that keeps up with the capture. The log is scanned in
+// slices of a few milliseconds from the event loop, blocks the index rules out
+// are skipped (but for their time stamp lines, when the query could match the
+// time the index does not hold), and lines appended later are searched as they
+// come in, so the GUI never waits on a search however large the log is. As a
+// model it holds the matching lines, each payload preceded by its time stamp
+// line, and can be shown in a LogView instead of the whole log.
+class LogSearch : public QAbstractListModel {
+    Q_OBJECT
+
+   public:
+    enum Mode {
+        Text,   // literal, case insensitive
+        Hex,    // bytes, as hex in hex mode lines and as text in the others
+        Regex,  // case insensitive, every line has to be looked at
+    };
+
+    explicit LogSearch(LogModel *log, QObject *parent = nullptr);
+
+    // An empty pattern ends the search
+    bool setQuery(const QString &pattern, Mode mode, QString *errorString = nullptr);
+    bool isActive() const { return m_isActive; }
+    bool isScanning() const { return m_scanTimer->isActive(); }
+
+    quint64 matchCount() const { return m_matchCount; }
+    // Rows of the log, not of this model, -1 when there is none
+    int nextMatch(int logRow) const;
+    int previousMatch(int logRow) const;
+    // Rows of this model and of the log showing the same line, -1 when there is none
+    int logRow(int row) const;
+    int row(int logRow) const;
+
+    int      rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+   signals:
+    void matchesChanged();
+
+   private:
+    struct Row {
+        quint64 line;
+        bool    isMatch;  // otherwise the time stamp of a match
+    };
+
+    struct Needle {
+        QString             text;
+        Qt::CaseSensitivity caseSensitivity;
+        LogIndex::Signature signature;
+        bool                mayMatchTime;  // has a character the time part of a time stamp line is made of
+    };
+
+    void scan();
+    bool matches(const QString &text) const;
+    bool blockMayMatch(quint64 line) const;
+    bool timeMayMatch() const;
+    void logRowsInserted();
+    void logRowsRemoved(const QModelIndex &parent, int first, int last);
+    void logReset();
+    void reset();
+
+    LogModel *m_log;
+    QTimer   *m_scanTimer = nullptr;
+
+    Mode               m_mode = Text;
+    QList<Needle>      m_needles;
+    QRegularExpression m_regex;
+    bool               m_isActive = false;
+
+    std::deque<Row> m_rows;
+    quint64         m_nextLine   = 0;  // first line not searched yet
+    quint64         m_matchCount = 0;
+};
+
+#endif  // LOGSEARCH_H
@@ -0,0 +1,219 @@
+#include "logview.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QKeyEvent>
+#include <QPainter>
+#include <QScrollBar>
+
+static constexpr int kTextMargin = 4;
+
+LogView::LogView(QWidget *parent) : QAbstractScrollArea(parent) {
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setBackgroundRole(QPalette::Base);
+    viewport()->setAutoFillBackground(true);
+    verticalScrollBar()->setSingleStep(1);
+    horizontalScrollBar()->setSingleStep(fontMetrics().averageCharWidth());
+}
+
+void LogView::setModel(QAbstractItemModel *model) {
+    if (m_model != nullptr) disconnect(m_model, nullptr, this, nullptr);
+
+    m_model = model;
+    if (m_model != nullptr) {
+        connect(m_model, &QAbstractItemModel::rowsInserted, this, &LogView::rowsInserted);
+        connect(m_model, &QAbstractItemModel::rowsRemoved, this, &LogView::rowsRemoved);
+        connect(m_model, &QAbstractItemModel::modelReset, this, &LogView::modelReset);
+        connect(m_model, &QAbstractItemModel::dataChanged, viewport(), qOverload<>(&QWidget::update));
+    }
+    modelReset();
+}
+
+bool LogView::isAtBottom() const {
+    return verticalScrollBar()->value() >= verticalScrollBar()->maximum();
+}
+
+void LogView::scrollToBottom() {
+    verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+}
+
+void LogView::scrollToRow(int row) {
+    verticalScrollBar()->setValue(row);
+}
+
+void LogView::selectRow(int row) {
+    if ((m_model == nullptr) || (row < 0) || (row >= m_model->rowCount())) return;
+
+    m_selectionAnchor = row;
+    m_selectionEnd    = row;
+
+    // Rows already in view stay where they are, others are brought to the middle
+    const int first = verticalScrollBar()->value();
+    if ((row < first) || (row >= first + visibleRowCount())) scrollToRow(row - visibleRowCount() / 2);
+    viewport()->update();
+}
+
+void LogView::selectAll() {
+    if ((m_model == nullptr) || (m_model->rowCount() == 0)) return;
+
+    m_selectionAnchor = 0;
+    m_selectionEnd    = m_model->rowCount() - 1;
+    viewport()->update();
+}
+
+void LogView::copy() {
+    if ((m_model == nullptr) || (m_selectionAnchor < 0)) return;
+
+    const int   first = qMin(m_selectionAnchor, m_selectionEnd);
+    const int   last  = qMax(m_selectionAnchor, m_selectionEnd);
+    QStringList lines;
+    lines.reserve(last - first + 1);
+    for (int row = first; row <= last; row++) lines.append(m_model->index(row, 0).data().toString());
+    QApplication::clipboard()->setText(lines.join(u'\n'));
+}
+
+void LogView::paintEvent(QPaintEvent *event) {
+    Q_UNUSED(event);
+    if (m_model == nullptr) return;
+
+    QPainter  painter(viewport());
+    const int height   = lineHeight();
+    const int first    = verticalScrollBar()->value();
+    const int last     = qMin(first + visibleRowCount(), m_model->rowCount() - 1);
+    const int xOffset  = kTextMargin - horizontalScrollBar()->value();
+    const int selFirst = qMin(m_selectionAnchor, m_selectionEnd);
+    const int selLast  = qMax(m_selectionAnchor, m_selectionEnd);
+    int       widest   = m_maxLineWidth;
+
+    for (int row = first; row <= last; row++) {
+        const QModelIndex index = m_model->index(row, 0);
+        const QString     text  = index.data(Qt::DisplayRole).toString();
+        const QRect       rect(0, (row - first) * height, viewport()->width(), height);
+
+        if ((m_selectionAnchor >= 0) && (row >= selFirst) && (row <= selLast)) {
+            painter.fillRect(rect, palette().highlight());
+            painter.setPen(palette().color(QPalette::HighlightedText));
+        } else {
+            const QVariant foreground = index.data(Qt::ForegroundRole);
+            painter.setPen(foreground.isValid() ? foreground.value<QBrush>().color() : palette().color(QPalette::Text));
+        }
+        painter.drawText(rect.adjusted(xOffset, 0, 0, 0), Qt::AlignLeft | Qt::AlignVCenter | Qt::TextSingleLine, text);
+        widest = qMax(widest, fontMetrics().horizontalAdvance(text) + 2 * kTextMargin);
+    }
+
+    // The horizontal range only grows with what has actually been shown
+    if (widest != m_maxLineWidth) {
+        m_maxLineWidth = widest;
+        updateScrollBars();
+    }
+}
+
+void LogView::resizeEvent(QResizeEvent *event) {
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void LogView::changeEvent(QEvent *event) {
+    QAbstractScrollArea::changeEvent(event);
+    if (event->type() == QEvent::FontChange) {
+        m_maxLineWidth = 0;
+        updateScrollBars();
+    }
+}
+
+void LogView::mousePressEvent(QMouseEvent *event) {
+    const int row = rowAt(event->position().toPoint().y());
+    if (row < 0) return;
+
+    if (((event->modifiers() & Qt::ShiftModifier) == 0) || (m_selectionAnchor < 0)) m_selectionAnchor = row;
+    m_selectionEnd = row;
+    viewport()->update();
+}
+
+void LogView::mouseMoveEvent(QMouseEvent *event) {
+    if (((event->buttons() & Qt::LeftButton) == 0) || (m_selectionAnchor < 0)) return;
+
+    const int y   = event->position().toPoint().y();
+    const int row = rowAt(qBound(0, y, viewport()->height() - 1));
+    if (y < 0) verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepSub);
+    if (y >= viewport()->height()) verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+    if (row >= 0) m_selectionEnd = row;
+    viewport()->update();
+}
+
+void LogView::keyPressEvent(QKeyEvent *event) {
+    if (event == QKeySequence::Copy) {
+        copy();
+    } else if (event == QKeySequence::SelectAll) {
+        selectAll();
+    } else if (event->key() == Qt::Key_End) {
+        scrollToBottom();
+    } else if (event->key() == Qt::Key_Home) {
+        verticalScrollBar()->setValue(0);
+    } else {
+        QAbstractScrollArea::keyPressEvent(event);
+    }
+}
+
+void LogView::rowsInserted(const QModelIndex &parent, int first, int last) {
+    Q_UNUSED(parent);
+    Q_UNUSED(first);
+    Q_UNUSED(last);
+
+    // Like a text edit, keep following the tail while the view sits at the bottom
+    const bool follow = isAtBottom();
+    updateScrollBars();
+    if (follow == true) scrollToBottom();
+    viewport()->update();
+}
+
+void LogView::rowsRemoved(const QModelIndex &parent, int first, int last) {
+    Q_UNUSED(parent);
+    const int count = last - first + 1;
+
+    // Rows dropped from the front shift everything up, keep the same lines in view
+    if (first == 0) {
+        verticalScrollBar()->setValue(verticalScrollBar()->value() - count);
+        if (m_selectionAnchor >= 0) {
+            m_selectionAnchor = qMax(0, m_selectionAnchor - count);
+            m_selectionEnd    = qMax(0, m_selectionEnd - count);
+            if (qMax(m_selectionAnchor, m_selectionEnd) == 0) m_selectionAnchor = m_selectionEnd = -1;
+        }
+    }
+    updateScrollBars();
+    viewport()->update();
+}
+
+void LogView::modelReset() {
+    m_selectionAnchor = -1;
+    m_selectionEnd    = -1;
+    m_maxLineWidth    = 0;
+    updateScrollBars();
+    verticalScrollBar()->setValue(0);
+    viewport()->update();
+}
+
+int LogView::lineHeight() const {
+    return qMax(1, fontMetrics().lineSpacing());
+}
+
+int LogView::visibleRowCount() const {
+    return viewport()->height() / lineHeight();
+}
+
+int LogView::rowAt(int y) const {
+    if (m_model == nullptr) return -1;
+
+    const int row = verticalScrollBar()->value() + y / lineHeight();
+    return (row < m_model->rowCount()) ? row : m_model->rowCount() - 1;
+}
+
+void LogView::updateScrollBars() {
+    const int rows    = (m_model != nullptr) ? m_model->rowCount() : 0;
+    const int visible = visibleRowCount();
+
+    verticalScrollBar()->setPageStep(qMax(1, visible));
+    verticalScrollBar()->setRange(0, qMax(0, rows - visible));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setRange(0, qMax(0, m_maxLineWidth - viewport()->width()));
+}
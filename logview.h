@@ -0,0 +1,56 @@
+#ifndef LOGVIEW_H
+#define LOGVIEW_H
+
+#include <QAbstractItemModel>
+#include <QAbstractScrollArea>
+#include <QPointer>
+
+// Fixed line height view over a single column model. Only the rows that fit
+// into the viewport are queried and painted, so the cost of an append or a
+// repaint does not depend on how many lines the model holds.
+class LogView : public QAbstractScrollArea {
+    Q_OBJECT
+
+   public:
+    explicit LogView(QWidget *parent = nullptr);
+
+    void                setModel(QAbstractItemModel *model);
+    QAbstractItemModel *model() const { return m_model; }
+
+    bool isAtBottom() const;
+    // Row the selection was last extended to, -1 without a selection
+    int currentRow() const { return m_selectionEnd; }
+
+   public slots:
+    void scrollToBottom();
+    void scrollToRow(int row);
+    void selectRow(int row);
+    void selectAll();
+    void copy();
+
+   protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+
+   private:
+    void rowsInserted(const QModelIndex &parent, int first, int last);
+    void rowsRemoved(const QModelIndex &parent, int first, int last);
+    void modelReset();
+
+    int  lineHeight() const;
+    int  visibleRowCount() const;
+    int  rowAt(int y) const;
+    void updateScrollBars();
+
+    QPointer<QAbstractItemModel> m_model;
+
+    int m_selectionAnchor = -1;
+    int m_selectionEnd    = -1;
+    int m_maxLineWidth    = 0;
+};
+
+#endif  // LOGVIEW_H
@@ -1,22 +1,70 @@
 #include <QApplication>
+#include <QElapsedTimer>
 #include <QLocale>
+#include <QSettings>
+#include <QTimer>
 #include <QTranslator>
 
-#include "widget.h"
+#include "porttabwidget.h"
+
+using namespace Qt::StringLiterals;
+
+// Prints how long the window took to be drawn for the first time, then quits
+class FirstPaintProbe : public QObject {
+   public:
+    explicit FirstPaintProbe(const QElapsedTimer &clock) : m_clock(clock) {}
+
+   protected:
+    bool eventFilter(QObject *watched, QEvent *event) override {
+        if (event->type() == QEvent::Paint && m_isPainted == false) {
+            m_isPainted = true;
+            // The children are drawn and the frame flushed before this runs
+            QTimer::singleShot(0, qApp, [clock = m_clock]() {
+                qInfo("First paint after %.1f ms", double(clock.nsecsElapsed()) / 1e6);
+                QCoreApplication::quit();
+            });
+        }
+        return QObject::eventFilter(watched, event);
+    }
+
+   private:
+    QElapsedTimer m_clock;
+    bool          m_isPainted = false;
+};
 
 int main(int argc, char *argv[]) {
+    QElapsedTimer clock;
+    clock.start();
+
     QApplication a(argc, argv);
+    a.setOrganizationName(u"ComPort"_s);
+    a.setApplicationName(u"ComPort"_s);
 
+    // The translation found last time is loaded straight away, the languages are only
+    // looked through again when the system's list of them changes
+    QSettings         settings;
     QTranslator       translator;
     const QStringList uiLanguages = QLocale::system().uiLanguages();
-    for (const QString &locale : uiLanguages) {
-        const QString baseName = "ComPort_" + QLocale(locale).name();
-        if (translator.load(":/i18n/" + baseName)) {
-            a.installTranslator(&translator);
-            break;
+    if (settings.value(u"translation/languages"_s).toStringList() == uiLanguages) {
+        const QString fileName = settings.value(u"translation/file"_s).toString();
+        if (fileName.isEmpty() == false && translator.load(fileName)) a.installTranslator(&translator);
+    } else {
+        QString fileName;
+        for (const QString &locale : uiLanguages) {
+            const QString baseName = "ComPort_" + QLocale(locale).name();
+            if (translator.load(":/i18n/" + baseName)) {
+                a.installTranslator(&translator);
+                fileName = ":/i18n/" + baseName;
+                break;
+            }
         }
+        settings.setValue(u"translation/languages"_s, uiLanguages);
+        settings.setValue(u"translation/file"_s, fileName);
     }
-    Widget w;
+
+    PortTabWidget   w;
+    FirstPaintProbe probe(clock);
+    if (a.arguments().contains(u"--startup-time"_s) == true) w.installEventFilter(&probe);
     w.show();
     return a.exec();
 }
@@ -0,0 +1,222 @@
+#include "metrics.h"
+
+#include <QDateTime>
+#include <QMetaEnum>
+#include <QSaveFile>
+#include <QtAlgorithms>
+#include <cmath>
+
+#include "sessionformat.h"
+
+using namespace Qt::StringLiterals;
+
+// The SerialPortError values this Qt version still has, without NoError
+static const QList<int> &serialErrorTypes() {
+    static const QList<int> result = []() {
+        const QMetaEnum errors = QMetaEnum::fromType<QSerialPort::SerialPortError>();
+        QList<int>      types;
+        for (int i = QSerialPort::NoError + 1; i < SerialWorker::kSerialErrorTypes; i++) {
+            if (errors.valueToKey(i) != nullptr) types.append(i);
+        }
+        return types;
+    }();
+    return result;
+}
+
+// Counters may be reset from the GUI between two samples
+static quint64 counterDelta(quint64 now, quint64 last) {
+    return (now >= last) ? now - last : now;
+}
+
+void LatencyHistogram::record(qint64 ns) {
+    const quint64 us = quint64(qMax<qint64>(ns, 0)) / 1000;
+    int           index;
+    if (us < kSubBuckets) {
+        index = int(us);
+    } else {
+        // The three bits below the leading one pick the bucket within its power of two
+        const int msb = 63 - qCountLeadingZeroBits(us);
+        index         = (msb - 2) * kSubBuckets + int((us >> (msb - 3)) & (kSubBuckets - 1));
+    }
+    m_buckets[qMin(index, kBuckets - 1)]++;
+    m_count++;
+    m_maxNs = qMax(m_maxNs, ns);
+}
+
+void LatencyHistogram::clear() {
+    m_buckets.fill(0);
+    m_count = 0;
+    m_maxNs = 0;
+}
+
+qint64 LatencyHistogram::percentileNs(double fraction) const {
+    if (m_count == 0) return 0;
+
+    const quint64 target = qMax<quint64>(1, quint64(std::ceil(fraction * double(m_count))));
+    quint64       seen   = 0;
+    for (int i = 0; i < kBuckets; i++) {
+        seen += m_buckets[i];
+        if (seen < target) continue;
+
+        const int octave = i / kSubBuckets;
+        const int sub    = i % kSubBuckets;
+        qint64    upperUs;
+        if (octave == 0) {
+            upperUs = sub + 1;
+        } else {
+            const int shift = octave - 1;
+            upperUs         = qint64(kSubBuckets + sub + 1) << shift;
+        }
+        return qMin(upperUs * 1000, m_maxNs);
+    }
+    return m_maxNs;
+}
+
+MetricsCollector::MetricsCollector(SerialWorker *worker, QObject *parent)
+    : QObject(parent), m_serialWorker(worker), m_sampleTimer(new QTimer(this)) {
+    connect(m_sampleTimer, &QTimer::timeout, this, &MetricsCollector::sample);
+    m_lastSampleNs = SessionFormat::monotonicNs();
+    m_sampleTimer->start(1000);
+}
+
+bool MetricsCollector::startExport(const QString &fileName, QString *errorString) {
+    stopExport();
+
+    if (fileName.endsWith(u".csv"_s, Qt::CaseInsensitive) == true) {
+        m_csvFile.setFileName(fileName);
+        if (m_csvFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text) == false) {
+            if (errorString != nullptr) *errorString = m_csvFile.errorString();
+            return false;
+        }
+        // Appending to an earlier soak run keeps its header
+        if (m_csvFile.size() == 0) m_csvFile.write(csvHeader().toUtf8());
+        m_csvFile.flush();
+    }
+    m_exportFileName = fileName;
+    writeExport();
+    return true;
+}
+
+void MetricsCollector::stopExport() {
+    m_csvFile.close();
+    m_exportFileName.clear();
+}
+
+void MetricsCollector::sample() {
+    const qint64          nowNs = SessionFormat::monotonicNs();
+    const double          dt    = qMax(1e-3, double(nowNs - m_lastSampleNs) / 1e9);
+    const MetricsSnapshot last  = m_snapshot;
+    m_lastSampleNs              = nowNs;
+
+    MetricsSnapshot &s = m_snapshot;
+    s.realtimeMs       = QDateTime::currentMSecsSinceEpoch();
+    s.interval_s       = dt;
+    s.rxBytes          = m_serialWorker->bytesReceived();
+    s.rxFrames         = m_serialWorker->packetsReceived();
+    s.txBytes          = m_serialWorker->bytesWritten();
+    s.txFrames         = m_serialWorker->packetsWritten();
+    s.frameErrors      = m_serialWorker->frameErrors();
+    s.uiDropped        = m_uiDropped;
+    s.rxQueueDepth     = m_serialWorker->queueDepth();
+    s.rxBacklogDepth   = m_serialWorker->backlogDepth();
+    s.txQueueBytes     = m_serialWorker->bytesToWrite();
+    for (int i = 0; i < SerialWorker::kSerialErrorTypes; i++) {
+        s.serialErrors[i] = m_serialWorker->serialErrors(QSerialPort::SerialPortError(i));
+    }
+
+    s.rxBytesPerSecond  = double(counterDelta(s.rxBytes, last.rxBytes)) / dt;
+    s.rxFramesPerSecond = double(counterDelta(s.rxFrames, last.rxFrames)) / dt;
+    s.txBytesPerSecond  = double(counterDelta(s.txBytes, last.txBytes)) / dt;
+    s.txFramesPerSecond = double(counterDelta(s.txFrames, last.txFrames)) / dt;
+
+    s.latencySamples = m_latency.count();
+    s.latencyP50_ms  = double(m_latency.percentileNs(0.50)) / 1e6;
+    s.latencyP99_ms  = double(m_latency.percentileNs(0.99)) / 1e6;
+    m_latency.clear();
+
+    writeExport();
+    emit updated();
+}
+
+void MetricsCollector::writeExport() {
+    if (m_exportFileName.isEmpty() == true) return;
+
+    if (m_csvFile.isOpen() == true) {
+        m_csvFile.write(toCsvRow(m_snapshot, m_portName).toUtf8());
+        m_csvFile.flush();
+        return;
+    }
+
+    // Replaced in one go, a scraper never sees half a file
+    QSaveFile file(m_exportFileName);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Text) == false) return;
+    file.write(toPrometheus(m_snapshot, m_portName).toUtf8());
+    file.commit();
+}
+
+QString MetricsCollector::serialErrorName(int error) {
+    const char *key = QMetaEnum::fromType<QSerialPort::SerialPortError>().valueToKey(error);
+    return (key != nullptr) ? QString::fromLatin1(key) : QString::number(error);
+}
+
+QString MetricsCollector::csvHeader() {
+    QString header = u"time,port,rx_bytes_per_s,rx_frames_per_s,tx_bytes_per_s,tx_frames_per_s,"
+                     u"rx_bytes,rx_frames,tx_bytes,tx_frames,frame_errors,ui_dropped,"
+                     u"rx_queue,rx_backlog,tx_queue_bytes,latency_samples,latency_p50_ms,latency_p99_ms"_s;
+    for (const int error : serialErrorTypes()) header += u',' + serialErrorName(error);
+    return header + u'\n';
+}
+
+QString MetricsCollector::toCsvRow(const MetricsSnapshot &s, const QString &portName) {
+    QString row = QDateTime::fromMSecsSinceEpoch(s.realtimeMs).toString(Qt::ISODateWithMs);
+    row += u',' + portName;
+    for (const double value : {s.rxBytesPerSecond, s.rxFramesPerSecond, s.txBytesPerSecond, s.txFramesPerSecond}) {
+        row += u',' + QString::number(value, 'f', 1);
+    }
+    for (const quint64 value : {s.rxBytes, s.rxFrames, s.txBytes, s.txFrames, s.frameErrors, s.uiDropped,
+                                s.rxQueueDepth, s.rxBacklogDepth, s.txQueueBytes, s.latencySamples}) {
+        row += u',' + QString::number(value);
+    }
+    row += u',' + QString::number(s.latencyP50_ms, 'f', 3);
+    row += u',' + QString::number(s.latencyP99_ms, 'f', 3);
+    for (const int error : serialErrorTypes()) row += u',' + QString::number(s.serialErrors[error]);
+    return row + u'\n';
+}
+
+QString MetricsCollector::toPrometheus(const MetricsSnapshot &s, const QString &portName) {
+    QString       text;
+    const QString port = u"port=\"%1\""_s.arg(portName);
+
+    const auto metric = [&](const char *name, const char *type, const char *help, const QString &value) {
+        text += u"# HELP comport_%1 %2\n# TYPE comport_%1 %3\n"_s.arg(QLatin1String(name), QLatin1String(help),
+                                                                      QLatin1String(type));
+        text += u"comport_%1{%2} %3\n"_s.arg(QLatin1String(name), port, value);
+    };
+    metric("rx_bytes_total", "counter", "Bytes received.", QString::number(s.rxBytes));
+    metric("rx_frames_total", "counter", "Frames received.", QString::number(s.rxFrames));
+    metric("tx_bytes_total", "counter", "Bytes accepted by the driver.", QString::number(s.txBytes));
+    metric("tx_frames_total", "counter", "Writes to the port.", QString::number(s.txFrames));
+    metric("frame_errors_total", "counter", "Frames dropped by the decoder.", QString::number(s.frameErrors));
+    metric("ui_dropped_total", "counter", "Received frames that were never displayed.", QString::number(s.uiDropped));
+    metric("rx_bytes_per_second", "gauge", "Receive rate, last interval.", QString::number(s.rxBytesPerSecond));
+    metric("rx_frames_per_second", "gauge", "Frame rate, last interval.", QString::number(s.rxFramesPerSecond));
+    metric("tx_bytes_per_second", "gauge", "Transmit rate, last interval.", QString::number(s.txBytesPerSecond));
+    metric("tx_frames_per_second", "gauge", "Write rate, last interval.", QString::number(s.txFramesPerSecond));
+    metric("rx_queue_depth", "gauge", "Frames waiting for the consumer.", QString::number(s.rxQueueDepth));
+    metric("rx_backlog_depth", "gauge", "Frames the queue had no room for.", QString::number(s.rxBacklogDepth));
+    metric("tx_queue_bytes", "gauge", "Bytes waiting to be written.", QString::number(s.txQueueBytes));
+
+    text += u"# HELP comport_serial_errors_total Serial port errors by type.\n"
+            u"# TYPE comport_serial_errors_total counter\n"_s;
+    for (const int error : serialErrorTypes()) {
+        text += u"comport_serial_errors_total{%1,error=\"%2\"} %3\n"_s.arg(port, serialErrorName(error))
+                    .arg(s.serialErrors[error]);
+    }
+
+    text += u"# HELP comport_rx_latency_seconds Receive to display latency over the last interval.\n"
+            u"# TYPE comport_rx_latency_seconds summary\n"_s;
+    text += u"comport_rx_latency_seconds{%1,quantile=\"0.5\"} %2\n"_s.arg(port).arg(s.latencyP50_ms / 1e3);
+    text += u"comport_rx_latency_seconds{%1,quantile=\"0.99\"} %2\n"_s.arg(port).arg(s.latencyP99_ms / 1e3);
+    text += u"comport_rx_latency_seconds_count{%1} %2\n"_s.arg(port).arg(s.latencySamples);
+    return text;
+}
@@ -0,0 +1,108 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QFile>
+#include <QObject>
+#include <QTimer>
+#include <array>
+
+#include "serialworker.h"
+
+// Log-linear latency histogram: 8 buckets per power of two microseconds, so a
+// percentile is exact to about 12 %. Recording is a couple of shifts, cheap
+// enough to be done for every displayed packet.
+class LatencyHistogram {
+   public:
+    void record(qint64 ns);
+    void clear();
+
+    quint64 count() const { return m_count; }
+    // Upper bound of the bucket holding the given fraction, 0 when empty
+    qint64 percentileNs(double fraction) const;
+
+   private:
+    static constexpr int kSubBuckets = 8;
+    static constexpr int kBuckets    = 32 * kSubBuckets;
+
+    std::array<quint64, kBuckets> m_buckets{};
+    quint64                       m_count = 0;
+    qint64                        m_maxNs = 0;
+};
+
+struct MetricsSnapshot {
+    qint64 realtimeMs = 0;  // wall clock when the sample was taken
+    double interval_s = 0;
+
+    double rxBytesPerSecond  = 0;
+    double rxFramesPerSecond = 0;
+    double txBytesPerSecond  = 0;
+    double txFramesPerSecond = 0;
+
+    quint64 rxBytes     = 0;
+    quint64 rxFrames    = 0;
+    quint64 txBytes     = 0;
+    quint64 txFrames    = 0;
+    quint64 frameErrors = 0;
+    quint64 uiDropped   = 0;  // packets taken from the worker but never shown
+
+    quint64 rxQueueDepth   = 0;  // packets waiting in the lock-free queue
+    quint64 rxBacklogDepth = 0;  // packets the queue had no room for
+    quint64 txQueueBytes   = 0;
+
+    // RX-to-display latency over the last interval
+    quint64 latencySamples = 0;
+    double  latencyP50_ms  = 0;
+    double  latencyP99_ms  = 0;
+
+    std::array<quint64, SerialWorker::kSerialErrorTypes> serialErrors{};
+};
+
+// Samples the counters of one worker at a fixed rate, independent of the packet
+// rate, and optionally writes every sample to a file for soak tests: a *.csv
+// file gets one row per sample appended, anything else is rewritten in the
+// Prometheus text format, as read by the node_exporter textfile collector.
+class MetricsCollector : public QObject {
+    Q_OBJECT
+
+   public:
+    explicit MetricsCollector(SerialWorker *worker, QObject *parent = nullptr);
+
+    void setPortName(const QString &name) { m_portName = name; }
+    void setInterval(int ms) { m_sampleTimer->setInterval(ms); }
+
+    // Called by whoever drains the worker, in the collector's thread
+    void recordLatency(qint64 latencyNs) { m_latency.record(latencyNs); }
+    void recordDropped(quint64 count) { m_uiDropped += count; }
+
+    bool    startExport(const QString &fileName, QString *errorString = nullptr);
+    void    stopExport();
+    QString exportFileName() const { return m_exportFileName; }
+
+    const MetricsSnapshot &snapshot() const { return m_snapshot; }
+
+    static QString serialErrorName(int error);
+    static QString csvHeader();
+    static QString toCsvRow(const MetricsSnapshot &snapshot, const QString &portName);
+    static QString toPrometheus(const MetricsSnapshot &snapshot, const QString &portName);
+
+   signals:
+    void updated();
+
+   private slots:
+    void sample();
+
+   private:
+    void writeExport();
+
+    SerialWorker    *m_serialWorker;
+    QTimer          *m_sampleTimer = nullptr;
+    QString          m_portName;
+    LatencyHistogram m_latency;
+    MetricsSnapshot  m_snapshot;
+    quint64          m_uiDropped    = 0;
+    qint64           m_lastSampleNs = 0;
+    QString          m_exportFileName;
+    QFile            m_csvFile;
+};
+
+#endif  // METRICS_H
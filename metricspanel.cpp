@@ -0,0 +1,115 @@
+#include "metricspanel.h"
+
+#include <QDir>
+#include <QFileDialog>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QMessageBox>
+#include <QVBoxLayout>
+
+using namespace Qt::StringLiterals;
+
+static QString rateString(double bytesPerSecond, double framesPerSecond) {
+    return QObject::tr("%1 KB/s, %2 frames/s").arg(bytesPerSecond / 1024.0, 0, 'f', 1).arg(framesPerSecond, 0, 'f', 1);
+}
+
+MetricsPanel::MetricsPanel(MetricsCollector *collector, QWidget *parent)
+    : QWidget(parent, Qt::Window), m_collector(collector) {
+    setWindowTitle(tr("Metrics"));
+
+    m_rxLabel           = new QLabel(this);
+    m_txLabel           = new QLabel(this);
+    m_queueLabel        = new QLabel(this);
+    m_latencyLabel      = new QLabel(this);
+    m_droppedLabel      = new QLabel(this);
+    m_serialErrorsLabel = new QLabel(this);
+    m_exportLabel       = new QLabel(this);
+    m_exportPushButton  = new QPushButton(this);
+
+    for (QLabel *label : {m_rxLabel, m_txLabel, m_queueLabel, m_latencyLabel, m_droppedLabel, m_serialErrorsLabel}) {
+        label->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    }
+    m_serialErrorsLabel->setWordWrap(true);
+
+    auto *formLayout = new QFormLayout;
+    formLayout->addRow(tr("RX"), m_rxLabel);
+    formLayout->addRow(tr("TX"), m_txLabel);
+    formLayout->addRow(tr("Queues"), m_queueLabel);
+    formLayout->addRow(tr("RX to display"), m_latencyLabel);
+    formLayout->addRow(tr("Not displayed"), m_droppedLabel);
+    formLayout->addRow(tr("Serial errors"), m_serialErrorsLabel);
+
+    auto *exportLayout = new QHBoxLayout;
+    exportLayout->addWidget(m_exportLabel, 1);
+    exportLayout->addWidget(m_exportPushButton);
+
+    auto *layout = new QVBoxLayout(this);
+    layout->addLayout(formLayout);
+    layout->addStretch(1);
+    layout->addLayout(exportLayout);
+
+    connect(m_collector, &MetricsCollector::updated, this, &MetricsPanel::updateMetrics);
+    connect(m_exportPushButton, &QPushButton::clicked, this, &MetricsPanel::exportButton_clicked);
+    updateMetrics();
+    updateExportState();
+}
+
+void MetricsPanel::updateMetrics() {
+    const MetricsSnapshot &s = m_collector->snapshot();
+
+    m_rxLabel->setText(tr("%1, %2 frames, %3 bytes, %4 frame errors")
+                           .arg(rateString(s.rxBytesPerSecond, s.rxFramesPerSecond))
+                           .arg(s.rxFrames)
+                           .arg(s.rxBytes)
+                           .arg(s.frameErrors));
+    m_txLabel->setText(tr("%1, %2 writes, %3 bytes")
+                           .arg(rateString(s.txBytesPerSecond, s.txFramesPerSecond))
+                           .arg(s.txFrames)
+                           .arg(s.txBytes));
+    m_queueLabel->setText(tr("RX %1 queued, %2 in backlog, TX %3 bytes pending")
+                              .arg(s.rxQueueDepth)
+                              .arg(s.rxBacklogDepth)
+                              .arg(s.txQueueBytes));
+    m_latencyLabel->setText((s.latencySamples == 0) ? tr("no frames displayed")
+                                                    : tr("p50 %1 ms, p99 %2 ms over %3 frames")
+                                                          .arg(s.latencyP50_ms, 0, 'f', 3)
+                                                          .arg(s.latencyP99_ms, 0, 'f', 3)
+                                                          .arg(s.latencySamples));
+    m_droppedLabel->setText(QString::number(s.uiDropped));
+
+    QStringList errors;
+    for (int i = QSerialPort::NoError + 1; i < SerialWorker::kSerialErrorTypes; i++) {
+        if (s.serialErrors[i] == 0) continue;
+        errors.append(u"%1 %2"_s.arg(MetricsCollector::serialErrorName(i)).arg(s.serialErrors[i]));
+    }
+    m_serialErrorsLabel->setText((errors.isEmpty() == true) ? tr("none") : errors.join(u", "_s));
+}
+
+void MetricsPanel::exportButton_clicked() {
+    if (m_collector->exportFileName().isEmpty() == false) {
+        m_collector->stopExport();
+        updateExportState();
+        return;
+    }
+
+    const QString fileName = QFileDialog::getSaveFileName(this, tr("Export Metrics"), u"comport-metrics.csv"_s,
+                                                          tr("CSV, one row per second (*.csv);;"
+                                                             "Prometheus text file (*.prom)"));
+    if (fileName.isEmpty() == true) return;
+
+    QString errorString;
+    if (m_collector->startExport(fileName, &errorString) == false) {
+        QMessageBox::information(this, "Hint", tr("Unable to export to %1: %2").arg(fileName, errorString));
+    }
+    updateExportState();
+}
+
+void MetricsPanel::updateExportState() {
+    const QString fileName = m_collector->exportFileName();
+    if (fileName.isEmpty() == true) {
+        m_exportLabel->setText(tr("Not exporting"));
+    } else {
+        m_exportLabel->setText(tr("Exporting to %1").arg(QDir::toNativeSeparators(fileName)));
+    }
+    m_exportPushButton->setText((fileName.isEmpty() == true) ? tr("Export...") : tr("Stop Export"));
+}
@@ -0,0 +1,37 @@
+#ifndef METRICSPANEL_H
+#define METRICSPANEL_H
+
+#include <QLabel>
+#include <QPushButton>
+#include <QWidget>
+
+#include "metrics.h"
+
+// Window showing the samples of a MetricsCollector. It only repaints when the
+// collector takes a sample, so it costs the same at any packet rate.
+class MetricsPanel : public QWidget {
+    Q_OBJECT
+
+   public:
+    explicit MetricsPanel(MetricsCollector *collector, QWidget *parent = nullptr);
+
+   private slots:
+    void updateMetrics();
+    void exportButton_clicked();
+
+   private:
+    void updateExportState();
+
+    MetricsCollector *m_collector;
+
+    QLabel      *m_rxLabel           = nullptr;
+    QLabel      *m_txLabel           = nullptr;
+    QLabel      *m_queueLabel        = nullptr;
+    QLabel      *m_latencyLabel      = nullptr;
+    QLabel      *m_droppedLabel      = nullptr;
+    QLabel      *m_serialErrorsLabel = nullptr;
+    QLabel      *m_exportLabel       = nullptr;
+    QPushButton *m_exportPushButton  = nullptr;
+};
+
+#endif  // METRICSPANEL_H
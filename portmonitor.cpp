@@ -0,0 +1,101 @@
+#include "portmonitor.h"
+
+using namespace Qt::StringLiterals;
+
+// Device nodes come in bursts with their symlinks and permissions, one rescan after the burst
+static constexpr int kSettleDelay_ms = 250;
+
+// Where no file system events tell about new ports
+static constexpr int kPollInterval_ms = 2000;
+
+PortIdentity PortIdentity::of(const QSerialPortInfo &info) {
+    PortIdentity identity;
+    identity.portName     = info.portName();
+    identity.serialNumber = info.serialNumber();
+    identity.hasIds       = info.hasVendorIdentifier() && info.hasProductIdentifier();
+    identity.vendorId     = info.vendorIdentifier();
+    identity.productId    = info.productIdentifier();
+    return identity;
+}
+
+bool PortIdentity::matches(const QSerialPortInfo &info) const {
+    if (hasIds == false) return info.portName() == portName;
+    if (info.vendorIdentifier() != vendorId || info.productIdentifier() != productId) return false;
+    // Without a serial number two adapters of one kind are told apart by name only
+    return (serialNumber.isEmpty() == false) ? info.serialNumber() == serialNumber : info.portName() == portName;
+}
+
+PortMonitor::PortMonitor(QObject *parent)
+    : QObject(parent),
+      m_scanContext(new QObject),
+      m_watcher(new QFileSystemWatcher(this)),
+      m_settleTimer(new QTimer(this)) {
+    m_scanContext->moveToThread(&m_scanThread);
+    connect(&m_scanThread, &QThread::finished, m_scanContext, &QObject::deleteLater);
+    m_scanThread.setObjectName(u"PortMonitor"_s);
+    m_scanThread.start(QThread::LowPriority);
+
+    m_settleTimer->setSingleShot(true);
+    m_settleTimer->setInterval(kSettleDelay_ms);
+    connect(m_settleTimer, &QTimer::timeout, this, &PortMonitor::refresh);
+
+#ifdef Q_OS_LINUX
+    // inotify on the directory, a device node appearing or going away restarts the settle delay
+    m_watcher->addPath(u"/dev"_s);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, m_settleTimer, qOverload<>(&QTimer::start));
+#else
+    m_pollTimer = new QTimer(this);
+    connect(m_pollTimer, &QTimer::timeout, this, &PortMonitor::refresh);
+    m_pollTimer->start(kPollInterval_ms);
+#endif
+
+    refresh();
+}
+
+PortMonitor::~PortMonitor() {
+    // A scan in progress finishes first, its result is dropped with this object
+    m_scanThread.quit();
+    m_scanThread.wait();
+}
+
+QString PortMonitor::find(const PortIdentity &identity) const {
+    QString found;
+    for (const QSerialPortInfo &info : m_ports) {
+        if (identity.matches(info) == false) continue;
+        if (info.portName() == identity.portName) return info.portName();
+        if (found.isEmpty() == true) found = info.portName();
+    }
+    return found;
+}
+
+void PortMonitor::refresh() {
+    if (m_isScanning == true) {
+        m_isRescanPending = true;
+        return;
+    }
+    m_isScanning = true;
+
+    QMetaObject::invokeMethod(m_scanContext, [this]() {
+        const QList<QSerialPortInfo> ports = QSerialPortInfo::availablePorts();
+        QMetaObject::invokeMethod(this, [this, ports]() { scanFinished(ports); });
+    });
+}
+
+void PortMonitor::scanFinished(const QList<QSerialPortInfo> &ports) {
+    m_isScanning = false;
+
+    bool isChanged = (m_hasScanned == false) || (ports.size() != m_ports.size());
+    for (qsizetype i = 0; isChanged == false && i < ports.size(); i++) {
+        isChanged = (ports[i].portName() != m_ports[i].portName()) ||
+                    (ports[i].serialNumber() != m_ports[i].serialNumber()) ||
+                    (ports[i].description() != m_ports[i].description());
+    }
+    m_ports      = ports;
+    m_hasScanned = true;
+
+    if (isChanged == true) emit portsChanged();
+    if (m_isRescanPending == true) {
+        m_isRescanPending = false;
+        refresh();
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef PORTMONITOR_H
+#define PORTMONITOR_H
+
+#include <QFileSystemWatcher>
+#include <QList>
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QtSerialPort/QSerialPortInfo>
+
+// What a port is recognised by when it comes back, possibly under another name.
+// USB adapters are matched by serial number and VID:PID, anything else by name.
+struct PortIdentity {
+    QString portName;
+    QString serialNumber;
+    quint16 vendorId  = 0;
+    quint16 productId = 0;
+    bool    hasIds    = false;
+
+    static PortIdentity of(const QSerialPortInfo &info);
+    bool                matches(const QSerialPortInfo &info) const;
+};
+
+// Keeps the list of serial ports current without ever enumerating in the
+// caller's thread: enumeration can take a good part of a second with some
+// drivers and runs in a thread of its own. On Linux a rescan is started by
+// inotify events on /dev, elsewhere the list is polled.
+class PortMonitor : public QObject {
+    Q_OBJECT
+
+   public:
+    explicit PortMonitor(QObject *parent = nullptr);
+    ~PortMonitor();
+
+    const QList<QSerialPortInfo> &ports() const { return m_ports; }
+    bool                          hasScanned() const { return m_hasScanned; }
+
+    // Name of the listed port with the identity, the one with the same name first; empty when none
+    QString find(const PortIdentity &identity) const;
+
+   public slots:
+    // Coalesced: a request while a scan is running starts one more once it is done
+    void refresh();
+
+   signals:
+    void portsChanged();
+
+   private:
+    void scanFinished(const QList<QSerialPortInfo> &ports);
+
+    QThread             m_scanThread;
+    QObject            *m_scanContext = nullptr;  // lives in m_scanThread
+    QFileSystemWatcher *m_watcher     = nullptr;
+    QTimer             *m_settleTimer = nullptr;
+    QTimer             *m_pollTimer   = nullptr;  // where there is no watcher
+
+    QList<QSerialPortInfo> m_ports;
+    bool                   m_hasScanned      = false;
+    bool                   m_isScanning      = false;
+    bool                   m_isRescanPending = false;
+};
+
+#endif  // PORTMONITOR_H
@@ -0,0 +1,95 @@
+#include "portreconnector.h"
+
+// A listed port may still refuse to open for a moment, until udev has set its permissions
+static constexpr int kRetryInterval_ms = 500;
+
+PortReconnector::PortReconnector(SerialWorker *worker, PortMonitor *monitor, QObject *parent)
+    : QObject(parent), m_worker(worker), m_monitor(monitor), m_retryTimer(new QTimer(this)) {
+    m_retryTimer->setInterval(kRetryInterval_ms);
+
+    connect(m_retryTimer, &QTimer::timeout, this, &PortReconnector::tryReopen);
+    connect(m_worker, &SerialWorker::errorOccurred, this, &PortReconnector::serialError);
+    connect(m_monitor, &PortMonitor::portsChanged, this, &PortReconnector::portsChanged);
+}
+
+void PortReconnector::setEnabled(bool isEnabled) {
+    m_isEnabled = isEnabled;
+    if (m_isEnabled == false && m_isReconnecting == true) {
+        stopReconnecting();
+        emit gaveUp(m_identity.portName);
+    }
+}
+
+void PortReconnector::watch(const QString &portName) {
+    m_identity          = PortIdentity();
+    m_identity.portName = portName;
+    m_isWatching        = true;
+    stopReconnecting();
+    portsChanged();
+}
+
+void PortReconnector::unwatch() {
+    m_isWatching = false;
+    stopReconnecting();
+}
+
+void PortReconnector::serialError(QSerialPort::SerialPortError error) {
+    // A vanished device shows up as a resource error, once or several times
+    if (error != QSerialPort::ResourceError) return;
+    if (m_isEnabled == false || m_isWatching == false || m_isReconnecting == true) return;
+
+    // Closing hands over what was read before the device went away
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker]() { worker->close(); });
+    m_isReconnecting = true;
+    m_downtime.start();
+    m_retryTimer->start();
+    m_monitor->refresh();
+    emit connectionLost(m_identity.portName);
+}
+
+void PortReconnector::portsChanged() {
+    if (m_isReconnecting == true) {
+        tryReopen();
+        return;
+    }
+
+    // The identity is taken from the list the port was opened from, as soon as it has the port
+    if (m_isWatching == true && m_identity.hasIds == false) {
+        for (const QSerialPortInfo &info : m_monitor->ports()) {
+            if (info.portName() == m_identity.portName) m_identity = PortIdentity::of(info);
+        }
+    }
+}
+
+void PortReconnector::tryReopen() {
+    if (m_isReconnecting == false) return;
+
+    if (m_downtime.elapsed() > m_timeout_ms) {
+        stopReconnecting();
+        emit gaveUp(m_identity.portName);
+        return;
+    }
+
+    const QString portName = m_monitor->find(m_identity);
+    if (portName.isEmpty() == true) return;
+
+    bool isOpen = false;
+    QMetaObject::invokeMethod(
+        m_worker,
+        [this, &portName, &isOpen]() {
+            SerialSettings settings = m_worker->settings();
+            settings.portName       = portName;
+            isOpen                  = m_worker->open(settings);
+        },
+        Qt::BlockingQueuedConnection);
+    if (isOpen == false) return;
+
+    m_identity.portName = portName;
+    stopReconnecting();
+    emit reconnected(portName, m_downtime.elapsed());
+}
+
+void PortReconnector::stopReconnecting() {
+    m_isReconnecting = false;
+    m_retryTimer->stop();
+}
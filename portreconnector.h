@@ -0,0 +1,56 @@
+#ifndef PORTRECONNECTOR_H
+#define PORTRECONNECTOR_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+#include "portmonitor.h"
+#include "serialworker.h"
+
+// Reopens a port whose device went away, as soon as a port with the same
+// identity is listed again, with the settings it had. The worker only closes
+// the port in between: its counters, packet queue and recording carry on, so
+// nothing captured before the loss is dropped. Gives up after a timeout.
+// Lives in the GUI thread, next to the monitor.
+class PortReconnector : public QObject {
+    Q_OBJECT
+
+   public:
+    static constexpr int kDefaultTimeout_ms = 30 * 1000;
+
+    PortReconnector(SerialWorker *worker, PortMonitor *monitor, QObject *parent = nullptr);
+
+    void setEnabled(bool isEnabled);
+    bool isEnabled() const { return m_isEnabled; }
+    void setTimeout(int ms) { m_timeout_ms = ms; }
+    bool isReconnecting() const { return m_isReconnecting; }
+
+    // The port was opened or closed on purpose
+    void watch(const QString &portName);
+    void unwatch();
+
+   signals:
+    void connectionLost(const QString &portName);
+    void reconnected(const QString &portName, qint64 downtime_ms);
+    void gaveUp(const QString &portName);
+
+   private:
+    void serialError(QSerialPort::SerialPortError error);
+    void portsChanged();
+    void tryReopen();
+    void stopReconnecting();
+
+    SerialWorker *m_worker;
+    PortMonitor  *m_monitor;
+    QTimer       *m_retryTimer = nullptr;
+
+    PortIdentity  m_identity;
+    QElapsedTimer m_downtime;
+    int           m_timeout_ms     = kDefaultTimeout_ms;
+    bool          m_isEnabled      = false;
+    bool          m_isWatching     = false;
+    bool          m_isReconnecting = false;
+};
+
+#endif  // PORTRECONNECTOR_H
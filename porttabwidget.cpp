@@ -0,0 +1,90 @@
+#include "porttabwidget.h"
+
+#include <QToolButton>
+
+#include "comparewindow.h"
+#include "widget.h"
+
+PortTabWidget::PortTabWidget(QWidget *parent)
+    : QTabWidget(parent), m_manager(new SerialSessionManager(this)), m_statsTimer(new QTimer(this)) {
+    setWindowTitle("Serial Port Exercise");
+    setTabsClosable(true);
+    setMovable(true);
+    setDocumentMode(true);
+
+    auto *addButton = new QToolButton(this);
+    addButton->setText("+");
+    addButton->setToolTip(tr("Open another port in a new tab"));
+    addButton->setAutoRaise(true);
+    setCornerWidget(addButton, Qt::TopRightCorner);
+
+    auto *compareButton = new QToolButton(this);
+    compareButton->setText(tr("Compare"));
+    compareButton->setToolTip(tr("Compare what two ports or recorded sessions receive"));
+    compareButton->setAutoRaise(true);
+    setCornerWidget(compareButton, Qt::TopLeftCorner);
+
+    connect(addButton, &QToolButton::clicked, this, &PortTabWidget::addPort);
+    connect(compareButton, &QToolButton::clicked, this, &PortTabWidget::compareStreams);
+    connect(this, &QTabWidget::tabCloseRequested, this, &PortTabWidget::closePort);
+    connect(m_statsTimer, &QTimer::timeout, this, &PortTabWidget::updateStats);
+    m_statsTimer->start(1000);
+
+    addPort();
+}
+
+PortTabWidget::~PortTabWidget() {
+    // Tabs go first, their session viewers may still be replaying through the workers
+    while (count() > 0) delete widget(0);
+}
+
+Widget *PortTabWidget::addPort() {
+    SerialSession *session = m_manager->createSession();
+    auto          *port    = new Widget(session, m_manager->portMonitor());
+
+    const int index = addTab(port, session->name());
+    connect(session, &SerialSession::nameChanged, this, [this, port](const QString &name) {
+        const int index = indexOf(port);
+        if (index >= 0) setTabText(index, name);
+    });
+    setCurrentIndex(index);
+    resize(sizeHint().expandedTo(size()));
+    return port;
+}
+
+void PortTabWidget::closePort(int index) {
+    auto *port = qobject_cast<Widget *>(widget(index));
+    if (port == nullptr) return;
+
+    SerialSession *session = port->session();
+    removeTab(index);
+    delete port;
+    m_manager->removeSession(session);
+
+    if (count() == 0) addPort();
+}
+
+void PortTabWidget::compareStreams() {
+    // The ports open now, in tab order; tabs opened later are not offered
+    QList<Widget *> ports;
+    for (int index = 0; index < count(); index++) {
+        auto *port = qobject_cast<Widget *>(widget(index));
+        if (port != nullptr) ports.append(port);
+    }
+    auto *window = new CompareWindow(ports, this);
+    window->show();
+}
+
+void PortTabWidget::updateStats() {
+    for (int index = 0; index < count(); index++) {
+        auto *port = qobject_cast<Widget *>(widget(index));
+        if (port == nullptr) continue;
+
+        const SerialWorker *worker = port->session()->worker();
+        setTabToolTip(index, tr("RX %1 frames, %2 bytes, %3 errors\nTX %4 packets")
+                                 .arg(worker->packetsReceived())
+                                 .arg(worker->bytesReceived())
+                                 .arg(worker->frameErrors())
+                                 .arg(worker->packetsWritten()));
+    }
+}
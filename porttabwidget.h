@@ -0,0 +1,35 @@
+#ifndef PORTTABWIDGET_H
+#define PORTTABWIDGET_H
+
+#include <QTabWidget>
+#include <QTimer>
+
+#include "serialsessionmanager.h"
+
+class Widget;
+
+// Main window: one tab per serial session. The tab titles carry the port name
+// and a tooltip with its counters, refreshed once a second for every tab so
+// that background ports can be watched without switching to them. What two
+// tabs receive can be compared in a window of its own.
+class PortTabWidget : public QTabWidget {
+    Q_OBJECT
+
+   public:
+    explicit PortTabWidget(QWidget *parent = nullptr);
+    ~PortTabWidget();
+
+   public slots:
+    Widget *addPort();
+    void    closePort(int index);
+    void    compareStreams();
+
+   private slots:
+    void updateStats();
+
+   private:
+    SerialSessionManager *m_manager    = nullptr;
+    QTimer               *m_statsTimer = nullptr;
+};
+
+#endif  // PORTTABWIDGET_H
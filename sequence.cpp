@@ -0,0 +1,173 @@
+#include "sequence.h"
+
+#include <QFile>
+#include <QObject>
+
+StreamMatcher::StreamMatcher(const QByteArray &pattern) : m_pattern(pattern), m_failure(std::size_t(pattern.size()), 0) {
+    for (qsizetype i = 1, k = 0; i < pattern.size(); i++) {
+        while (k > 0 && pattern.at(i) != pattern.at(k)) k = m_failure[std::size_t(k - 1)];
+        if (pattern.at(i) == pattern.at(k)) k++;
+        m_failure[std::size_t(i)] = int(k);
+    }
+}
+
+qsizetype StreamMatcher::feed(QByteArrayView data) {
+    if (m_pattern.isEmpty() == true) return 0;
+
+    const char     *pattern = m_pattern.constData();
+    const qsizetype size    = m_pattern.size();
+    for (qsizetype i = 0; i < data.size(); i++) {
+        const char c = data.data()[i];
+        while (m_matched > 0 && pattern[m_matched] != c) m_matched = m_failure[std::size_t(m_matched - 1)];
+        if (pattern[m_matched] == c) m_matched++;
+        if (m_matched == size) {
+            m_matched = 0;
+            return i + 1;
+        }
+    }
+    return -1;
+}
+
+QByteArray Sequence::unescape(QByteArrayView text) {
+    QByteArray out;
+    out.reserve(text.size());
+    for (qsizetype i = 0; i < text.size(); i++) {
+        if (text.at(i) != '\\' || i + 1 == text.size()) {
+            out.append(text.at(i));
+            continue;
+        }
+        switch (text.at(++i)) {
+            case 'r':
+                out.append('\r');
+                break;
+            case 'n':
+                out.append('\n');
+                break;
+            case 't':
+                out.append('\t');
+                break;
+            case '0':
+                out.append('\0');
+                break;
+            case 'x':
+                out.append(QByteArray::fromHex(text.sliced(i + 1, qMin<qsizetype>(2, text.size() - i - 1)).toByteArray()));
+                i += qMin<qsizetype>(2, text.size() - i - 1);
+                break;
+            default:
+                out.append(text.at(i));
+                break;
+        }
+    }
+    return out;
+}
+
+// `"text"` or `hex 01 02`, followed by optional `timeout <ms>` when allowed
+static bool parsePayload(const QString &arguments, Sequence::Step &step, bool allowTimeout, QString *error) {
+    QString rest = arguments.trimmed();
+
+    if (rest.startsWith(u'"') == true) {
+        qsizetype end = 1;
+        while (end < rest.size() && rest.at(end) != u'"') end += (rest.at(end) == u'\\') ? 2 : 1;
+        if (end >= rest.size()) {
+            *error = QObject::tr("missing closing quote");
+            return false;
+        }
+        step.data = Sequence::unescape(rest.mid(1, end - 1).toUtf8());
+        rest      = rest.mid(end + 1).trimmed();
+    } else if (rest.startsWith(u"hex ") == true) {
+        QStringList tokens = rest.mid(4).split(u' ', Qt::SkipEmptyParts);
+        QByteArray  hex;
+        while (tokens.isEmpty() == false && tokens.first() != u"timeout") {
+            const QString token = tokens.takeFirst();
+            for (QChar c : token) {
+                if (c.isDigit() == false && QStringView(u"abcdefABCDEF").contains(c) == false) {
+                    *error = QObject::tr("'%1' is not hex").arg(token);
+                    return false;
+                }
+            }
+            hex += token.toLatin1();
+        }
+        if ((hex.size() % 2) != 0) {
+            *error = QObject::tr("odd number of hex digits");
+            return false;
+        }
+        step.data = QByteArray::fromHex(hex);
+        rest      = tokens.join(u' ');
+    } else {
+        *error = QObject::tr("expected a quoted string or hex bytes");
+        return false;
+    }
+
+    if (step.data.isEmpty() == true) {
+        *error = QObject::tr("empty payload");
+        return false;
+    }
+    if (rest.isEmpty() == true) return true;
+
+    const QStringList tokens = rest.split(u' ', Qt::SkipEmptyParts);
+    bool              isNumber = false;
+    if (allowTimeout == true && tokens.size() == 2 && tokens.at(0) == u"timeout") {
+        step.timeout_ms = tokens.at(1).toInt(&isNumber);
+        if (isNumber == true && step.timeout_ms > 0) return true;
+    }
+    *error = QObject::tr("unexpected '%1'").arg(rest);
+    return false;
+}
+
+bool Sequence::parse(const QString &text, Sequence &sequence, QString *errorString) {
+    sequence = Sequence();
+
+    const QStringList lines = text.split(u'\n');
+    for (qsizetype index = 0; index < lines.size(); index++) {
+        const QString line = lines.at(index).trimmed();
+        if (line.isEmpty() == true || line.startsWith(u'#') == true) continue;
+
+        const qsizetype space     = line.indexOf(u' ');
+        const QString   keyword   = line.left(space);
+        const QString   arguments = (space < 0) ? QString() : line.mid(space + 1);
+        QString         error;
+        bool            isNumber = false;
+
+        Step step;
+        step.line = int(index + 1);
+        step.text = line;
+        if (keyword == u"send") {
+            step.kind = Step::Send;
+            parsePayload(arguments, step, false, &error);
+        } else if (keyword == u"expect") {
+            step.kind = Step::Expect;
+            if (parsePayload(arguments, step, true, &error) == true) step.matcher = StreamMatcher(step.data);
+        } else if (keyword == u"wait") {
+            step.kind       = Step::Wait;
+            step.timeout_ms = arguments.trimmed().toInt(&isNumber);
+            if (isNumber == false || step.timeout_ms < 0) error = QObject::tr("expected a time in ms");
+        } else if (keyword == u"loop") {
+            sequence.loops = arguments.trimmed().toInt(&isNumber);
+            if (isNumber == false || sequence.loops < 0) error = QObject::tr("expected a loop count");
+            if (error.isEmpty() == true) continue;
+        } else {
+            error = QObject::tr("unknown command '%1'").arg(keyword);
+        }
+
+        if (error.isEmpty() == false) {
+            if (errorString != nullptr) *errorString = QObject::tr("line %1: %2").arg(index + 1).arg(error);
+            return false;
+        }
+        sequence.steps.push_back(std::move(step));
+    }
+
+    if (sequence.steps.empty() == true) {
+        if (errorString != nullptr) *errorString = QObject::tr("the sequence has no steps");
+        return false;
+    }
+    return true;
+}
+
+bool Sequence::load(const QString &fileName, Sequence &sequence, QString *errorString) {
+    QFile file(fileName);
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text) == false) {
+        if (errorString != nullptr) *errorString = file.errorString();
+        return false;
+    }
+    return parse(QString::fromUtf8(file.readAll()), sequence, errorString);
+}
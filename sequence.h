@@ -0,0 +1,62 @@
+#ifndef SEQUENCE_H
+#define SEQUENCE_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <vector>
+
+// Incremental search for one pattern in a byte stream that arrives in chunks.
+// The partial match is carried from chunk to chunk (Knuth-Morris-Pratt), so the
+// received data is scanned in place and never copied or rescanned.
+class StreamMatcher {
+   public:
+    StreamMatcher() = default;
+    explicit StreamMatcher(const QByteArray &pattern);
+
+    // Index just past the end of the match in `data`, or -1 when the pattern is
+    // not complete yet. The matcher starts over after a match.
+    qsizetype feed(QByteArrayView data);
+    void      reset() { m_matched = 0; }
+
+    const QByteArray &pattern() const { return m_pattern; }
+
+   private:
+    QByteArray       m_pattern;
+    std::vector<int> m_failure;  // longest proper prefix that is also a suffix of pattern[0..i]
+    int              m_matched = 0;
+};
+
+// A command sequence as read from a text file, one step per line:
+//
+//   # comment
+//   loop 100                      repeat the steps 100 times, 0 = until stopped
+//   send "AT+GMR\r\n"             C style escapes: \r \n \t \0 \\ \" \xHH
+//   send hex 41 54 0D 0A
+//   expect "OK" timeout 500       wait until the pattern shows up in the RX stream
+//   expect hex 06                 the timeout defaults to 1000 ms
+//   wait 20                       pause in ms
+//
+// Every payload is decoded and every pattern compiled while parsing, so the
+// runner only writes and scans.
+struct Sequence {
+    struct Step {
+        enum Kind { Send, Expect, Wait };
+
+        Kind          kind = Send;
+        QByteArray    data;  // Send payload or Expect pattern
+        StreamMatcher matcher;
+        int           timeout_ms = 1000;  // Expect timeout or Wait time
+        int           line       = 0;
+        QString       text;  // the line as written, for reports
+    };
+
+    std::vector<Step> steps;
+    int               loops = 1;
+
+    static bool       parse(const QString &text, Sequence &sequence, QString *errorString = nullptr);
+    static bool       load(const QString &fileName, Sequence &sequence, QString *errorString = nullptr);
+    static QByteArray unescape(QByteArrayView text);
+};
+
+#endif  // SEQUENCE_H
@@ -0,0 +1,137 @@
+#include "sequencerunner.h"
+
+#include <algorithm>
+
+#include "serialworker.h"
+#include "sessionformat.h"
+
+using namespace Qt::StringLiterals;
+using SessionFormat::monotonicNs;
+
+static QString roundTripReport(std::vector<qint64> &samplesNs) {
+    std::sort(samplesNs.begin(), samplesNs.end());
+    const auto percentile = [&samplesNs](double p) {
+        return double(samplesNs[std::size_t(p * double(samplesNs.size() - 1))]) / 1e6;
+    };
+    return QObject::tr("round trip p50 %1 ms, p90 %2 ms, p99 %3 ms, max %4 ms")
+        .arg(percentile(0.50), 0, 'f', 3)
+        .arg(percentile(0.90), 0, 'f', 3)
+        .arg(percentile(0.99), 0, 'f', 3)
+        .arg(double(samplesNs.back()) / 1e6, 0, 'f', 3);
+}
+
+SequenceRunner::SequenceRunner(SerialWorker *worker) : m_worker(worker), m_timer(new QTimer(this)) {
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+
+    connect(m_timer, &QTimer::timeout, this, &SequenceRunner::stepTimeout);
+    connect(m_worker, &SerialWorker::chunkReceived, this, &SequenceRunner::chunkReceived);
+}
+
+void SequenceRunner::start(const Sequence &sequence) {
+    m_sequence = sequence;
+    m_stats.assign(m_sequence.steps.size(), StepStats());
+    m_step        = 0;
+    m_loop        = 0;
+    m_startNs     = monotonicNs();
+    m_lastSendNs  = m_startNs;
+    m_isRunning   = true;
+    m_isExpecting = false;
+    advance();
+}
+
+void SequenceRunner::stop() {
+    if (m_isRunning == true) finish();
+}
+
+void SequenceRunner::advance() {
+    while (m_isRunning == true) {
+        if (m_step == m_sequence.steps.size()) {
+            m_step = 0;
+            m_loop++;
+            emit loopFinished(m_loop, m_sequence.loops);
+            if (m_sequence.loops != 0 && m_loop >= m_sequence.loops) {
+                finish();
+                return;
+            }
+            // Give the event loop a turn, a sequence without waits would otherwise never let go
+            QMetaObject::invokeMethod(this, &SequenceRunner::advance, Qt::QueuedConnection);
+            return;
+        }
+
+        Sequence::Step &step = m_sequence.steps[m_step];
+        switch (step.kind) {
+            case Sequence::Step::Send:
+                m_worker->write(step.data);
+                m_lastSendNs = monotonicNs();
+                m_step++;
+                break;
+            case Sequence::Step::Wait:
+                m_step++;
+                m_timer->start(step.timeout_ms);
+                return;
+            case Sequence::Step::Expect:
+                step.matcher.reset();
+                m_isExpecting = true;
+                m_timer->start(step.timeout_ms);
+                return;
+        }
+    }
+}
+
+void SequenceRunner::stepTimeout() {
+    if (m_isRunning == false) return;
+
+    // A timed out expect is counted and the sequence carries on with the next step
+    if (m_isExpecting == true) {
+        m_stats[m_step].timeouts++;
+        m_isExpecting = false;
+        m_step++;
+    }
+    advance();
+}
+
+void SequenceRunner::chunkReceived(const QByteArray &chunk, qint64 timestampNs) {
+    QByteArrayView rest(chunk);
+    while (m_isRunning == true && m_isExpecting == true) {
+        Sequence::Step &step = m_sequence.steps[m_step];
+        const qsizetype end  = step.matcher.feed(rest);
+        if (end < 0) return;
+
+        m_timer->stop();
+        m_stats[m_step].roundTripNs.push_back(timestampNs - m_lastSendNs);
+        m_isExpecting = false;
+        m_step++;
+        const qint64 sentNs = m_lastSendNs;
+        advance();
+
+        // The same chunk may already hold the answer to the next expect, unless a send came in between: what
+        // was read before that send cannot be its answer
+        if (m_lastSendNs != sentNs) return;
+        rest = rest.sliced(end);
+    }
+}
+
+void SequenceRunner::finish() {
+    m_timer->stop();
+    m_isRunning   = false;
+    m_isExpecting = false;
+
+    const double seconds = double(monotonicNs() - m_startNs) / 1e9;
+    QStringList  report;
+    report.append(tr("Sequence finished after %1 loops in %2 s").arg(m_loop).arg(seconds, 0, 'f', 3));
+    for (std::size_t i = 0; i < m_stats.size(); i++) {
+        const Sequence::Step &step = m_sequence.steps[i];
+        if (step.kind != Sequence::Step::Expect) continue;
+
+        StepStats &stats = m_stats[i];
+        QString    line  = tr("line %1 '%2': %3 matched, %4 timed out")
+                           .arg(step.line)
+                           .arg(step.text)
+                           .arg(stats.roundTripNs.size())
+                           .arg(stats.timeouts);
+        if (stats.roundTripNs.empty() == false) line += u", "_s + roundTripReport(stats.roundTripNs);
+        report.append(line);
+    }
+    emit finished(report);
+}
@@ -0,0 +1,58 @@
+#ifndef SEQUENCERUNNER_H
+#define SEQUENCERUNNER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <vector>
+
+#include "sequence.h"
+
+class SerialWorker;
+
+// Plays a Sequence against one serial worker. The runner lives in the worker's
+// thread: sends are written directly, received chunks are matched as they are
+// read, and the round trip of an expect is taken from the timestamp of the read
+// that completed it back to the preceding send.
+class SequenceRunner : public QObject {
+    Q_OBJECT
+
+   public:
+    explicit SequenceRunner(SerialWorker *worker);
+
+   public slots:
+    // Called in the worker thread
+    void start(const Sequence &sequence);
+    void stop();
+
+   signals:
+    void loopFinished(int loop, int loops);
+    void finished(const QStringList &report);
+
+   private slots:
+    void advance();
+    void stepTimeout();
+
+   private:
+    struct StepStats {
+        std::vector<qint64> roundTripNs;
+        quint64             timeouts = 0;
+    };
+
+    void chunkReceived(const QByteArray &chunk, qint64 timestampNs);
+    void finish();
+
+    SerialWorker *m_worker;
+    QTimer       *m_timer = nullptr;
+
+    Sequence               m_sequence;
+    std::vector<StepStats> m_stats;
+    std::size_t            m_step        = 0;
+    int                    m_loop        = 0;
+    qint64                 m_startNs     = 0;
+    qint64                 m_lastSendNs  = 0;
+    bool                   m_isRunning   = false;
+    bool                   m_isExpecting = false;
+};
+
+#endif  // SEQUENCERUNNER_H
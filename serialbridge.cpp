@@ -0,0 +1,295 @@
+#include "serialbridge.h"
+
+#include <QCryptographicHash>
+#include <algorithm>
+
+#include "serialworker.h"
+#include "sessionformat.h"
+
+using namespace Qt::StringLiterals;
+using SessionFormat::monotonicNs;
+
+// Chunks are handed to a socket while it has less than this waiting to go out
+static constexpr qint64 kSocketBuffer = 64 * 1024;
+
+// Client input is left unread while the port has this much waiting to go out
+static constexpr quint64 kMaxPortBacklog = 64 * 1024;
+
+// The client that wrote last has the port for this long after its last write
+static constexpr qint64 kWriterHoldNs = 1000LL * 1000 * 1000;
+
+// Larger WebSocket messages and handshakes close the connection
+static constexpr quint64   kMaxMessageSize   = 1024 * 1024;
+static constexpr qsizetype kMaxHandshakeSize = 8 * 1024;
+
+static constexpr char kWebSocketGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+// Unmasked, as a server sends them; returns the header size
+static int webSocketHeader(uchar opcode, quint64 length, char *header) {
+    header[0] = char(0x80 | opcode);  // final fragment
+    if (length < 126) {
+        header[1] = char(length);
+        return 2;
+    }
+    if (length <= 0xFFFF) {
+        header[1] = char(126);
+        header[2] = char(length >> 8);
+        header[3] = char(length);
+        return 4;
+    }
+    header[1] = char(127);
+    for (int i = 0; i < 8; i++) header[2 + i] = char(length >> (8 * (7 - i)));
+    return 10;
+}
+
+SerialBridge::SerialBridge(SerialWorker *worker)
+    : m_worker(worker), m_tcpServer(new QTcpServer(this)), m_webSocketServer(new QTcpServer(this)) {
+    connect(m_tcpServer, &QTcpServer::newConnection, this, [this]() { acceptClients(m_tcpServer, false); });
+    connect(m_webSocketServer, &QTcpServer::newConnection, this, [this]() { acceptClients(m_webSocketServer, true); });
+    connect(m_worker, &SerialWorker::chunkReceived, this, &SerialBridge::chunkReceived);
+    connect(m_worker, &SerialWorker::bytesAccepted, this, &SerialBridge::portDrained);
+}
+
+SerialBridge::~SerialBridge() {
+    stop();
+}
+
+bool SerialBridge::start(const Options &options, QString *errorString) {
+    stop();
+    m_options = options;
+
+    QTcpServer *failed = nullptr;
+    if (options.tcpPort != 0 && m_tcpServer->listen(options.address, options.tcpPort) == false) failed = m_tcpServer;
+    if (failed == nullptr && options.webSocketPort != 0 &&
+        m_webSocketServer->listen(options.address, options.webSocketPort) == false) {
+        failed = m_webSocketServer;
+    }
+    if (failed != nullptr) {
+        if (errorString != nullptr) *errorString = failed->errorString();
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void SerialBridge::stop() {
+    m_tcpServer->close();
+    m_webSocketServer->close();
+    for (const std::unique_ptr<Client> &client : m_clients) {
+        client->socket->disconnect(this);
+        client->socket->abort();
+        client->socket->deleteLater();
+    }
+    m_clients.clear();
+    m_writer   = nullptr;
+    m_isPaused = false;
+    if (m_clientCount.exchange(0, std::memory_order_relaxed) != 0) emit clientsChanged(0);
+}
+
+void SerialBridge::acceptClients(QTcpServer *server, bool isWebSocket) {
+    while (QTcpSocket *socket = server->nextPendingConnection()) {
+        auto client         = std::make_unique<Client>();
+        client->socket      = socket;
+        client->peer        = u"%1:%2"_s.arg(socket->peerAddress().toString()).arg(socket->peerPort());
+        client->isWebSocket = isWebSocket;
+        client->isOpen      = (isWebSocket == false);
+
+        // Unread input stays in the kernel, where it holds back the client
+        socket->setReadBufferSize(kSocketBuffer);
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            if (Client *client = find(socket)) readClient(*client);
+        });
+        connect(socket, &QTcpSocket::bytesWritten, this, [this, socket]() {
+            if (Client *client = find(socket)) pump(*client);
+        });
+        // Queued, so a client never goes away while it is being served
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() { removeClient(socket); },
+                Qt::QueuedConnection);
+
+        m_clients.push_back(std::move(client));
+    }
+    m_clientCount.store(int(m_clients.size()), std::memory_order_relaxed);
+    emit clientsChanged(int(m_clients.size()));
+}
+
+SerialBridge::Client *SerialBridge::find(QTcpSocket *socket) {
+    for (const std::unique_ptr<Client> &client : m_clients) {
+        if (client->socket == socket) return client.get();
+    }
+    return nullptr;
+}
+
+void SerialBridge::removeClient(QTcpSocket *socket) {
+    const auto it = std::find_if(m_clients.begin(), m_clients.end(),
+                                 [socket](const std::unique_ptr<Client> &client) { return client->socket == socket; });
+    if (it == m_clients.end()) return;
+
+    if (m_writer == socket) m_writer = nullptr;
+    socket->deleteLater();
+    m_clients.erase(it);
+    m_clientCount.store(int(m_clients.size()), std::memory_order_relaxed);
+    emit clientsChanged(int(m_clients.size()));
+}
+
+void SerialBridge::chunkReceived(const QByteArray &chunk) {
+    for (const std::unique_ptr<Client> &client : m_clients) {
+        if (client->isOpen == false) continue;
+
+        client->backlog.push_back(chunk);
+        client->backlogBytes += chunk.size();
+        pump(*client);
+        if (client->backlogBytes <= m_options.maxBacklog) {
+            client->isDropping = false;
+            continue;
+        }
+
+        if (m_options.policy == Disconnect) {
+            emit notice(tr("%1 fell behind and was disconnected").arg(client->peer));
+            client->isOpen = false;
+            client->socket->abort();
+            continue;
+        }
+        if (client->isDropping == false) emit notice(tr("%1 is falling behind, data is dropped").arg(client->peer));
+        client->isDropping = true;
+        while (client->backlogBytes > m_options.maxBacklog) {
+            client->backlogBytes -= client->backlog.front().size();
+            m_droppedBytes.fetch_add(quint64(client->backlog.front().size()), std::memory_order_relaxed);
+            client->backlog.pop_front();
+        }
+    }
+}
+
+void SerialBridge::pump(Client &client) {
+    while (client.backlog.empty() == false && client.socket->bytesToWrite() < kSocketBuffer) {
+        const QByteArray &chunk = client.backlog.front();
+        if (client.isWebSocket == true) {
+            char header[10];
+            client.socket->write(header, webSocketHeader(0x2, quint64(chunk.size()), header));
+        }
+        client.socket->write(chunk);
+        client.backlogBytes -= chunk.size();
+        client.backlog.pop_front();
+    }
+}
+
+void SerialBridge::readClient(Client &client) {
+    while (client.socket->bytesAvailable() > 0) {
+        if (m_worker->bytesToWrite() >= kMaxPortBacklog) {
+            m_isPaused = true;
+            return;
+        }
+
+        if (client.isWebSocket == false) {
+            writeToPort(client, client.socket->read(kSocketBuffer));
+            continue;
+        }
+
+        client.input.append(client.socket->read(kSocketBuffer));
+        const bool isValid = (client.isOpen == true) ? readFrames(client) : acceptHandshake(client);
+        if (isValid == false) {
+            client.socket->disconnectFromHost();
+            return;
+        }
+    }
+}
+
+bool SerialBridge::acceptHandshake(Client &client) {
+    const qsizetype end = client.input.indexOf("\r\n\r\n");
+    if (end < 0) return client.input.size() <= kMaxHandshakeSize;
+
+    QByteArray key;
+    for (const QByteArray &line : client.input.first(end).split('\n')) {
+        const qsizetype colon = line.indexOf(':');
+        if (colon > 0 && line.first(colon).trimmed().toLower() == "sec-websocket-key") {
+            key = line.mid(colon + 1).trimmed();
+        }
+    }
+    if (key.isEmpty() == true) {
+        client.socket->write("HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
+        return false;
+    }
+
+    const QByteArray accept = QCryptographicHash::hash(key + kWebSocketGuid, QCryptographicHash::Sha1).toBase64();
+    client.socket->write("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                         "Sec-WebSocket-Accept: " +
+                         accept + "\r\n\r\n");
+    client.input.remove(0, end + 4);
+    client.isOpen = true;
+    return readFrames(client);
+}
+
+bool SerialBridge::readFrames(Client &client) {
+    for (;;) {
+        const uchar    *d    = reinterpret_cast<const uchar *>(client.input.constData());
+        const qsizetype size = client.input.size();
+        if (size < 2) return true;
+
+        // Frames from a client are always masked
+        const uchar opcode   = d[0] & 0x0F;
+        const bool  isMasked = (d[1] & 0x80) != 0;
+        quint64     length   = d[1] & 0x7F;
+        qsizetype   pos      = 2;
+        if (length == 126) {
+            if (size < 4) return true;
+            length = (quint64(d[2]) << 8) | d[3];
+            pos    = 4;
+        } else if (length == 127) {
+            if (size < 10) return true;
+            length = 0;
+            for (int i = 0; i < 8; i++) length = (length << 8) | d[2 + i];
+            pos = 10;
+        }
+        if (isMasked == false || length > kMaxMessageSize) return false;
+        if (quint64(size - pos) < 4 + length) return true;
+
+        const uchar *mask = d + pos;
+        QByteArray   payload(client.input.constData() + pos + 4, qsizetype(length));
+        for (qsizetype i = 0; i < payload.size(); i++) payload[i] = char(payload[i] ^ mask[i % 4]);
+        client.input.remove(0, pos + 4 + qsizetype(length));
+
+        char header[10];
+        switch (opcode) {
+            case 0x0:  // continuation
+            case 0x1:  // text
+            case 0x2:  // binary
+                writeToPort(client, payload);
+                break;
+            case 0x8:  // close, echoed with its status code
+                payload.truncate(2);
+                client.socket->write(header, webSocketHeader(0x8, quint64(payload.size()), header));
+                client.socket->write(payload);
+                return false;
+            case 0x9:  // ping
+                client.socket->write(header, webSocketHeader(0xA, quint64(payload.size()), header));
+                client.socket->write(payload);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void SerialBridge::writeToPort(Client &client, const QByteArray &data) {
+    if (data.isEmpty() == true) return;
+
+    const qint64 nowNs = monotonicNs();
+    if (m_writer != nullptr && m_writer != client.socket && nowNs - m_lastWriteNs < kWriterHoldNs) {
+        m_refusedBytes.fetch_add(quint64(data.size()), std::memory_order_relaxed);
+        if (client.isRefused == false) emit notice(tr("%1 is not heard while another client writes").arg(client.peer));
+        client.isRefused = true;
+        return;
+    }
+
+    m_writer         = client.socket;
+    m_lastWriteNs    = nowNs;
+    client.isRefused = false;
+    m_worker->write(data);
+}
+
+void SerialBridge::portDrained() {
+    if (m_isPaused == false || m_worker->bytesToWrite() >= kMaxPortBacklog) return;
+
+    m_isPaused = false;
+    for (std::size_t i = 0; i < m_clients.size(); i++) readClient(*m_clients[i]);
+}
@@ -0,0 +1,106 @@
+#ifndef SERIALBRIDGE_H
+#define SERIALBRIDGE_H
+
+#include <QByteArray>
+#include <QHostAddress>
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+class SerialWorker;
+
+// Shares one serial worker with clients on the network: raw TCP, and WebSocket
+// with one binary message per received chunk. A received chunk goes to every
+// client as the same implicitly shared QByteArray, so a client's queue only
+// holds references and the one copy per client is the one into its socket,
+// made as the socket drains. A client whose queue outgrows maxBacklog loses its
+// oldest chunks or is disconnected, so a slow client never holds up the port or
+// the other clients. Writes are arbitrated: the client that wrote last has the
+// port until it has been quiet for a while, the others are not heard until
+// then. Client input is only read while the port keeps up, which holds back a
+// fast writer through TCP flow control. Lives in the worker's thread, like the
+// SequenceRunner.
+class SerialBridge : public QObject {
+    Q_OBJECT
+
+   public:
+    enum SlowClientPolicy {
+        DropOldest,  // the client misses data, raw TCP clients a stretch of the stream
+        Disconnect,
+    };
+
+    struct Options {
+        QHostAddress     address       = QHostAddress::Any;
+        quint16          tcpPort       = 0;  // 0 for none
+        quint16          webSocketPort = 0;  // 0 for none
+        qint64           maxBacklog    = 1024 * 1024;
+        SlowClientPolicy policy        = DropOldest;
+    };
+
+    explicit SerialBridge(SerialWorker *worker);
+    ~SerialBridge();
+
+    // Called from any thread
+    int     clientCount() const { return m_clientCount.load(std::memory_order_relaxed); }
+    quint64 droppedBytes() const { return m_droppedBytes.load(std::memory_order_relaxed); }
+    quint64 refusedBytes() const { return m_refusedBytes.load(std::memory_order_relaxed); }
+
+    // Called in the worker thread
+    bool    isListening() const { return m_tcpServer->isListening() || m_webSocketServer->isListening(); }
+    quint16 tcpPort() const { return m_tcpServer->serverPort(); }
+    quint16 webSocketPort() const { return m_webSocketServer->serverPort(); }
+
+   public slots:
+    // Called in the worker thread
+    bool start(const Options &options, QString *errorString = nullptr);
+    void stop();
+
+   signals:
+    void clientsChanged(int count);
+    // A client fell behind or was not heard
+    void notice(const QString &text);
+
+   private:
+    struct Client {
+        QTcpSocket            *socket = nullptr;
+        QString                peer;
+        bool                   isWebSocket = false;
+        bool                   isOpen      = false;  // WebSocket clients once the handshake is done
+        bool                   isDropping  = false;
+        bool                   isRefused   = false;
+        QByteArray             input;  // the handshake, or frames not complete yet
+        std::deque<QByteArray> backlog;
+        qint64                 backlogBytes = 0;
+    };
+
+    void    acceptClients(QTcpServer *server, bool isWebSocket);
+    Client *find(QTcpSocket *socket);
+    void    removeClient(QTcpSocket *socket);
+    void    chunkReceived(const QByteArray &chunk);
+    void    pump(Client &client);
+    void    readClient(Client &client);
+    bool    acceptHandshake(Client &client);
+    bool    readFrames(Client &client);
+    void    writeToPort(Client &client, const QByteArray &data);
+    void    portDrained();
+
+    SerialWorker *m_worker;
+    QTcpServer   *m_tcpServer       = nullptr;
+    QTcpServer   *m_webSocketServer = nullptr;
+
+    Options                              m_options;
+    std::vector<std::unique_ptr<Client>> m_clients;
+    QTcpSocket                          *m_writer      = nullptr;  // the client that has the port
+    qint64                               m_lastWriteNs = 0;
+    bool                                 m_isPaused    = false;  // client input waits for the port
+
+    std::atomic<int>     m_clientCount{0};
+    std::atomic<quint64> m_droppedBytes{0};
+    std::atomic<quint64> m_refusedBytes{0};
+};
+
+#endif  // SERIALBRIDGE_H
@@ -0,0 +1,12 @@
+#include "serialsession.h"
+
+SerialSession::SerialSession(SerialWorker *worker, QObject *parent)
+    : QObject(parent), m_worker(worker), m_logModel(new LogModel(this)), m_name(tr("New Port")) {
+}
+
+void SerialSession::setName(const QString &name) {
+    if (m_name == name) return;
+
+    m_name = name;
+    emit nameChanged(m_name);
+}
@@ -0,0 +1,35 @@
+#ifndef SERIALSESSION_H
+#define SERIALSESSION_H
+
+#include <QObject>
+#include <QString>
+
+#include "logmodel.h"
+#include "serialworker.h"
+
+// One port as the rest of the application sees it: the worker with its port,
+// settings, framer and counters, plus the log the port's tab displays. The
+// worker runs in one of the manager's pool threads and is released there by the
+// manager; the session itself and its log live in the GUI thread.
+class SerialSession : public QObject {
+    Q_OBJECT
+
+   public:
+    SerialSession(SerialWorker *worker, QObject *parent = nullptr);
+
+    SerialWorker *worker() const { return m_worker; }
+    LogModel     *logModel() const { return m_logModel; }
+
+    QString name() const { return m_name; }
+    void    setName(const QString &name);
+
+   signals:
+    void nameChanged(const QString &name);
+
+   private:
+    SerialWorker *m_worker   = nullptr;
+    LogModel     *m_logModel = nullptr;
+    QString       m_name;
+};
+
+#endif  // SERIALSESSION_H
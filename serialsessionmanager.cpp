@@ -0,0 +1,23 @@
+#include "serialsessionmanager.h"
+
+SerialSessionManager::SerialSessionManager(QObject *parent)
+    : QObject(parent), m_portMonitor(new PortMonitor(this)), m_pool(new SerialWorkerPool(this)) {}
+
+SerialSessionManager::~SerialSessionManager() {
+    // Sessions close their ports in the pool threads, so those must still be running
+    while (m_sessions.isEmpty() == false) removeSession(m_sessions.last());
+}
+
+SerialSession *SerialSessionManager::createSession() {
+    auto *session = new SerialSession(m_pool->createWorker(), this);
+    m_sessions.append(session);
+    return session;
+}
+
+void SerialSessionManager::removeSession(SerialSession *session) {
+    if (m_sessions.removeOne(session) == false) return;
+
+    SerialWorker *worker = session->worker();
+    delete session;
+    m_pool->releaseWorker(worker);
+}
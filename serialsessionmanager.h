@@ -0,0 +1,33 @@
+#ifndef SERIALSESSIONMANAGER_H
+#define SERIALSESSIONMANAGER_H
+
+#include <QList>
+#include <QObject>
+
+#include "portmonitor.h"
+#include "serialsession.h"
+#include "serialworkerpool.h"
+
+// Runs any number of serial sessions, their workers on a SerialWorkerPool.
+// The list of ports on the machine is kept by one monitor for all sessions.
+class SerialSessionManager : public QObject {
+    Q_OBJECT
+
+   public:
+    explicit SerialSessionManager(QObject *parent = nullptr);
+    ~SerialSessionManager();
+
+    SerialSession *createSession();
+    void           removeSession(SerialSession *session);
+
+    const QList<SerialSession *> &sessions() const { return m_sessions; }
+    int                           threadCount() const { return m_pool->threadCount(); }
+    PortMonitor                  *portMonitor() const { return m_portMonitor; }
+
+   private:
+    PortMonitor           *m_portMonitor = nullptr;
+    SerialWorkerPool      *m_pool        = nullptr;
+    QList<SerialSession *> m_sessions;
+};
+
+#endif  // SERIALSESSIONMANAGER_H
@@ -0,0 +1,79 @@
+#include "serialsettings.h"
+
+bool SerialSettings::parseLine(const QString &spec) {
+    const QStringList parts = spec.split(u',');
+    bool              isNumber = false;
+    const qint32      baudRate = parts.at(0).trimmed().toInt(&isNumber);
+    if (isNumber == false || baudRate <= 0 || parts.size() > 2) return false;
+
+    SerialSettings result = *this;
+    result.baudRate       = baudRate;
+    if (parts.size() == 2) {
+        const QString frame = parts.at(1).trimmed().toUpper();
+        if (frame.size() < 3 || frame.at(0) < u'5' || frame.at(0) > u'8') return false;
+        result.dataBits = QSerialPort::DataBits(frame.at(0).digitValue());
+
+        switch (frame.at(1).toLatin1()) {
+            case 'N':
+                result.parity = QSerialPort::NoParity;
+                break;
+            case 'E':
+                result.parity = QSerialPort::EvenParity;
+                break;
+            case 'O':
+                result.parity = QSerialPort::OddParity;
+                break;
+            case 'M':
+                result.parity = QSerialPort::MarkParity;
+                break;
+            case 'S':
+                result.parity = QSerialPort::SpaceParity;
+                break;
+            default:
+                return false;
+        }
+
+        const QString stopBits = frame.mid(2);
+        if (stopBits == u"1") {
+            result.stopBits = QSerialPort::OneStop;
+        } else if (stopBits == u"1.5") {
+            result.stopBits = QSerialPort::OneAndHalfStop;
+        } else if (stopBits == u"2") {
+            result.stopBits = QSerialPort::TwoStop;
+        } else {
+            return false;
+        }
+    }
+
+    *this = result;
+    return true;
+}
+
+bool SerialSettings::parseFlowControl(const QString &spec) {
+    if (spec == u"none") {
+        flowControl = QSerialPort::NoFlowControl;
+    } else if (spec == u"hw") {
+        flowControl = QSerialPort::HardwareControl;
+    } else if (spec == u"sw") {
+        flowControl = QSerialPort::SoftwareControl;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QString SerialSettings::lineString() const {
+    static const char parityLetters[] = {'N', '?', 'E', 'O', 'S', 'M'};  // indexed by QSerialPort::Parity
+    const QString     stopBitsText    = (stopBits == QSerialPort::OneAndHalfStop) ? QString("1.5") : QString::number(int(stopBits));
+    return QString("%1,%2%3%4")
+        .arg(baudRate)
+        .arg(int(dataBits))
+        .arg(QChar(parityLetters[qBound(0, int(parity), 5)]))
+        .arg(stopBitsText);
+}
+
+double SerialSettings::bytesPerSecond() const {
+    const double parityBits    = (parity == QSerialPort::NoParity) ? 0.0 : 1.0;
+    const double stopBitsCount = (stopBits == QSerialPort::OneAndHalfStop) ? 1.5 : double(int(stopBits));
+    return double(baudRate) / (1.0 + double(int(dataBits)) + parityBits + stopBitsCount);
+}
@@ -0,0 +1,26 @@
+#ifndef SERIALSETTINGS_H
+#define SERIALSETTINGS_H
+
+#include <QString>
+#include <QtSerialPort/QSerialPort>
+
+struct SerialSettings {
+    QString                  portName;
+    qint32                   baudRate    = 115200;
+    QSerialPort::DataBits    dataBits    = QSerialPort::Data8;
+    QSerialPort::StopBits    stopBits    = QSerialPort::OneStop;
+    QSerialPort::Parity      parity      = QSerialPort::NoParity;
+    QSerialPort::FlowControl flowControl = QSerialPort::NoFlowControl;
+
+    // "115200,8N1" style line settings, the baud rate alone keeps 8N1.
+    // Parity is one of N E O M S, stop bits are 1, 1.5 or 2.
+    bool    parseLine(const QString &spec);
+    // "none", "hw" (RTS/CTS) or "sw" (XON/XOFF)
+    bool    parseFlowControl(const QString &spec);
+    QString lineString() const;
+    // Payload bytes per second the line can carry at most: the baud rate over
+    // the start, data, parity and stop bits of a character
+    double  bytesPerSecond() const;
+};
+
+#endif  // SERIALSETTINGS_H
@@ -0,0 +1,244 @@
+#include "serialworker.h"
+
+#include <QDebug>
+#include <cstring>
+#include <utility>
+
+// Flush the receive buffer as one packet once it grows this large, so a
+// continuous stream without idle gaps is still drained and displayed.
+static constexpr qsizetype kMaxPacketSize = 4096;
+
+// Number of packets the GUI may lag behind before the worker starts to keep
+// them in its own backlog instead.
+static constexpr std::size_t kQueueCapacity = 4096;
+
+SerialWorker::SerialWorker(QObject *parent)
+    : QObject(parent),
+      m_serialPort(new QSerialPort(this)),
+      m_packetGapTimer(new QTimer(this)),
+      m_backlogTimer(new QTimer(this)),
+      m_queue(kQueueCapacity) {
+    // The packet gap timer is restarted by every read, it only fires once the line went idle
+    m_packetGapTimer->setSingleShot(true);
+    m_packetGapTimer->setTimerType(Qt::PreciseTimer);
+    m_backlogTimer->setInterval(10);
+    m_frameSink = [this](QByteArrayView frame) { deliverFrame(frame); };
+
+    connect(m_serialPort, &QSerialPort::readyRead, this, &SerialWorker::readSerialPort);
+    connect(m_serialPort, &QSerialPort::errorOccurred, this, [this](QSerialPort::SerialPortError error) {
+        if (error > QSerialPort::NoError && error < kSerialErrorTypes) {
+            m_serialErrors[error].fetch_add(1, std::memory_order_relaxed);
+        }
+        emit errorOccurred(error);
+    });
+    connect(m_serialPort, &QSerialPort::bytesWritten, this, [this](qint64 bytes) {
+        m_bytesWritten.fetch_add(quint64(bytes), std::memory_order_relaxed);
+        m_bytesToWrite.store(quint64(m_serialPort->bytesToWrite()), std::memory_order_relaxed);
+        emit bytesAccepted(bytes);
+    });
+    connect(m_packetGapTimer, &QTimer::timeout, this, &SerialWorker::flushPacket);
+    connect(m_backlogTimer, &QTimer::timeout, this, &SerialWorker::flushBacklog);
+    // A block the recorder could not write ends the recording, the file is closed in the worker thread
+    m_recorder.setErrorHandler([this](const QString &errorString) {
+        QMetaObject::invokeMethod(
+            this,
+            [this, errorString]() {
+                if (m_recorder.isRecording() == false || m_recorder.hasFailed() == false) return;
+                m_recorder.stop();
+                emit recordingFailed(m_recorder.fileName(), errorString);
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+bool SerialWorker::takePacket(SerialPacket &packet) {
+    return m_queue.tryPop(packet);
+}
+
+void SerialWorker::acknowledgePackets() {
+    // Must be called before draining, so a packet pushed during the drain raises a new notification
+    m_notifyPending.store(false, std::memory_order_release);
+}
+
+bool SerialWorker::open(const SerialSettings &settings) {
+    if (m_serialPort->isOpen() == true) return true;
+
+    m_serialPort->setPortName(settings.portName);
+    m_serialPort->setBaudRate(settings.baudRate);
+    m_serialPort->setDataBits(settings.dataBits);
+    m_serialPort->setStopBits(settings.stopBits);
+    m_serialPort->setParity(settings.parity);
+    m_serialPort->setFlowControl(settings.flowControl);
+
+    if (m_serialPort->open(QIODevice::ReadWrite) == false) return false;
+
+    if (m_serialPort->isDataTerminalReady() == false) {
+        m_serialPort->setDataTerminalReady(true);
+    }
+    m_settings = settings;
+    m_receiveBuffer.clear();
+    if (m_framer != nullptr) m_framer->reset();
+    recordSettings();
+    m_isOpen.store(true, std::memory_order_release);
+
+    qDebug("m_serialPort->portName() = %s", m_serialPort->portName().toStdString().c_str());
+    qDebug("m_serialPort->error() = 0x%d", m_serialPort->error());
+
+    qDebug("m_serialPort->isDataTerminalReady() = 0x%d", m_serialPort->isDataTerminalReady());
+    qDebug("m_serialPort->isBreakEnabled() = 0x%d", m_serialPort->isBreakEnabled());
+    qDebug("m_serialPort->isRequestToSend() = 0x%d", m_serialPort->isRequestToSend());
+    qDebug("m_serialPort->isSequential() = 0x%d", m_serialPort->isSequential());
+    qDebug("m_serialPort->isTextModeEnabled() = 0x%d", m_serialPort->isTextModeEnabled());
+    qDebug("m_serialPort->isOpen() = 0x%d", m_serialPort->isOpen());
+    qDebug("m_serialPort->isReadable() = 0x%d", m_serialPort->isReadable());
+    qDebug("m_serialPort->isWritable() = 0x%d", m_serialPort->isWritable());
+    return true;
+}
+
+void SerialWorker::close() {
+    if (m_serialPort->isOpen() == false) return;
+
+    // Drain the driver and hand over whatever arrived before the gap timer had a chance to fire
+    readSerialPort();
+    m_packetGapTimer->stop();
+    flushPacket();
+
+    m_serialPort->close();
+    m_bytesToWrite.store(0, std::memory_order_relaxed);
+    m_isOpen.store(false, std::memory_order_release);
+}
+
+SerialWriteTime SerialWorker::write(const QByteArray &data) {
+    if (m_serialPort->isOpen() == false) return SerialWriteTime();
+
+    SerialWriteTime time;
+    time.timestampNs = SessionFormat::monotonicNs();
+    time.realtimeNs  = SessionFormat::realtimeNs();
+    m_serialPort->write(data);
+    m_bytesToWrite.store(quint64(m_serialPort->bytesToWrite()), std::memory_order_relaxed);
+    m_recorder.record(SessionFormat::Transmitted, data, time.timestampNs);
+    emit chunkWritten(data, time.timestampNs, time.realtimeNs);
+    m_packetsWritten.fetch_add(1, std::memory_order_relaxed);
+    return time;
+}
+
+void SerialWorker::setPacketGap(int ms) {
+    m_packetGap_ms = ms;
+}
+
+void SerialWorker::setFraming(const Framer::Options &options) {
+    // Whatever was collected under the old framing is handed over as it is
+    m_packetGapTimer->stop();
+    flushPacket();
+    m_framer = Framer::create(options);
+}
+
+bool SerialWorker::startRecording(const QString &fileName, QString *errorString) {
+    if (m_recorder.start(fileName, errorString) == false) return false;
+
+    if (m_serialPort->isOpen() == true) recordSettings();
+    return true;
+}
+
+void SerialWorker::stopRecording() {
+    m_recorder.stop();
+}
+
+void SerialWorker::readSerialPort() {
+    const qint64     timestampNs = SessionFormat::monotonicNs();
+    const qint64     realtimeNs  = SessionFormat::realtimeNs();
+    const QByteArray chunk       = m_serialPort->readAll();
+    if (chunk.isEmpty() == true) return;
+
+    m_lastReadNs         = timestampNs;
+    m_lastReadRealtimeNs = realtimeNs;
+    m_recorder.record(SessionFormat::Received, chunk, timestampNs);
+    emit chunkReceived(chunk, timestampNs);
+
+    if (m_framer != nullptr) {
+        const quint64 errors = m_framer->stats().errors;
+        m_framer->feed(chunk, m_frameSink);
+        if (m_framer->stats().errors != errors) {
+            m_frameErrors.fetch_add(m_framer->stats().errors - errors, std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    m_receiveBuffer.append(chunk);
+
+    if ((m_packetGap_ms == 0) || (m_receiveBuffer.size() >= kMaxPacketSize)) {
+        m_packetGapTimer->stop();
+        flushPacket();
+    } else {
+        m_packetGapTimer->start(m_packetGap_ms);
+    }
+}
+
+void SerialWorker::flushPacket() {
+    if (m_receiveBuffer.isEmpty() == true) return;
+
+    SerialPacket packet;
+    packet.data        = std::exchange(m_receiveBuffer, QByteArray());
+    packet.timestampNs = m_lastReadNs;
+    packet.realtimeNs  = m_lastReadRealtimeNs;
+    m_packetsReceived.fetch_add(1, std::memory_order_relaxed);
+    m_bytesReceived.fetch_add(quint64(packet.data.size()), std::memory_order_relaxed);
+    enqueue(std::move(packet));
+}
+
+void SerialWorker::deliverFrame(QByteArrayView frame) {
+    // The only copy on the way from the port to the GUI, the view dies with the call
+    SerialPacket packet;
+    packet.data        = frame.toByteArray();
+    packet.timestampNs = m_lastReadNs;
+    packet.realtimeNs  = m_lastReadRealtimeNs;
+    m_packetsReceived.fetch_add(1, std::memory_order_relaxed);
+    m_bytesReceived.fetch_add(quint64(frame.size()), std::memory_order_relaxed);
+    enqueue(std::move(packet));
+}
+
+void SerialWorker::flushBacklog() {
+    bool moved = false;
+    while (m_backlog.empty() == false) {
+        if (m_queue.tryPush(std::move(m_backlog.front())) == false) break;
+        m_backlog.pop_front();
+        moved = true;
+    }
+    m_backlogDepth.store(quint64(m_backlog.size()), std::memory_order_relaxed);
+    if (m_backlog.empty() == true) m_backlogTimer->stop();
+
+    if ((moved == true) && (m_notifyPending.exchange(true, std::memory_order_acq_rel) == false)) {
+        emit packetsAvailable();
+    }
+}
+
+void SerialWorker::enqueue(SerialPacket &&packet) {
+    // Keep ordering: nothing may overtake packets that are already waiting in the backlog
+    if ((m_backlog.empty() == false) || (m_queue.tryPush(std::move(packet)) == false)) {
+        m_backlog.push_back(std::move(packet));
+        m_backlogDepth.store(quint64(m_backlog.size()), std::memory_order_relaxed);
+        if (m_backlogTimer->isActive() == false) m_backlogTimer->start();
+    }
+
+    if (m_notifyPending.exchange(true, std::memory_order_acq_rel) == false) emit packetsAvailable();
+}
+
+SessionFormat::PortSettings SerialWorker::portSettings() const {
+    SessionFormat::PortSettings settings{};
+    const QByteArray            portName = m_settings.portName.toUtf8();
+    settings.baudRate                    = quint32(m_settings.baudRate);
+    settings.dataBits                    = quint8(m_settings.dataBits);
+    settings.stopBits                    = quint8(m_settings.stopBits);
+    settings.parity                      = quint8(m_settings.parity);
+    settings.flowControl                 = quint8(m_settings.flowControl);
+    std::memcpy(settings.portName, portName.constData(), qMin(portName.size(), qsizetype(sizeof(settings.portName) - 1)));
+    return settings;
+}
+
+void SerialWorker::recordSettings() {
+    if (m_recorder.isRecording() == false) return;
+
+    const SessionFormat::PortSettings settings = portSettings();
+    m_recorder.record(SessionFormat::Settings, reinterpret_cast<const char *>(&settings), sizeof(settings),
+                      SessionFormat::monotonicNs());
+}
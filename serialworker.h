@@ -0,0 +1,133 @@
+#ifndef SERIALWORKER_H
+#define SERIALWORKER_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QTimer>
+#include <QtSerialPort/QSerialPort>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
+
+#include "framer.h"
+#include "serialsettings.h"
+#include "sessionrecorder.h"
+#include "spscqueue.h"
+
+struct SerialPacket {
+    QByteArray data;
+    qint64     timestampNs = 0;  // monotonic time of the read that completed the packet
+    qint64     realtimeNs  = 0;  // wall clock read next to it, what the packet is shown with
+};
+
+// When the worker handed a chunk to the port, on both clocks
+struct SerialWriteTime {
+    qint64 timestampNs = 0;  // monotonic, what the recording and chunkWritten have
+    qint64 realtimeNs  = 0;  // wall clock
+};
+
+// Owns the serial port, the receive framing and the counters. Lives in its own
+// thread so that reads never wait on the GUI; received packets are handed over
+// through a lock-free queue which the GUI drains in batches.
+class SerialWorker : public QObject {
+    Q_OBJECT
+
+   public:
+    // One counter per QSerialPort::SerialPortError value, NoError included
+    static constexpr int kSerialErrorTypes = QSerialPort::NotOpenError + 1;
+    // Writes other threads queue to this one and the worker has not got to yet;
+    // senders keep below this so a stalled port does not pile them up
+    static constexpr int kMaxWritesInFlight = 4;
+
+    explicit SerialWorker(QObject *parent = nullptr);
+
+    // Called from the GUI thread
+    bool    takePacket(SerialPacket &packet);
+    void    acknowledgePackets();
+    bool    isOpen() const { return m_isOpen.load(std::memory_order_acquire); }
+    quint64 packetsReceived() const { return m_packetsReceived.load(std::memory_order_relaxed); }
+    quint64 packetsWritten() const { return m_packetsWritten.load(std::memory_order_relaxed); }
+    quint64 bytesReceived() const { return m_bytesReceived.load(std::memory_order_relaxed); }
+    quint64 bytesWritten() const { return m_bytesWritten.load(std::memory_order_relaxed); }
+    quint64 frameErrors() const { return m_frameErrors.load(std::memory_order_relaxed); }
+    quint64 bytesToWrite() const { return m_bytesToWrite.load(std::memory_order_relaxed); }
+    quint64 recordedBytes() const { return m_recorder.bytesWritten(); }
+    quint64 queueDepth() const { return quint64(m_queue.size()); }
+    quint64 backlogDepth() const { return m_backlogDepth.load(std::memory_order_relaxed); }
+    quint64 serialErrors(QSerialPort::SerialPortError error) const {
+        return (error >= 0 && error < kSerialErrorTypes) ? m_serialErrors[error].load(std::memory_order_relaxed) : 0;
+    }
+    void    resetReceivedCount() {
+        m_packetsReceived.store(0, std::memory_order_relaxed);
+        m_frameErrors.store(0, std::memory_order_relaxed);
+    }
+    void    resetWrittenCount() {
+        m_packetsWritten.store(0, std::memory_order_relaxed);
+        m_bytesWritten.store(0, std::memory_order_relaxed);
+    }
+
+    // Called in the worker thread
+    const SerialSettings       &settings() const { return m_settings; }
+    SessionFormat::PortSettings portSettings() const;
+
+   public slots:
+    // Called in the worker thread
+    bool            open(const SerialSettings &settings);
+    void            close();
+    SerialWriteTime write(const QByteArray &data);
+    void            setPacketGap(int ms);
+    void            setFraming(const Framer::Options &options);
+    bool            startRecording(const QString &fileName, QString *errorString);
+    void            stopRecording();
+
+   signals:
+    void packetsAvailable();
+    // Every chunk as read from the port, before framing; emitted in the worker thread
+    void chunkReceived(const QByteArray &chunk, qint64 timestampNs);
+    // Every chunk handed to the port; emitted in the worker thread
+    void chunkWritten(const QByteArray &chunk, qint64 timestampNs, qint64 realtimeNs);
+    // The driver took this many bytes off the write queue; emitted in the worker thread
+    void bytesAccepted(qint64 bytes);
+    void errorOccurred(QSerialPort::SerialPortError error);
+    // A block could not be written, the recording was stopped
+    void recordingFailed(const QString &fileName, const QString &errorString);
+
+   private slots:
+    void readSerialPort();
+    void flushPacket();
+    void flushBacklog();
+
+   private:
+    void deliverFrame(QByteArrayView frame);
+    void enqueue(SerialPacket &&packet);
+    void recordSettings();
+
+    QSerialPort *m_serialPort     = nullptr;
+    QTimer      *m_packetGapTimer = nullptr;
+    QTimer      *m_backlogTimer   = nullptr;
+
+    SerialSettings           m_settings;
+    SessionRecorder          m_recorder;
+    std::unique_ptr<Framer>  m_framer;  // nullptr frames by packet gap
+    Framer::Sink             m_frameSink;
+    QByteArray               m_receiveBuffer;
+    SpscQueue<SerialPacket>  m_queue;
+    std::deque<SerialPacket> m_backlog;  // packets the GUI had no room for yet
+    int                      m_packetGap_ms       = 2;
+    qint64                   m_lastReadNs         = 0;
+    qint64                   m_lastReadRealtimeNs = 0;
+    std::atomic<bool>        m_isOpen{false};
+    std::atomic<bool>        m_notifyPending{false};
+    std::atomic<quint64>     m_packetsReceived{0};
+    std::atomic<quint64>     m_packetsWritten{0};
+    std::atomic<quint64>     m_bytesReceived{0};
+    std::atomic<quint64>     m_frameErrors{0};
+    std::atomic<quint64>     m_bytesWritten{0};  // accepted by the driver
+    std::atomic<quint64>     m_backlogDepth{0};
+    std::atomic<quint64>     m_bytesToWrite{0};  // queued in the port, for senders that pace themselves
+
+    std::array<std::atomic<quint64>, kSerialErrorTypes> m_serialErrors{};
+};
+
+#endif  // SERIALWORKER_H
@@ -0,0 +1,50 @@
+#include "serialworkerpool.h"
+
+#include <algorithm>
+
+using namespace Qt::StringLiterals;
+
+SerialWorkerPool::SerialWorkerPool(QObject *parent) : QObject(parent) {
+    // Threads are started up front, there are only a few of them
+    const int count = qBound(1, QThread::idealThreadCount() / 2, 4);
+    for (int i = 0; i < count; i++) {
+        PoolThread poolThread;
+        poolThread.thread = new QThread(this);
+        poolThread.thread->setObjectName(u"SerialPool-%1"_s.arg(i));
+        poolThread.thread->start(QThread::TimeCriticalPriority);
+        m_threads.append(poolThread);
+    }
+}
+
+SerialWorkerPool::~SerialWorkerPool() {
+    const QList<SerialWorker *> workers = m_workerThreads.keys();
+    for (SerialWorker *worker : workers) releaseWorker(worker);
+
+    // Workers released by deleteLater() are deleted when their thread finishes
+    for (const PoolThread &poolThread : std::as_const(m_threads)) {
+        poolThread.thread->quit();
+        poolThread.thread->wait();
+    }
+}
+
+SerialWorker *SerialWorkerPool::createWorker() {
+    auto least = std::min_element(m_threads.begin(), m_threads.end(),
+                                  [](const PoolThread &a, const PoolThread &b) { return a.workers < b.workers; });
+    least->workers++;
+
+    auto *worker = new SerialWorker;
+    worker->moveToThread(least->thread);
+    m_workerThreads.insert(worker, least->thread);
+    return worker;
+}
+
+void SerialWorkerPool::releaseWorker(SerialWorker *worker) {
+    QThread *thread = m_workerThreads.take(worker);
+    if (thread == nullptr) return;
+
+    for (PoolThread &poolThread : m_threads) {
+        if (poolThread.thread == thread) poolThread.workers--;
+    }
+    QMetaObject::invokeMethod(worker, [worker]() { worker->close(); }, Qt::BlockingQueuedConnection);
+    worker->deleteLater();
+}
@@ -0,0 +1,39 @@
+#ifndef SERIALWORKERPOOL_H
+#define SERIALWORKERPOOL_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QThread>
+
+#include "serialworker.h"
+
+// A small, fixed pool of threads for any number of serial workers. A port at
+// serial speeds keeps a thread busy for microseconds per read, so a handful of
+// threads serve dozens of ports; each new worker goes to the thread that
+// currently has the fewest.
+class SerialWorkerPool : public QObject {
+    Q_OBJECT
+
+   public:
+    explicit SerialWorkerPool(QObject *parent = nullptr);
+    ~SerialWorkerPool();
+
+    // The worker lives in one of the pool's threads
+    SerialWorker *createWorker();
+    // Closes the port and deletes the worker, both in the worker's thread
+    void releaseWorker(SerialWorker *worker);
+
+    int threadCount() const { return int(m_threads.size()); }
+
+   private:
+    struct PoolThread {
+        QThread *thread  = nullptr;
+        int      workers = 0;
+    };
+
+    QList<PoolThread>                m_threads;
+    QHash<SerialWorker *, QThread *> m_workerThreads;
+};
+
+#endif  // SERIALWORKERPOOL_H
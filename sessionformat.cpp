@@ -0,0 +1,23 @@
+#include "sessionformat.h"
+
+#include <chrono>
+
+#include "checksum.h"
+
+namespace SessionFormat {
+
+qint64 monotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+qint64 realtimeNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+quint32 crc32(const char *data, qsizetype size) {
+    return Checksum::crc32(data, size);
+}
+
+}  // namespace SessionFormat
@@ -0,0 +1,77 @@
+#ifndef SESSIONFORMAT_H
+#define SESSIONFORMAT_H
+
+#include <QtGlobal>
+
+// On-disk layout of a recorded session (*.cps). All integers are little endian.
+//
+//   FileHeader
+//   BlockHeader, records...   <- repeated, every block is written in one go
+//
+// A record is a RecordHeader followed by `length` payload bytes. Blocks carry a
+// CRC over their payload, so a reader simply stops at the first block that is
+// truncated or damaged; a crash loses at most the block that was being filled.
+namespace SessionFormat {
+
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+#error "The session format is written in host byte order, which must be little endian"
+#endif
+
+constexpr char    kFileMagic[8]     = {'C', 'P', 'S', 'E', 'S', 'S', '0', '1'};
+constexpr quint32 kBlockMagic       = 0x314B4C42;  // "BLK1"
+constexpr quint16 kVersion          = 1;
+constexpr quint32 kDefaultBlockSize = 64 * 1024;
+
+enum Direction : quint8 {
+    Received    = 0,
+    Transmitted = 1,
+    Settings    = 2,  // payload is a PortSettings
+};
+
+struct FileHeader {
+    char    magic[8];
+    quint16 version;
+    quint16 headerSize;
+    quint32 blockSize;    // nominal payload size of a block
+    qint64  realtimeNs;   // wall clock when the capture started, ns since the epoch
+    qint64  monotonicNs;  // monotonic clock at that same instant
+    quint8  reserved[32];
+};
+
+struct BlockHeader {
+    quint32 magic;
+    quint32 payloadSize;
+    quint32 recordCount;
+    quint32 crc32;  // of the payload
+    qint64  firstTimestampNs;
+    qint64  lastTimestampNs;
+};
+
+struct RecordHeader {
+    qint64  timestampNs;  // monotonic
+    quint32 length;
+    quint8  direction;
+    quint8  reserved[3];
+};
+
+struct PortSettings {
+    quint32 baudRate;
+    quint8  dataBits;
+    quint8  stopBits;
+    quint8  parity;
+    quint8  flowControl;
+    char    portName[56];  // UTF-8, zero padded
+};
+
+static_assert(sizeof(FileHeader) == 64, "FileHeader layout changed");
+static_assert(sizeof(BlockHeader) == 32, "BlockHeader layout changed");
+static_assert(sizeof(RecordHeader) == 16, "RecordHeader layout changed");
+static_assert(sizeof(PortSettings) == 64, "PortSettings layout changed");
+
+qint64  monotonicNs();
+qint64  realtimeNs();
+quint32 crc32(const char *data, qsizetype size);
+
+}  // namespace SessionFormat
+
+#endif  // SESSIONFORMAT_H
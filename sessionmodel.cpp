@@ -0,0 +1,80 @@
+#include "sessionmodel.h"
+
+#include <climits>
+#include <cstring>
+
+#include "hexdump.h"
+#include "logmodel.h"
+
+using namespace SessionFormat;
+
+static QString settingsString(QByteArrayView data) {
+    PortSettings settings{};
+    if (data.size() < qsizetype(sizeof(settings))) return QString();
+
+    std::memcpy(&settings, data.data(), sizeof(settings));
+    settings.portName[sizeof(settings.portName) - 1] = '\0';
+    return QObject::tr("---- Serial port %1 at %2 baud ----").arg(QString::fromUtf8(settings.portName)).arg(settings.baudRate);
+}
+
+SessionModel::SessionModel(SessionReader *reader, QObject *parent) : QAbstractListModel(parent), m_reader(reader) {
+    m_formatter.setResolution(TimestampFormatter::Microseconds);
+}
+
+int SessionModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid() == true) return 0;
+    return int(qMin<qint64>(m_reader->recordCount() * 2, INT_MAX - 1));
+}
+
+QVariant SessionModel::data(const QModelIndex &index, int role) const {
+    if ((index.isValid() == false) || ((role != Qt::DisplayRole) && (role != Qt::ForegroundRole))) return QVariant();
+
+    SessionReader::Record record;
+    const bool            isTimeLine = ((index.row() % 2) == 0);
+    if (m_reader->record(index.row() / 2, record) == false) {
+        if (role == Qt::ForegroundRole) return LogModel::brush(LogModel::Status);
+        return isTimeLine ? QString() : tr("**** Damaged block ****");
+    }
+
+    if (role == Qt::ForegroundRole) {
+        if (isTimeLine == true) return LogModel::brush(LogModel::Timestamp);
+        switch (record.direction) {
+            case Received:
+                return LogModel::brush(LogModel::Received);
+            case Transmitted:
+                return LogModel::brush(LogModel::Transmitted);
+            default:
+                return LogModel::brush(LogModel::Status);
+        }
+    }
+
+    if (isTimeLine == true) {
+        // Wall clock time down to the microsecond plus the offset into the capture
+        const qint64 realtimeNs = m_reader->toRealtimeNs(record.timestampNs);
+        const qint64 offsetNs   = record.timestampNs - m_reader->firstTimestampNs();
+        const char  *direction  = (record.direction == Received) ? "RECV" : (record.direction == Transmitted) ? "SEND" : "PORT";
+        QString      text;
+        text.reserve(64);
+        text += u'[';
+        m_formatter.appendAbsolute(realtimeNs, text);
+        text += u"] ";
+        m_formatter.appendDelta(offsetNs, text);
+        text += u" s# ";
+        text += QLatin1String(direction);
+        text += u" (";
+        text += QString::number(record.data.size());
+        text += u" bytes)";
+        return text;
+    }
+
+    if (record.direction == Settings) return settingsString(record.data);
+    if (m_isHexEnabled == true) return QString::fromLatin1(HexDump::toSpacedHex(record.data));
+    return QString::fromUtf8(record.data);
+}
+
+void SessionModel::setHexEnabled(bool enable) {
+    if (m_isHexEnabled == enable) return;
+
+    m_isHexEnabled = enable;
+    if (rowCount() > 0) emit dataChanged(index(0), index(rowCount() - 1));
+}
@@ -0,0 +1,30 @@
+#ifndef SESSIONMODEL_H
+#define SESSIONMODEL_H
+
+#include <QAbstractListModel>
+
+#include "sessionreader.h"
+#include "timestampformatter.h"
+
+// Presents a recorded session in the same two-lines-per-chunk layout as the
+// live log. Rows are decoded from the mapped file on demand, so only the lines
+// a view actually shows are ever formatted.
+class SessionModel : public QAbstractListModel {
+    Q_OBJECT
+
+   public:
+    explicit SessionModel(SessionReader *reader, QObject *parent = nullptr);
+
+    int      rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void setHexEnabled(bool enable);
+    int  rowOfRecord(qint64 record) const { return int(qMin<qint64>(record * 2, rowCount())); }
+
+   private:
+    SessionReader     *m_reader;
+    bool               m_isHexEnabled = false;
+    TimestampFormatter m_formatter;
+};
+
+#endif  // SESSIONMODEL_H
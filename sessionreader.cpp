@@ -0,0 +1,156 @@
+#include "sessionreader.h"
+
+#include <QObject>
+#include <algorithm>
+#include <cstring>
+
+using namespace SessionFormat;
+
+SessionReader::~SessionReader() {
+    close();
+}
+
+bool SessionReader::open(const QString &fileName, QString *errorString) {
+    close();
+
+    m_file.setFileName(fileName);
+    if (m_file.open(QIODevice::ReadOnly) == false) {
+        if (errorString != nullptr) *errorString = m_file.errorString();
+        return false;
+    }
+
+    m_size = m_file.size();
+    if (m_size < qint64(sizeof(FileHeader))) {
+        if (errorString != nullptr) *errorString = QObject::tr("Not a session file");
+        m_file.close();
+        return false;
+    }
+
+    m_data = m_file.map(0, m_size);
+    if (m_data == nullptr) {
+        if (errorString != nullptr) *errorString = m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    std::memcpy(&m_header, m_data, sizeof(m_header));
+    if ((std::memcmp(m_header.magic, kFileMagic, sizeof(kFileMagic)) != 0) || (m_header.version != kVersion) ||
+        (m_header.headerSize < sizeof(FileHeader))) {
+        if (errorString != nullptr) *errorString = QObject::tr("Not a session file or unsupported version");
+        close();
+        return false;
+    }
+
+    // Hop from block header to block header, payloads are not touched
+    qint64 offset = m_header.headerSize;
+    while (offset + qint64(sizeof(BlockHeader)) <= m_size) {
+        BlockHeader header;
+        std::memcpy(&header, m_data + offset, sizeof(header));
+        if ((header.magic != kBlockMagic) || (offset + qint64(sizeof(header)) + header.payloadSize > m_size)) break;
+
+        m_blocks.push_back({offset, m_recordCount, header.firstTimestampNs, header.lastTimestampNs, header.payloadSize,
+                            header.recordCount});
+        m_recordCount += header.recordCount;
+        offset += sizeof(header) + header.payloadSize;
+    }
+    m_isTruncated = (offset != m_size);
+    return true;
+}
+
+void SessionReader::close() {
+    if (m_data != nullptr) m_file.unmap(const_cast<uchar *>(m_data));
+    m_file.close();
+    m_data        = nullptr;
+    m_size        = 0;
+    m_recordCount = 0;
+    m_isTruncated = false;
+    m_cachedBlock = -1;
+    m_blocks.clear();
+    m_cachedOffsets.clear();
+}
+
+qint64 SessionReader::firstTimestampNs() const {
+    return m_blocks.empty() ? m_header.monotonicNs : m_blocks.front().firstTimestampNs;
+}
+
+qint64 SessionReader::lastTimestampNs() const {
+    return m_blocks.empty() ? m_header.monotonicNs : m_blocks.back().lastTimestampNs;
+}
+
+bool SessionReader::record(qint64 index, Record &record) {
+    const int block = blockOf(index);
+    if ((block < 0) || (loadBlock(block) == false)) return false;
+
+    const qint64 offset = m_blocks[block].offset + qint64(sizeof(BlockHeader)) +
+                          m_cachedOffsets[std::size_t(index - m_blocks[block].firstRecord)];
+    RecordHeader header;
+    std::memcpy(&header, m_data + offset, sizeof(header));
+    record.timestampNs = header.timestampNs;
+    record.direction   = Direction(header.direction);
+    record.data = QByteArrayView(reinterpret_cast<const char *>(m_data + offset + sizeof(header)), header.length);
+    return true;
+}
+
+qint64 SessionReader::indexAtTime(qint64 timestampNs) const {
+    // Sparse step: the first block that still has records at or after the time
+    const auto block = std::lower_bound(m_blocks.begin(), m_blocks.end(), timestampNs,
+                                        [](const Block &block, qint64 time) { return block.lastTimestampNs < time; });
+    if (block == m_blocks.end()) return m_recordCount;
+
+    // Dense step inside that one block
+    const qint64 end    = block->offset + qint64(sizeof(BlockHeader)) + block->payloadSize;
+    qint64       offset = block->offset + qint64(sizeof(BlockHeader));
+    for (quint32 index = 0; (index < block->recordCount) && (offset + qint64(sizeof(RecordHeader)) <= end); index++) {
+        RecordHeader header;
+        std::memcpy(&header, m_data + offset, sizeof(header));
+        if (header.timestampNs >= timestampNs) return block->firstRecord + index;
+        offset += sizeof(header) + header.length;
+    }
+    return block->firstRecord + block->recordCount;
+}
+
+int SessionReader::blockOf(qint64 index) const {
+    if ((index < 0) || (index >= m_recordCount)) return -1;
+
+    // Sequential access (scrolling, replay) mostly stays in the cached block
+    if ((m_cachedBlock >= 0) && (index >= m_blocks[m_cachedBlock].firstRecord) &&
+        (index < m_blocks[m_cachedBlock].firstRecord + m_blocks[m_cachedBlock].recordCount)) {
+        return m_cachedBlock;
+    }
+
+    const auto block = std::upper_bound(m_blocks.begin(), m_blocks.end(), index,
+                                        [](qint64 value, const Block &block) { return value < block.firstRecord; });
+    return int(std::distance(m_blocks.begin(), block)) - 1;
+}
+
+bool SessionReader::loadBlock(int block) {
+    if (block == m_cachedBlock) return m_cachedValid;
+
+    const Block &entry   = m_blocks[block];
+    const uchar *payload = m_data + entry.offset + sizeof(BlockHeader);
+    BlockHeader  header;
+    std::memcpy(&header, m_data + entry.offset, sizeof(header));
+
+    m_cachedBlock = block;
+    m_cachedValid = (crc32(reinterpret_cast<const char *>(payload), entry.payloadSize) == header.crc32);
+    m_cachedOffsets.clear();
+    if (m_cachedValid == false) return false;
+
+    m_cachedOffsets.reserve(entry.recordCount);
+    quint32 offset = 0;
+    for (quint32 index = 0; index < entry.recordCount; index++) {
+        RecordHeader record;
+        if (offset + sizeof(record) > entry.payloadSize) {
+            m_cachedValid = false;
+            return false;
+        }
+        std::memcpy(&record, payload + offset, sizeof(record));
+        if (record.length > entry.payloadSize - offset - sizeof(record)) {
+            m_cachedValid = false;
+            return false;
+        }
+        m_cachedOffsets.push_back(offset);
+        offset += sizeof(record) + record.length;
+    }
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef SESSIONREADER_H
+#define SESSIONREADER_H
+
+#include <QByteArrayView>
+#include <QFile>
+#include <QString>
+#include <vector>
+
+#include "sessionformat.h"
+
+// Read-only access to a recorded session. The file is memory mapped and only
+// the block headers are visited on open, which yields a sparse index (one
+// entry per block) for seeking by record number or by time. Record payloads
+// point straight into the mapping and are only touched when asked for.
+class SessionReader {
+   public:
+    struct Record {
+        qint64                   timestampNs = 0;
+        SessionFormat::Direction direction   = SessionFormat::Received;
+        QByteArrayView           data;
+    };
+
+    SessionReader() = default;
+    ~SessionReader();
+
+    SessionReader(const SessionReader &)            = delete;
+    SessionReader &operator=(const SessionReader &) = delete;
+
+    bool open(const QString &fileName, QString *errorString = nullptr);
+    void close();
+
+    bool    isOpen() const { return m_data != nullptr; }
+    QString fileName() const { return m_file.fileName(); }
+    qint64  recordCount() const { return m_recordCount; }
+    qint64  startRealtimeNs() const { return m_header.realtimeNs; }
+    qint64  startMonotonicNs() const { return m_header.monotonicNs; }
+    qint64  firstTimestampNs() const;
+    qint64  lastTimestampNs() const;
+    bool    isTruncated() const { return m_isTruncated; }
+
+    // Returns false for a record inside a block whose CRC does not match
+    bool   record(qint64 index, Record &record);
+    qint64 indexAtTime(qint64 timestampNs) const;  // first record at or after the time
+
+    // Wall clock time of a record timestamp, ns since the epoch
+    qint64 toRealtimeNs(qint64 timestampNs) const { return m_header.realtimeNs + (timestampNs - m_header.monotonicNs); }
+
+   private:
+    struct Block {
+        qint64  offset;       // of the BlockHeader in the file
+        qint64  firstRecord;  // index of the first record in this block
+        qint64  firstTimestampNs;
+        qint64  lastTimestampNs;
+        quint32 payloadSize;
+        quint32 recordCount;
+    };
+
+    int  blockOf(qint64 index) const;
+    bool loadBlock(int block);
+
+    QFile                     m_file;
+    const uchar              *m_data = nullptr;
+    qint64                    m_size = 0;
+    SessionFormat::FileHeader m_header{};
+    std::vector<Block>        m_blocks;
+    qint64                    m_recordCount = 0;
+    bool                      m_isTruncated = false;
+
+    // Record offsets of the most recently decoded block
+    int                  m_cachedBlock = -1;
+    bool                 m_cachedValid = false;
+    std::vector<quint32> m_cachedOffsets;
+};
+
+#endif  // SESSIONREADER_H
@@ -0,0 +1,153 @@
+#include "sessionrecorder.h"
+
+#include <chrono>
+#include <cstring>
+
+using namespace SessionFormat;
+
+// A partially filled block is written anyway once it is this old, which bounds
+// how much a crash can lose on a quiet line.
+static constexpr qint64 kMaxBlockAgeNs = 1000 * 1000 * 1000;
+
+SessionRecorder::~SessionRecorder() {
+    stop();
+}
+
+bool SessionRecorder::start(const QString &fileName, QString *errorString) {
+    stop();
+
+    m_fileName = fileName;
+    m_file.setFileName(fileName);
+    if (m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered) == false) {
+        if (errorString != nullptr) *errorString = m_file.errorString();
+        return false;
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, kFileMagic, sizeof(header.magic));
+    header.version     = kVersion;
+    header.headerSize  = sizeof(FileHeader);
+    header.blockSize   = kDefaultBlockSize;
+    header.realtimeNs  = realtimeNs();
+    header.monotonicNs = monotonicNs();
+    if (m_file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != qint64(sizeof(header))) {
+        if (errorString != nullptr) *errorString = m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    m_bytesWritten.store(sizeof(header), std::memory_order_relaxed);
+    m_block.clear();
+    m_block.reserve(sizeof(BlockHeader) + kDefaultBlockSize);
+    m_blockRecords = 0;
+    m_stopping     = false;
+    m_isFailed     = false;
+    m_thread       = std::thread(&SessionRecorder::writerLoop, this);
+    return true;
+}
+
+void SessionRecorder::stop() {
+    if (m_thread.joinable() == false) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        sealBlock();
+        m_stopping = true;
+    }
+    m_wakeup.notify_one();
+    m_thread.join();
+    m_file.close();
+}
+
+bool SessionRecorder::hasFailed() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_isFailed;
+}
+
+void SessionRecorder::record(Direction direction, const char *data, qsizetype size, qint64 timestampNs) {
+    if ((m_thread.joinable() == false) || (size <= 0)) return;
+
+    RecordHeader header{};
+    header.timestampNs = timestampNs;
+    header.length      = quint32(size);
+    header.direction   = direction;
+
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_isFailed == true) return;
+
+        const qsizetype payload = m_block.size() - qsizetype(sizeof(BlockHeader));
+        if ((m_blockRecords > 0) && (payload + qsizetype(sizeof(header)) + size > qsizetype(kDefaultBlockSize))) {
+            sealBlock();
+            notify = true;
+        }
+        if (m_blockRecords == 0) {
+            m_block.resize(sizeof(BlockHeader));
+            m_blockFirstNs = timestampNs;
+            m_blockOpenNs  = monotonicNs();
+        }
+        m_block.append(reinterpret_cast<const char *>(&header), sizeof(header));
+        m_block.append(data, size);
+        m_blockLastNs = timestampNs;
+        m_blockRecords++;
+    }
+    if (notify == true) m_wakeup.notify_one();
+}
+
+void SessionRecorder::sealBlock() {
+    if (m_blockRecords == 0) return;
+
+    BlockHeader header{};
+    header.magic            = kBlockMagic;
+    header.payloadSize      = quint32(m_block.size() - sizeof(BlockHeader));
+    header.recordCount      = m_blockRecords;
+    header.crc32            = crc32(m_block.constData() + sizeof(BlockHeader), header.payloadSize);
+    header.firstTimestampNs = m_blockFirstNs;
+    header.lastTimestampNs  = m_blockLastNs;
+    std::memcpy(m_block.data(), &header, sizeof(header));
+
+    m_sealedBlocks.push_back(std::move(m_block));
+    m_block = QByteArray();
+    m_block.reserve(sizeof(BlockHeader) + kDefaultBlockSize);
+    m_blockRecords = 0;
+}
+
+void SessionRecorder::writerLoop() {
+    std::deque<QByteArray> blocks;
+
+    while (true) {
+        bool stopping = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeup.wait_for(lock, std::chrono::milliseconds(250),
+                              [this]() { return (m_sealedBlocks.empty() == false) || (m_stopping == true); });
+            if ((m_blockRecords > 0) && (monotonicNs() - m_blockOpenNs >= kMaxBlockAgeNs)) sealBlock();
+            blocks.swap(m_sealedBlocks);
+            stopping = m_stopping;
+        }
+
+        for (const QByteArray &block : blocks) {
+            const qint64 written = m_file.write(block);
+            if (written > 0) m_bytesWritten.fetch_add(quint64(written), std::memory_order_relaxed);
+            if (written != block.size()) {
+                fail(m_file.errorString());
+                return;
+            }
+        }
+        blocks.clear();
+
+        if (stopping == true) break;
+    }
+}
+
+void SessionRecorder::fail(const QString &errorString) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isFailed = true;
+        m_sealedBlocks.clear();
+        m_block.clear();
+        m_blockRecords = 0;
+    }
+    if (m_errorHandler) m_errorHandler(errorString);
+}
@@ -0,0 +1,70 @@
+#ifndef SESSIONRECORDER_H
+#define SESSIONRECORDER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "sessionformat.h"
+
+// Appends raw RX/TX chunks to a session file. record() only copies the chunk
+// into the block being filled; full blocks (or blocks older than a second) are
+// handed to a writer thread which stores each one with a single unbuffered write.
+// A write that fails ends the recording: nothing more is recorded and the error
+// handler is told, stop() still closes the file.
+class SessionRecorder {
+   public:
+    using ErrorHandler = std::function<void(const QString &errorString)>;
+
+    SessionRecorder() = default;
+    ~SessionRecorder();
+
+    SessionRecorder(const SessionRecorder &)            = delete;
+    SessionRecorder &operator=(const SessionRecorder &) = delete;
+
+    bool start(const QString &fileName, QString *errorString = nullptr);
+    void stop();
+    // Called in the writer thread, set it while not recording
+    void setErrorHandler(const ErrorHandler &handler) { m_errorHandler = handler; }
+    bool hasFailed() const;
+
+    bool    isRecording() const { return m_thread.joinable(); }
+    QString fileName() const { return m_fileName; }
+    quint64 bytesWritten() const { return m_bytesWritten.load(std::memory_order_relaxed); }
+
+    void record(SessionFormat::Direction direction, const char *data, qsizetype size, qint64 timestampNs);
+    void record(SessionFormat::Direction direction, const QByteArray &data, qint64 timestampNs) {
+        record(direction, data.constData(), data.size(), timestampNs);
+    }
+
+   private:
+    void writerLoop();
+    void sealBlock();  // m_mutex must be held
+    void fail(const QString &errorString);
+
+    QString      m_fileName;
+    QFile        m_file;  // only touched by the writer thread while recording
+    std::thread  m_thread;
+    ErrorHandler m_errorHandler;
+
+    mutable std::mutex      m_mutex;
+    std::condition_variable m_wakeup;
+    std::deque<QByteArray>  m_sealedBlocks;
+    QByteArray              m_block;
+    quint32                 m_blockRecords = 0;
+    qint64                  m_blockFirstNs = 0;
+    qint64                  m_blockLastNs  = 0;
+    qint64                  m_blockOpenNs  = 0;
+    bool                    m_stopping     = false;
+    bool                    m_isFailed     = false;  // a write failed, nothing is recorded any more
+
+    std::atomic<quint64> m_bytesWritten{0};
+};
+
+#endif  // SESSIONRECORDER_H
@@ -0,0 +1,156 @@
+#include "sessionreplayer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "serialworker.h"
+
+using namespace Qt::StringLiterals;
+using namespace SessionFormat;
+
+namespace {
+
+// What the port may hold ahead of the wire before the next chunk has to wait
+constexpr quint64 kMaxBytesToWrite = 64 * 1024;
+
+// Filled in the worker thread, read by the replay thread once the worker drained
+struct Lateness {
+    std::mutex          mutex;
+    std::vector<qint64> samplesNs;
+    std::atomic<int>    inFlight{0};  // chunks handed to the worker and not written yet
+};
+
+void sleepUntil(qint64 deadlineNs, const std::atomic<bool> &isStopping) {
+    // Sleep in slices so that stop() never has to wait for a long pause in the capture
+    constexpr qint64 kSliceNs = 50 * 1000 * 1000;
+    while (isStopping.load(std::memory_order_relaxed) == false) {
+        const qint64 remainingNs = deadlineNs - monotonicNs();
+        if (remainingNs <= 0) return;
+        std::this_thread::sleep_for(std::chrono::nanoseconds(qMin(remainingNs, kSliceNs)));
+    }
+}
+
+// Waits until the worker can take another chunk: at speed 0, and once replay
+// falls behind the recording, nothing else keeps every chunk from being queued
+// up front
+void waitForRoom(const Lateness &lateness, const SerialWorker *worker, const std::atomic<bool> &isStopping) {
+    constexpr auto kPoll = std::chrono::microseconds(200);
+    while (isStopping.load(std::memory_order_relaxed) == false &&
+           (lateness.inFlight.load(std::memory_order_acquire) >= SerialWorker::kMaxWritesInFlight ||
+            worker->bytesToWrite() >= kMaxBytesToWrite)) {
+        std::this_thread::sleep_for(kPoll);
+    }
+}
+
+QString latencyReport(std::vector<qint64> &samplesNs) {
+    if (samplesNs.empty() == true) return QString();
+
+    std::sort(samplesNs.begin(), samplesNs.end());
+    const auto percentile = [&samplesNs](double p) {
+        return double(samplesNs[std::size_t(p * double(samplesNs.size() - 1))]) / 1000.0;
+    };
+    double sum = 0;
+    for (qint64 sample : samplesNs) sum += double(sample);
+
+    return QObject::tr("jitter mean %1 us, p50 %2 us, p99 %3 us, max %4 us")
+        .arg(sum / double(samplesNs.size()) / 1000.0, 0, 'f', 1)
+        .arg(percentile(0.50), 0, 'f', 1)
+        .arg(percentile(0.99), 0, 'f', 1)
+        .arg(double(samplesNs.back()) / 1000.0, 0, 'f', 1);
+}
+
+}  // namespace
+
+SessionReplayer::SessionReplayer(SerialWorker *worker, QObject *parent) : QObject(parent), m_worker(worker) {
+}
+
+SessionReplayer::~SessionReplayer() {
+    stop();
+}
+
+bool SessionReplayer::start(const QString &fileName, const Options &options, QString *errorString) {
+    stop();
+
+    // A reader of its own, the viewer's reader keeps serving the GUI thread
+    if (m_reader.open(fileName, errorString) == false) return false;
+
+    m_options = options;
+    m_isStopping.store(false, std::memory_order_relaxed);
+    m_isRunning.store(true, std::memory_order_release);
+    m_thread = std::thread(&SessionReplayer::run, this);
+    return true;
+}
+
+void SessionReplayer::stop() {
+    if (m_thread.joinable() == false) return;
+
+    m_isStopping.store(true, std::memory_order_relaxed);
+    m_thread.join();
+    m_reader.close();
+}
+
+void SessionReplayer::run() {
+    const auto   lateness   = std::make_shared<Lateness>();
+    const qint64 total      = m_reader.recordCount();
+    const double speed      = m_options.speed;
+    const qint64 startNs    = monotonicNs();
+    qint64       baseNs     = -1;
+    qint64       chunks     = 0;
+    qint64       bytes      = 0;
+    qint64       nextReport = 0;
+    qint64       index      = qMax<qint64>(0, m_options.firstRecord);
+
+    SessionReader::Record record;
+    for (; (index < total) && (m_isStopping.load(std::memory_order_relaxed) == false); index++) {
+        if ((m_reader.record(index, record) == false) || (record.direction != m_options.direction)) continue;
+
+        if (baseNs < 0) baseNs = record.timestampNs;
+        qint64 deadlineNs = 0;
+        if (speed > 0) {
+            deadlineNs = startNs + qint64(double(record.timestampNs - baseNs) / speed);
+            sleepUntil(deadlineNs, m_isStopping);
+        }
+        waitForRoom(*lateness, m_worker, m_isStopping);
+        if (m_isStopping.load(std::memory_order_relaxed) == true) break;
+        // As fast as possible, a chunk is due once the worker has room for it
+        if (speed <= 0) deadlineNs = monotonicNs();
+
+        SerialWorker    *worker = m_worker;
+        const QByteArray data(record.data.data(), record.data.size());
+        lateness->inFlight.fetch_add(1, std::memory_order_acq_rel);
+        QMetaObject::invokeMethod(worker, [worker, data, deadlineNs, lateness]() {
+            worker->write(data);
+            lateness->inFlight.fetch_sub(1, std::memory_order_acq_rel);
+            const qint64                lateNs = monotonicNs() - deadlineNs;
+            std::lock_guard<std::mutex> lock(lateness->mutex);
+            lateness->samplesNs.push_back(lateNs);
+        });
+        chunks++;
+        bytes += data.size();
+
+        if (monotonicNs() >= nextReport) {
+            emit progress(index + 1, total);
+            nextReport = monotonicNs() + 100 * 1000 * 1000;
+        }
+    }
+
+    // Wait until the worker has written everything that was handed over
+    QMetaObject::invokeMethod(m_worker, []() {}, Qt::BlockingQueuedConnection);
+    emit progress(index, total);
+
+    std::vector<qint64> samplesNs;
+    {
+        std::lock_guard<std::mutex> lock(lateness->mutex);
+        samplesNs.swap(lateness->samplesNs);
+    }
+    const double seconds = double(monotonicNs() - startNs) / 1e9;
+    QString      report  = tr("Replayed %1 chunks, %2 bytes in %3 s").arg(chunks).arg(bytes).arg(seconds, 0, 'f', 3);
+    if (samplesNs.empty() == false) report += u", "_s + latencyReport(samplesNs);
+    if (m_isStopping.load(std::memory_order_relaxed) == true) report += tr(" (stopped)");
+
+    m_isRunning.store(false, std::memory_order_release);
+    emit finished(report);
+}
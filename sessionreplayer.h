@@ -0,0 +1,50 @@
+#ifndef SESSIONREPLAYER_H
+#define SESSIONREPLAYER_H
+
+#include <QObject>
+#include <atomic>
+#include <thread>
+
+#include "sessionreader.h"
+
+class SerialWorker;
+
+// Sends the chunks of one direction of a recorded session out through the
+// serial worker, either with their original spacing or scaled by a speed
+// factor. Every chunk has an absolute deadline on the monotonic clock; how late
+// the worker actually wrote it is collected and reported when replay ends.
+// Chunks are only handed over as the worker and its port take them, so a
+// replay at full speed or a slow port never queues up the whole file.
+class SessionReplayer : public QObject {
+    Q_OBJECT
+
+   public:
+    struct Options {
+        SessionFormat::Direction direction   = SessionFormat::Transmitted;
+        double                   speed       = 1.0;  // 0 = as fast as possible
+        qint64                   firstRecord = 0;
+    };
+
+    explicit SessionReplayer(SerialWorker *worker, QObject *parent = nullptr);
+    ~SessionReplayer();
+
+    bool start(const QString &fileName, const Options &options, QString *errorString = nullptr);
+    void stop();
+    bool isRunning() const { return m_isRunning.load(std::memory_order_acquire); }
+
+   signals:
+    void progress(qint64 record, qint64 total);
+    void finished(const QString &report);
+
+   private:
+    void run();
+
+    SerialWorker     *m_worker;
+    SessionReader     m_reader;
+    Options           m_options;
+    std::thread       m_thread;
+    std::atomic<bool> m_isStopping{false};
+    std::atomic<bool> m_isRunning{false};
+};
+
+#endif  // SESSIONREPLAYER_H
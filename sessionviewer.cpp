@@ -0,0 +1,130 @@
+#include "sessionviewer.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QMessageBox>
+#include <QVBoxLayout>
+
+#include "serialworker.h"
+
+using namespace Qt::StringLiterals;
+
+SessionViewer::SessionViewer(SerialWorker *worker, QWidget *parent)
+    : QWidget(parent, Qt::Window),
+      m_serialWorker(worker),
+      m_model(new SessionModel(&m_reader, this)),
+      m_replayer(new SessionReplayer(worker, this)) {
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(800, 600);
+
+    m_logView           = new LogView(this);
+    m_infoLabel         = new QLabel(this);
+    m_hexCheckBox       = new QCheckBox(tr("Hex"), this);
+    m_jumpSpinBox       = new QDoubleSpinBox(this);
+    m_directionComboBox = new QComboBox(this);
+    m_speedSpinBox      = new QDoubleSpinBox(this);
+    m_replayPushButton  = new QPushButton(tr("Replay"), this);
+    m_replayProgressBar = new QProgressBar(this);
+    m_replayReportLabel = new QLabel(this);
+
+    m_logView->setModel(m_model);
+    m_jumpSpinBox->setDecimals(3);
+    m_jumpSpinBox->setSuffix(tr(" s"));
+    m_jumpSpinBox->setToolTip(tr("Seconds from the start of the capture"));
+    m_directionComboBox->addItem(tr("SEND chunks"), int(SessionFormat::Transmitted));
+    m_directionComboBox->addItem(tr("RECV chunks"), int(SessionFormat::Received));
+    m_speedSpinBox->setRange(0, 1000);
+    m_speedSpinBox->setValue(1);
+    m_speedSpinBox->setSuffix(u"x"_s);
+    m_speedSpinBox->setSpecialValueText(tr("Max"));
+    m_speedSpinBox->setToolTip(tr("Replay speed relative to the recording, Max sends without pauses"));
+    m_replayReportLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+    auto *jumpPushButton = new QPushButton(tr("Go"), this);
+    auto *viewLayout     = new QHBoxLayout;
+    viewLayout->addWidget(m_infoLabel, 1);
+    viewLayout->addWidget(m_hexCheckBox);
+    viewLayout->addWidget(new QLabel(tr("Jump to"), this));
+    viewLayout->addWidget(m_jumpSpinBox);
+    viewLayout->addWidget(jumpPushButton);
+
+    auto *replayLayout = new QHBoxLayout;
+    replayLayout->addWidget(m_directionComboBox);
+    replayLayout->addWidget(new QLabel(tr("Speed"), this));
+    replayLayout->addWidget(m_speedSpinBox);
+    replayLayout->addWidget(m_replayPushButton);
+    replayLayout->addWidget(m_replayProgressBar, 1);
+
+    auto *layout = new QVBoxLayout(this);
+    layout->addLayout(viewLayout);
+    layout->addWidget(m_logView, 1);
+    layout->addLayout(replayLayout);
+    layout->addWidget(m_replayReportLabel);
+
+    connect(m_hexCheckBox, &QCheckBox::toggled, m_model, &SessionModel::setHexEnabled);
+    connect(jumpPushButton, &QPushButton::clicked, this, &SessionViewer::jumpToTime);
+    connect(m_replayPushButton, &QPushButton::clicked, this, &SessionViewer::replayButton_clicked);
+    connect(m_replayer, &SessionReplayer::finished, this, &SessionViewer::replayFinished);
+    connect(m_replayer, &SessionReplayer::progress, this, [this](qint64 record, qint64 total) {
+        // Scaled to stay within the int range of the progress bar
+        m_replayProgressBar->setValue(total > 0 ? int(record * 1000 / total) : 0);
+    });
+    m_replayProgressBar->setRange(0, 1000);
+}
+
+SessionViewer::~SessionViewer() {
+    // Joins the replay thread before the reader and the model go away
+    m_replayer->stop();
+}
+
+bool SessionViewer::open(const QString &fileName, QString *errorString) {
+    if (m_reader.open(fileName, errorString) == false) return false;
+
+    const double seconds = double(m_reader.lastTimestampNs() - m_reader.firstTimestampNs()) / 1e9;
+    QString      info    = tr("%1 chunks, %2 s").arg(m_reader.recordCount()).arg(seconds, 0, 'f', 3);
+    if (m_reader.isTruncated() == true) info += tr(", truncated");
+    m_infoLabel->setText(info);
+    m_jumpSpinBox->setRange(0, seconds);
+
+    // Rows are decoded straight from the mapping, resetting the model is all it takes
+    m_logView->setModel(m_model);
+    setWindowTitle(QFileInfo(fileName).fileName());
+    return true;
+}
+
+void SessionViewer::jumpToTime() {
+    const qint64 timestampNs = m_reader.firstTimestampNs() + qint64(m_jumpSpinBox->value() * 1e9);
+    m_logView->scrollToRow(m_model->rowOfRecord(m_reader.indexAtTime(timestampNs)));
+}
+
+void SessionViewer::replayButton_clicked() {
+    if (m_replayer->isRunning() == true) {
+        m_replayer->stop();
+        return;
+    }
+
+    if (m_serialWorker->isOpen() == false) {
+        QMessageBox::information(this, "Hint", tr("Open a serial port before replaying a session"));
+        return;
+    }
+
+    SessionReplayer::Options options;
+    options.direction   = SessionFormat::Direction(m_directionComboBox->currentData().toInt());
+    options.speed       = m_speedSpinBox->value();
+    options.firstRecord = m_reader.indexAtTime(m_reader.firstTimestampNs() + qint64(m_jumpSpinBox->value() * 1e9));
+
+    QString errorString;
+    if (m_replayer->start(m_reader.fileName(), options, &errorString) == false) {
+        m_replayReportLabel->setText(tr("Unable to replay: %1").arg(errorString));
+        return;
+    }
+    m_replayPushButton->setText(tr("Stop"));
+    m_replayReportLabel->clear();
+}
+
+void SessionViewer::replayFinished(const QString &report) {
+    m_replayer->stop();
+    m_replayPushButton->setText(tr("Replay"));
+    m_replayReportLabel->setText(report);
+}
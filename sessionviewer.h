@@ -0,0 +1,52 @@
+#ifndef SESSIONVIEWER_H
+#define SESSIONVIEWER_H
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QWidget>
+
+#include "logview.h"
+#include "sessionmodel.h"
+#include "sessionreader.h"
+#include "sessionreplayer.h"
+
+class SerialWorker;
+
+// Window showing one recorded session, with seeking by time and replay of the
+// capture through the currently open serial port.
+class SessionViewer : public QWidget {
+    Q_OBJECT
+
+   public:
+    SessionViewer(SerialWorker *worker, QWidget *parent = nullptr);
+    ~SessionViewer();
+
+    bool open(const QString &fileName, QString *errorString = nullptr);
+
+   private slots:
+    void jumpToTime();
+    void replayButton_clicked();
+    void replayFinished(const QString &report);
+
+   private:
+    SerialWorker    *m_serialWorker;
+    SessionReader    m_reader;
+    SessionModel    *m_model    = nullptr;
+    SessionReplayer *m_replayer = nullptr;
+
+    LogView        *m_logView           = nullptr;
+    QLabel         *m_infoLabel         = nullptr;
+    QCheckBox      *m_hexCheckBox       = nullptr;
+    QDoubleSpinBox *m_jumpSpinBox       = nullptr;
+    QComboBox      *m_directionComboBox = nullptr;
+    QDoubleSpinBox *m_speedSpinBox      = nullptr;
+    QPushButton    *m_replayPushButton  = nullptr;
+    QProgressBar   *m_replayProgressBar = nullptr;
+    QLabel         *m_replayReportLabel = nullptr;
+};
+
+#endif  // SESSIONVIEWER_H
@@ -0,0 +1,76 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// Bounded lock-free single-producer/single-consumer ring buffer.
+// Exactly one thread may call tryPush() and exactly one thread may call tryPop().
+// The capacity is rounded up to a power of two.
+template <typename T>
+class SpscQueue {
+   public:
+    explicit SpscQueue(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) size <<= 1;
+        m_mask  = size - 1;
+        m_slots = std::make_unique<T[]>(size);
+    }
+
+    SpscQueue(const SpscQueue &)            = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    bool tryPush(T &&value) {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_headCache > m_mask) {
+            m_headCache = m_head.load(std::memory_order_acquire);
+            if (tail - m_headCache > m_mask) return false;
+        }
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T &value) {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tailCache) {
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+            if (head == m_tailCache) return false;
+        }
+        value = std::move(m_slots[head & m_mask]);
+        m_slots[head & m_mask] = T();
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called concurrently, exact from either side while the other is idle.
+    // The head is read first: the tail read after it can only be further on, so
+    // the difference never wraps below zero; pops in between could take it past
+    // the capacity, it is clamped there.
+    std::size_t size() const {
+        const std::size_t head = m_head.load(std::memory_order_acquire);
+        const std::size_t tail = m_tail.load(std::memory_order_acquire);
+        return std::min(tail - head, capacity());
+    }
+
+    std::size_t capacity() const { return m_mask + 1; }
+
+   private:
+    static constexpr std::size_t kCacheLine = 64;
+
+    std::unique_ptr<T[]> m_slots;
+    std::size_t          m_mask = 0;
+
+    // Consumer side
+    alignas(kCacheLine) std::atomic<std::size_t> m_head{0};
+    std::size_t m_tailCache = 0;
+
+    // Producer side
+    alignas(kCacheLine) std::atomic<std::size_t> m_tail{0};
+    std::size_t m_headCache = 0;
+};
+
+#endif  // SPSCQUEUE_H
@@ -0,0 +1,275 @@
+#include "streamcompare.h"
+
+#include <QHashFunctions>
+#include <algorithm>
+#include <utility>
+
+// Bytes mode: consumed bytes are only moved out of the way once there are this many
+static constexpr qsizetype kCompactBytes = 64 * 1024;
+
+void StreamCompare::setMode(Mode mode) {
+    m_mode = mode;
+    reset();
+}
+
+void StreamCompare::reset() {
+    m_streams[A] = Stream();
+    m_streams[B] = Stream();
+    m_stats      = Stats();
+    m_byteOffset = 0;
+    m_runA.clear();
+    m_runB.clear();
+    m_runOffset    = 0;
+    m_runEqualTail = 0;
+}
+
+void StreamCompare::add(Side side, QByteArrayView data, const Sink &sink) {
+    Stream &stream = m_streams[side];
+
+    if (m_mode == Bytes) {
+        // Offsets the other side gave up on are not compared on this side either
+        const qsizetype skipped = qMin(stream.skip, data.size());
+        stream.skip -= skipped;
+        stream.bytes.append(data.sliced(skipped));
+        compareBytes(sink);
+        return;
+    }
+
+    stream.frames.push_back({data.toByteArray(), qHash(data), stream.count++});
+    stream.frameBytes += data.size();
+    compareFrames(false, sink);
+
+    if (stream.frames.size() > size_t(kMaxPendingFrames) || stream.frameBytes > kMaxPendingBytes) {
+        // Decided with what there is, and what the other side never matched is given up
+        compareFrames(true, sink);
+        qsizetype count = 0;
+        qsizetype bytes = stream.frameBytes;
+        while (qsizetype(stream.frames.size()) - count > kMaxPendingFrames / 2 || bytes > kMaxPendingBytes / 2) {
+            bytes -= stream.frames[count].data.size();
+            count++;
+        }
+        reportOnly(side, count, sink);
+    }
+}
+
+void StreamCompare::finish(const Sink &sink) {
+    if (m_mode == Bytes) {
+        closeRun(sink);
+        reportRest(A, sink);
+        reportRest(B, sink);
+        return;
+    }
+
+    compareFrames(true, sink);
+    reportOnly(A, qsizetype(m_streams[A].frames.size()), sink);
+    reportOnly(B, qsizetype(m_streams[B].frames.size()), sink);
+}
+
+qsizetype StreamCompare::pending(Side side) const {
+    const Stream &stream = m_streams[side];
+    return (m_mode == Bytes) ? stream.bytes.size() - stream.bytesStart : qsizetype(stream.frames.size());
+}
+
+bool StreamCompare::isEqual(const Frame &a, const Frame &b) {
+    return a.hash == b.hash && a.data == b.data;
+}
+
+void StreamCompare::compareFrames(bool isFinishing, const Sink &sink) {
+    std::deque<Frame> &a = m_streams[A].frames;
+    std::deque<Frame> &b = m_streams[B].frames;
+
+    while (a.empty() == false && b.empty() == false) {
+        if (isEqual(a.front(), b.front()) == true) {
+            m_stats.equal++;
+            popFrame(A);
+            popFrame(B);
+            continue;
+        }
+
+        // The nearest place the streams agree again says what happened: frames
+        // that line up after these two mean they were changed, the head of one
+        // side found further down the other means frames only the other sent
+        const size_t sizeA     = a.size();
+        const size_t sizeB     = b.size();
+        bool         isChanged = false;
+        for (size_t d = 1; d < size_t(kLookahead); d++) {
+            if (d < sizeA && d < sizeB && isEqual(a[d], b[d]) == true) {
+                isChanged = true;
+                break;
+            }
+            if (d < sizeA && isEqual(a[d], b.front()) == true) {
+                reportOnly(A, qsizetype(d), sink);
+                break;
+            }
+            if (d < sizeB && isEqual(b[d], a.front()) == true) {
+                reportOnly(B, qsizetype(d), sink);
+                break;
+            }
+        }
+        if (a.size() != sizeA || b.size() != sizeB) continue;
+        // Not enough seen of both sides yet to rule out frames only one of them sent
+        if (isChanged == false && isFinishing == false && (sizeA < size_t(kLookahead) || sizeB < size_t(kLookahead))) {
+            break;
+        }
+
+        const Frame &frameA = a.front();
+        const Frame &frameB = b.front();
+        const auto   ends   = std::mismatch(frameA.data.begin(), frameA.data.end(), frameB.data.begin(),
+                                            frameB.data.end());
+
+        Difference difference;
+        difference.kind      = Difference::Changed;
+        difference.positionA = frameA.number;
+        difference.positionB = frameB.number;
+        difference.offset    = qsizetype(ends.first - frameA.data.begin());
+        difference.a         = frameA.data;
+        difference.b         = frameB.data;
+        m_stats.changed++;
+        sink(difference);
+        popFrame(A);
+        popFrame(B);
+    }
+}
+
+void StreamCompare::popFrame(Side side) {
+    Stream &stream = m_streams[side];
+    stream.frameBytes -= stream.frames.front().data.size();
+    stream.frames.pop_front();
+}
+
+void StreamCompare::reportOnly(Side side, qsizetype count, const Sink &sink) {
+    const Stream &other = m_streams[(side == A) ? B : A];
+    // Where the frame would have been in the other stream
+    const quint64 otherPosition = (other.frames.empty() == true) ? other.count : other.frames.front().number;
+
+    for (qsizetype i = 0; i < count; i++) {
+        const Frame &frame = m_streams[side].frames.front();
+        Difference   difference;
+        if (side == A) {
+            difference.kind      = Difference::OnlyA;
+            difference.positionA = frame.number;
+            difference.positionB = otherPosition;
+            difference.a         = frame.data;
+            m_stats.onlyA++;
+        } else {
+            difference.kind      = Difference::OnlyB;
+            difference.positionA = otherPosition;
+            difference.positionB = frame.number;
+            difference.b         = frame.data;
+            m_stats.onlyB++;
+        }
+        sink(difference);
+        popFrame(side);
+    }
+}
+
+void StreamCompare::compareBytes(const Sink &sink) {
+    Stream         &a     = m_streams[A];
+    Stream         &b     = m_streams[B];
+    const qsizetype size  = qMin(a.bytes.size() - a.bytesStart, b.bytes.size() - b.bytesStart);
+    const char     *dataA = a.bytes.constData() + a.bytesStart;
+    const char     *dataB = b.bytes.constData() + b.bytesStart;
+
+    qsizetype i = 0;
+    while (i < size) {
+        if (m_runA.isEmpty() == true) {
+            // Equal stretches are skipped over without looking at single bytes
+            const qsizetype next = std::mismatch(dataA + i, dataA + size, dataB + i).first - dataA;
+            m_stats.equal += quint64(next - i);
+            i = next;
+            if (i == size) break;
+            m_runOffset = m_byteOffset + quint64(i);
+        }
+
+        for (; i < size; i++) {
+            m_runA.append(dataA[i]);
+            m_runB.append(dataB[i]);
+            m_runEqualTail = (dataA[i] == dataB[i]) ? m_runEqualTail + 1 : 0;
+            if (m_runEqualTail == kResyncBytes || m_runA.size() == kMaxRunBytes) {
+                i++;
+                closeRun(sink);
+                break;
+            }
+        }
+    }
+
+    a.bytesStart += size;
+    b.bytesStart += size;
+    m_byteOffset += quint64(size);
+
+    // One side is used up, the other may be too far ahead
+    for (Stream *stream : {&a, &b}) {
+        Stream         &other = (stream == &a) ? b : a;
+        const qsizetype ahead = stream->bytes.size() - stream->bytesStart;
+        if (ahead > kMaxPendingBytes) {
+            closeRun(sink);
+            const qsizetype dropped = ahead - kMaxPendingBytes / 2;
+
+            Difference difference;
+            difference.kind      = Difference::Skipped;
+            difference.positionA = m_byteOffset;
+            difference.positionB = m_byteOffset;
+            difference.offset    = dropped;
+            m_stats.skipped += quint64(dropped);
+            sink(difference);
+
+            stream->bytesStart += dropped;
+            other.skip += dropped;
+            m_byteOffset += quint64(dropped);
+        }
+
+        if (stream->bytesStart == stream->bytes.size()) {
+            stream->bytes.resize(0);  // keeps the capacity for what comes next
+            stream->bytesStart = 0;
+        } else if (stream->bytesStart >= kCompactBytes && stream->bytesStart * 2 >= stream->bytes.size()) {
+            stream->bytes.remove(0, stream->bytesStart);
+            stream->bytesStart = 0;
+        }
+    }
+}
+
+void StreamCompare::closeRun(const Sink &sink) {
+    if (m_runA.isEmpty() == true) return;
+
+    // The equal bytes that ended the run are not part of it
+    m_runA.chop(m_runEqualTail);
+    m_runB.chop(m_runEqualTail);
+    m_stats.equal += quint64(m_runEqualTail);
+    m_runEqualTail = 0;
+
+    Difference difference;
+    difference.kind      = Difference::Changed;
+    difference.positionA = m_runOffset;
+    difference.positionB = m_runOffset;
+    difference.offset    = m_runA.size();
+    difference.a         = std::exchange(m_runA, QByteArray());
+    difference.b         = std::exchange(m_runB, QByteArray());
+    m_stats.changed++;
+    sink(difference);
+}
+
+void StreamCompare::reportRest(Side side, const Sink &sink) {
+    Stream         &stream = m_streams[side];
+    const qsizetype rest   = stream.bytes.size() - stream.bytesStart;
+    if (rest <= 0) return;
+
+    // Only the start of it is kept for showing, the count says how much there was
+    const QByteArray head = stream.bytes.sliced(stream.bytesStart, qMin(rest, kMaxRunBytes));
+
+    Difference difference;
+    difference.kind      = (side == A) ? Difference::OnlyA : Difference::OnlyB;
+    difference.positionA = m_byteOffset;
+    difference.positionB = m_byteOffset;
+    difference.offset    = rest;
+    if (side == A) {
+        difference.a = head;
+        m_stats.onlyA += quint64(rest);
+    } else {
+        difference.b = head;
+        m_stats.onlyB += quint64(rest);
+    }
+    sink(difference);
+
+    stream.bytes.resize(0);
+    stream.bytesStart = 0;
+}
@@ -0,0 +1,117 @@
+#ifndef STREAMCOMPARE_H
+#define STREAMCOMPARE_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <deque>
+#include <functional>
+
+// Compares two receive streams, A and B, while they come in. Frames are paired
+// up in order; when two frames differ, a few frames ahead on both sides are
+// looked at to tell a changed frame from frames only one side sent, and the
+// pairing continues from where the streams agree again. By byte offset the
+// streams are compared byte for byte and runs of differing bytes are reported.
+// Only what one side is ahead of the other is held, up to a fixed limit, so
+// memory stays bounded however long the streams run; beyond the limit the
+// oldest data is given up as unmatched.
+class StreamCompare {
+   public:
+    enum Mode {
+        Frames,  // frame n of A against frame n of B, resynchronized after insertions
+        Bytes,   // byte n of A against byte n of B
+    };
+
+    enum Side {
+        A,
+        B,
+    };
+
+    struct Difference {
+        enum Kind {
+            Changed,  // frames or bytes at the same place differ
+            OnlyA,    // a frame only A sent, or bytes A sent past the end of B
+            OnlyB,    // the same for B
+            Skipped,  // bytes one side was too far ahead with, not compared
+        };
+
+        Kind       kind;
+        quint64    positionA = 0;  // frame number or byte offset in A, counted from 0
+        quint64    positionB = 0;
+        qsizetype  offset    = 0;  // Changed frames: first byte that differs; Bytes mode: number of bytes
+        QByteArray a;              // the frame or the run of bytes, empty for the side it is not in
+        QByteArray b;
+    };
+
+    struct Stats {
+        quint64 equal   = 0;  // frames, or bytes in Bytes mode
+        quint64 changed = 0;  // frames, or runs of bytes in Bytes mode
+        quint64 onlyA   = 0;  // frames, or bytes A sent past the end of B in Bytes mode
+        quint64 onlyB   = 0;
+        quint64 skipped = 0;  // bytes
+    };
+
+    using Sink = std::function<void(const Difference &difference)>;
+
+    // Frames looked ahead on both sides before two differing frames count as changed
+    static constexpr int kLookahead = 8;
+    // What one side may be ahead of the other before its oldest data is given up
+    static constexpr qsizetype kMaxPendingFrames = 4096;
+    static constexpr qsizetype kMaxPendingBytes  = 1024 * 1024;
+    // Bytes mode: equal bytes that end a run of differences, and the longest run reported in one piece
+    static constexpr qsizetype kResyncBytes = 8;
+    static constexpr qsizetype kMaxRunBytes = 256;
+
+    explicit StreamCompare(Mode mode = Frames) : m_mode(mode) {}
+
+    Mode mode() const { return m_mode; }
+    // Starts over, both streams from the beginning
+    void setMode(Mode mode);
+    void reset();
+
+    // A frame, or in Bytes mode any number of bytes; the sink gets every difference this settles
+    void add(Side side, QByteArrayView data, const Sink &sink);
+    // No more data will come: everything still waiting for the other side is reported
+    void finish(const Sink &sink);
+
+    const Stats &stats() const { return m_stats; }
+    // Frames, or bytes in Bytes mode, held for want of the other side
+    qsizetype pending(Side side) const;
+
+   private:
+    struct Frame {
+        QByteArray data;
+        size_t     hash;
+        quint64    number;
+    };
+
+    struct Stream {
+        std::deque<Frame> frames;
+        qsizetype         frameBytes = 0;
+        QByteArray        bytes;  // Bytes mode, from bytesStart on
+        qsizetype         bytesStart = 0;
+        qsizetype         skip       = 0;  // Bytes mode: the other side gave these up, dropped as they come
+        quint64           count      = 0;  // frames added
+    };
+
+    static bool isEqual(const Frame &a, const Frame &b);
+
+    void compareFrames(bool isFinishing, const Sink &sink);
+    void popFrame(Side side);
+    void reportOnly(Side side, qsizetype count, const Sink &sink);
+    void compareBytes(const Sink &sink);
+    void closeRun(const Sink &sink);
+    void reportRest(Side side, const Sink &sink);
+
+    Mode    m_mode;
+    Stream  m_streams[2];
+    Stats   m_stats;
+    quint64 m_byteOffset = 0;  // Bytes mode: of the next byte compared, the same in both streams
+
+    // Bytes mode: the run of differences being collected, equal bytes inside it included
+    QByteArray m_runA;
+    QByteArray m_runB;
+    quint64    m_runOffset    = 0;
+    qsizetype  m_runEqualTail = 0;  // equal bytes at the end of the run
+};
+
+#endif  // STREAMCOMPARE_H
@@ -0,0 +1,50 @@
+#include "timestampformatter.h"
+
+#include <QDateTime>
+
+using namespace Qt::StringLiterals;
+
+static constexpr qint64 kNsPerSecond = 1000LL * 1000 * 1000;
+static constexpr qint64 kNsPerMinute = 60 * kNsPerSecond;
+
+// value with at least width digits, zero padded
+static void appendDigits(QString &out, quint64 value, int width) {
+    char16_t digits[20];
+    int      count = 0;
+    do {
+        digits[count++] = char16_t(u'0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (count < width) digits[count++] = u'0';
+    while (count > 0) out += QChar(digits[--count]);
+}
+
+void TimestampFormatter::appendAbsolute(qint64 realtimeNs, QString &out) const {
+    // Time zone changes fall on whole minutes, so the prefix holds for all of it
+    const qint64 minute = (realtimeNs >= 0) ? realtimeNs / kNsPerMinute : (realtimeNs + 1) / kNsPerMinute - 1;
+    if (minute != m_cachedMinute) {
+        m_cachedMinute = minute;
+        m_cachedPrefix = QDateTime::fromMSecsSinceEpoch(minute * 60 * 1000).toString(u"yyyy-MM-dd hh:mm:"_s);
+    }
+
+    const qint64 inMinuteNs = realtimeNs - minute * kNsPerMinute;
+    out += m_cachedPrefix;
+    appendDigits(out, quint64(inMinuteNs / kNsPerSecond), 2);
+    appendFraction(inMinuteNs % kNsPerSecond, out);
+}
+
+void TimestampFormatter::appendDelta(qint64 deltaNs, QString &out) const {
+    out += (deltaNs < 0) ? u'-' : u'+';
+    const quint64 magnitude = quint64((deltaNs < 0) ? -deltaNs : deltaNs);
+    appendDigits(out, magnitude / kNsPerSecond, 1);
+    appendFraction(qint64(magnitude % kNsPerSecond), out);
+}
+
+void TimestampFormatter::appendFraction(qint64 ns, QString &out) const {
+    out += u'.';
+    if (m_resolution == Microseconds) {
+        appendDigits(out, quint64(ns / 1000), 6);
+    } else {
+        appendDigits(out, quint64(ns / (1000 * 1000)), 3);
+    }
+}
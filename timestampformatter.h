@@ -0,0 +1,35 @@
+#ifndef TIMESTAMPFORMATTER_H
+#define TIMESTAMPFORMATTER_H
+
+#include <QString>
+
+// Writes log time stamps from raw nanosecond counts without QDateTime or
+// QString::arg. The local date and time down to the minute is formatted once
+// per minute and reused, the seconds and the fraction are written digit by
+// digit, so formatting a visible row costs about as much as copying it.
+class TimestampFormatter {
+   public:
+    enum Resolution {
+        Milliseconds,
+        Microseconds,
+    };
+
+    Resolution resolution() const { return m_resolution; }
+    void       setResolution(Resolution resolution) { m_resolution = resolution; }
+
+    // "2026-10-18 12:03:04.123", or ".123456" down to the microsecond; local time
+    void appendAbsolute(qint64 realtimeNs, QString &out) const;
+
+    // "+0.001234" seconds, or "+0.001" in milliseconds
+    void appendDelta(qint64 deltaNs, QString &out) const;
+
+   private:
+    void appendFraction(qint64 ns, QString &out) const;
+
+    Resolution m_resolution = Milliseconds;
+
+    mutable qint64  m_cachedMinute = -1;  // minutes since the epoch the prefix is for
+    mutable QString m_cachedPrefix;       // "2026-10-18 12:03:"
+};
+
+#endif  // TIMESTAMPFORMATTER_H
@@ -0,0 +1,224 @@
+#include "transmitscheduler.h"
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+#include "serialworker.h"
+#include "sessionformat.h"
+
+#ifdef Q_OS_LINUX
+#include <sys/prctl.h>
+#include <time.h>
+
+#include <cerrno>
+#endif
+
+using namespace Qt::StringLiterals;
+
+namespace {
+
+// Lateness buckets: < 1 us, < 2 us, < 4 us, ... and everything from 16 ms up
+constexpr int kBuckets = 16;
+
+struct Lateness {
+    quint64                       samples = 0;  // one per period that was written
+    quint64                       bytes   = 0;
+    qint64                        sumNs   = 0;
+    qint64                        maxNs   = 0;
+    std::array<quint64, kBuckets> histogram{};
+
+    void add(qint64 lateNs, quint64 written) {
+        samples++;
+        bytes += written;
+        sumNs += lateNs;
+        maxNs = qMax(maxNs, lateNs);
+
+        int bucket = 0;
+        for (qint64 us = lateNs / 1000; us > 0 && bucket < kBuckets - 1; us >>= 1) bucket++;
+        histogram[bucket]++;
+    }
+
+    void merge(const Lateness &other) {
+        samples += other.samples;
+        bytes += other.bytes;
+        sumNs += other.sumNs;
+        maxNs = qMax(maxNs, other.maxNs);
+        for (int i = 0; i < kBuckets; i++) histogram[i] += other.histogram[i];
+    }
+};
+
+// Filled in the worker thread, taken by the scheduler thread once a second
+struct SharedStats {
+    std::mutex       mutex;
+    Lateness         lateness;
+    std::atomic<int> inFlight{0};
+};
+
+// Upper bound of the bucket that holds the given fraction of the samples
+qint64 percentileUs(const Lateness &lateness, double fraction) {
+    const quint64 rank = quint64(fraction * double(lateness.samples));
+    quint64       seen = 0;
+    for (int i = 0; i < kBuckets; i++) {
+        seen += lateness.histogram[i];
+        if (seen > rank) return qint64(1) << i;
+    }
+    return qint64(1) << (kBuckets - 1);
+}
+
+QString summaryText(const Lateness &lateness, quint64 periods, quint64 missed, qint64 elapsedNs) {
+    const double seconds = double(qMax<qint64>(elapsedNs, 1)) / 1e9;
+    QString      text    = QObject::tr("TX %1 periods/s, %2 bytes, %3 missed")
+                         .arg(double(periods) / seconds, 0, 'f', 1)
+                         .arg(lateness.bytes)
+                         .arg(missed);
+    if (lateness.samples == 0) return text;
+
+    text += QObject::tr(", jitter mean %1 us, p99 < %2 us, max %3 us, histogram")
+                .arg(double(lateness.sumNs) / double(lateness.samples) / 1000.0, 0, 'f', 1)
+                .arg(percentileUs(lateness, 0.99))
+                .arg(double(lateness.maxNs) / 1000.0, 0, 'f', 1);
+    for (int i = 0; i < kBuckets; i++) {
+        if (lateness.histogram[i] == 0) continue;
+        const QString bound = (i == kBuckets - 1) ? u">="_s + QString::number(1 << (i - 1)) : u"<"_s + QString::number(1 << i);
+        text += u" %1:%2"_s.arg(bound).arg(lateness.histogram[i]);
+    }
+    return text;
+}
+
+void sleepUntil(qint64 deadlineNs, const std::atomic<bool> &isStopping) {
+    // Sleep in slices so that stop() never has to wait for a long period
+    constexpr qint64 kSliceNs = 50 * 1000 * 1000;
+    while (isStopping.load(std::memory_order_relaxed) == false) {
+        const qint64 nowNs = SessionFormat::monotonicNs();
+        if (nowNs >= deadlineNs) return;
+
+        const qint64 wakeNs = qMin(deadlineNs, nowNs + kSliceNs);
+#ifdef Q_OS_LINUX
+        // steady_clock is CLOCK_MONOTONIC, so the deadline can be used as it is
+        timespec wake;
+        wake.tv_sec  = time_t(wakeNs / 1000000000);
+        wake.tv_nsec = long(wakeNs % 1000000000);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, nullptr) == EINTR) {
+        }
+#else
+        std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(wakeNs)));
+#endif
+    }
+}
+
+}  // namespace
+
+TransmitScheduler::TransmitScheduler(SerialWorker *worker, QObject *parent) : QObject(parent), m_worker(worker) {
+}
+
+TransmitScheduler::~TransmitScheduler() {
+    stop();
+}
+
+void TransmitScheduler::start(const Options &options) {
+    stop();
+
+    m_options           = options;
+    m_options.period_us = qMax<qint64>(1, m_options.period_us);
+    m_options.burst     = qMax(1, m_options.burst);
+    m_isStopping.store(false, std::memory_order_relaxed);
+    m_isRunning.store(true, std::memory_order_release);
+    m_thread = std::thread(&TransmitScheduler::run, this);
+}
+
+void TransmitScheduler::stop() {
+    if (m_thread.joinable() == false) return;
+
+    m_isStopping.store(true, std::memory_order_relaxed);
+    m_thread.join();
+}
+
+void TransmitScheduler::run() {
+#ifdef Q_OS_LINUX
+    // The default 50 us timer slack would be most of a sub-millisecond period
+    prctl(PR_SET_TIMERSLACK, 1UL);
+#endif
+
+    using SessionFormat::monotonicNs;
+    constexpr qint64 kSummaryNs = 1000 * 1000 * 1000;
+
+    const auto       stats    = std::make_shared<SharedStats>();
+    const qint64     periodNs = m_options.period_us * 1000;
+    const qint64     startNs  = monotonicNs();
+    const QByteArray payload  = m_options.payload;
+    const int        burst    = m_options.burst;
+    SerialWorker    *worker   = m_worker;
+
+    Lateness total;
+    quint64  periods       = 0;
+    quint64  missed        = 0;
+    quint64  totalPeriods  = 0;
+    quint64  totalMissed   = 0;
+    qint64   summaryNs     = startNs;
+    qint64   nextSummaryNs = startNs + kSummaryNs;
+
+    const auto report = [&](qint64 nowNs, bool isFinal) {
+        Lateness lateness;
+        {
+            std::lock_guard<std::mutex> lock(stats->mutex);
+            std::swap(lateness, stats->lateness);
+        }
+        total.merge(lateness);
+        totalPeriods += periods;
+        totalMissed += missed;
+
+        if (isFinal == true) {
+            emit summary(summaryText(total, totalPeriods, totalMissed, nowNs - startNs), true);
+        } else {
+            emit summary(summaryText(lateness, periods, missed, nowNs - summaryNs), false);
+        }
+        periods   = 0;
+        missed    = 0;
+        summaryNs = nowNs;
+    };
+
+    qint64 tick = 0;
+    while ((m_isStopping.load(std::memory_order_relaxed) == false) &&
+           ((m_options.periods == 0) || (tick < m_options.periods))) {
+        const qint64 deadlineNs = startNs + tick * periodNs;
+        sleepUntil(deadlineNs, m_isStopping);
+        if (m_isStopping.load(std::memory_order_relaxed) == true) break;
+
+        // Deadlines that already passed are dropped rather than sent in a catch-up burst
+        const qint64 nowNs  = monotonicNs();
+        const qint64 behind = (nowNs - deadlineNs) / periodNs;
+        if (behind > 0) {
+            missed += quint64(behind);
+            tick += behind;
+        }
+
+        // Beyond the writes the worker may have in flight ticks are dropped
+        if (stats->inFlight.load(std::memory_order_acquire) >= SerialWorker::kMaxWritesInFlight) {
+            missed++;
+        } else {
+            stats->inFlight.fetch_add(1, std::memory_order_acq_rel);
+            periods++;
+            QMetaObject::invokeMethod(worker, [worker, payload, burst, deadlineNs, stats]() {
+                const qint64 lateNs = monotonicNs() - deadlineNs;
+                for (int i = 0; i < burst; i++) worker->write(payload);
+                stats->inFlight.fetch_sub(1, std::memory_order_acq_rel);
+
+                std::lock_guard<std::mutex> lock(stats->mutex);
+                stats->lateness.add(lateNs, quint64(payload.size()) * quint64(burst));
+            });
+        }
+        tick++;
+
+        if (nowNs >= nextSummaryNs) {
+            report(nowNs, false);
+            nextSummaryNs += kSummaryNs * (1 + (nowNs - nextSummaryNs) / kSummaryNs);
+        }
+    }
+
+    // Wait until the worker has written everything that was handed over
+    QMetaObject::invokeMethod(m_worker, []() {}, Qt::BlockingQueuedConnection);
+    report(monotonicNs(), true);
+    m_isRunning.store(false, std::memory_order_release);
+}
@@ -0,0 +1,47 @@
+#ifndef TRANSMITSCHEDULER_H
+#define TRANSMITSCHEDULER_H
+
+#include <QByteArray>
+#include <QObject>
+#include <atomic>
+#include <thread>
+
+class SerialWorker;
+
+// Periodic transmit of a pre-encoded payload. A dedicated thread sleeps to
+// absolute deadlines (clock_nanosleep on Linux) and hands every period's burst
+// to the serial worker; how late each write actually happened is collected
+// into a histogram, which is reported once a second instead of logging sends.
+class TransmitScheduler : public QObject {
+    Q_OBJECT
+
+   public:
+    struct Options {
+        QByteArray payload;
+        qint64     period_us = 1000;
+        int        burst     = 1;  // payloads written per period
+        qint64     periods   = 0;  // 0 = until stopped
+    };
+
+    explicit TransmitScheduler(SerialWorker *worker, QObject *parent = nullptr);
+    ~TransmitScheduler();
+
+    void start(const Options &options);
+    void stop();
+    bool isRunning() const { return m_isRunning.load(std::memory_order_acquire); }
+
+   signals:
+    // Once a second while running, and a last time for the whole run when it ends
+    void summary(const QString &text, bool isFinal);
+
+   private:
+    void run();
+
+    SerialWorker     *m_worker;
+    Options           m_options;
+    std::thread       m_thread;
+    std::atomic<bool> m_isStopping{false};
+    std::atomic<bool> m_isRunning{false};
+};
+
+#endif  // TRANSMITSCHEDULER_H
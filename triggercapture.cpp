@@ -0,0 +1,184 @@
+#include "triggercapture.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <cstring>
+
+#include "serialworker.h"
+
+using namespace Qt::StringLiterals;
+using namespace SessionFormat;
+
+// The ring is dropped a block at a time, so it holds at least its size less one block
+static constexpr qsizetype kRingBlockSize = 64 * 1024;
+
+TriggerCapture::TriggerCapture(SerialWorker *worker) : m_worker(worker), m_postTimer(new QTimer(this)) {
+    m_postTimer->setSingleShot(true);
+
+    connect(m_postTimer, &QTimer::timeout, this, &TriggerCapture::finishCapture);
+    connect(m_worker, &SerialWorker::chunkReceived, this, &TriggerCapture::chunkReceived);
+    connect(m_worker, &SerialWorker::chunkWritten, this, &TriggerCapture::chunkWritten);
+}
+
+bool TriggerCapture::start(const Options &options, QString *errorString) {
+    stop();
+
+    QString error;
+    if (options.type == Pattern && options.pattern.isEmpty() == true) error = tr("the trigger pattern is empty");
+    if (options.type == Regex) {
+        m_regex = QRegularExpression(options.regex);
+        if (m_regex.isValid() == false) error = m_regex.errorString();
+        m_regex.optimize();
+    }
+    if (QDir(options.directory).exists() == false) {
+        error = tr("the folder %1 does not exist").arg(QDir::toNativeSeparators(options.directory));
+    }
+    if (error.isEmpty() == false) {
+        if (errorString != nullptr) *errorString = error;
+        return false;
+    }
+
+    m_options = options;
+    m_matcher = StreamMatcher(options.pattern);
+    m_regexWindow.clear();
+    m_ring.assign(std::size_t(qMax<qint64>(2, (options.preTriggerSize + kRingBlockSize - 1) / kRingBlockSize)),
+                  QByteArray());
+    for (QByteArray &block : m_ring) block.reserve(kRingBlockSize);
+    m_head       = 0;
+    m_lastReadNs = 0;
+    m_isArmed    = true;
+    return true;
+}
+
+void TriggerCapture::stop() {
+    // A capture in progress is saved with what it has so far
+    finishCapture();
+    m_isArmed = false;
+    std::vector<QByteArray>().swap(m_ring);
+}
+
+void TriggerCapture::chunkReceived(const QByteArray &chunk, qint64 timestampNs) {
+    if (m_isArmed == false) return;
+
+    if (m_isCapturing == true) {
+        m_recorder.record(Received, chunk, timestampNs);
+        m_lastReadNs = timestampNs;
+        return;
+    }
+
+    // The chunk that fired the trigger is the last one before the post-trigger window
+    QString    reason;
+    const bool isFired = evaluate(chunk, timestampNs, reason);
+    append(Received, chunk.constData(), chunk.size(), timestampNs);
+    if (isFired == true) fire(reason);
+}
+
+void TriggerCapture::chunkWritten(const QByteArray &chunk, qint64 timestampNs) {
+    if (m_isArmed == false) return;
+
+    if (m_isCapturing == true) {
+        m_recorder.record(Transmitted, chunk, timestampNs);
+    } else {
+        append(Transmitted, chunk.constData(), chunk.size(), timestampNs);
+    }
+}
+
+void TriggerCapture::append(Direction direction, const char *data, qsizetype size, qint64 timestampNs) {
+    RecordHeader header{};
+    header.timestampNs = timestampNs;
+    header.direction   = direction;
+
+    // A chunk larger than a block goes in as several records with the same time stamp
+    while (size > 0) {
+        const qsizetype piece = qMin(size, kRingBlockSize - qsizetype(sizeof(header)));
+        if (m_ring[m_head].size() + qsizetype(sizeof(header)) + piece > kRingBlockSize) {
+            m_head = (m_head + 1) % m_ring.size();
+            m_ring[m_head].resize(0);  // keeps the capacity
+        }
+
+        QByteArray &block = m_ring[m_head];
+        header.length     = quint32(piece);
+        block.append(reinterpret_cast<const char *>(&header), sizeof(header));
+        block.append(data, piece);
+        data += piece;
+        size -= piece;
+    }
+}
+
+bool TriggerCapture::evaluate(const QByteArray &chunk, qint64 timestampNs, QString &reason) {
+    const qint64 idleNs = (m_lastReadNs > 0) ? timestampNs - m_lastReadNs : 0;
+    m_lastReadNs        = timestampNs;
+
+    switch (m_options.type) {
+        case Pattern:
+            if (m_matcher.feed(chunk) < 0) return false;
+            reason = tr("pattern received");
+            return true;
+        case Regex: {
+            m_regexWindow.append(QLatin1StringView(chunk));
+            const QRegularExpressionMatch match = m_regex.match(m_regexWindow);
+            if (match.hasMatch() == true) {
+                reason = tr("\"%1\" received").arg(match.captured());
+                m_regexWindow.clear();
+                return true;
+            }
+            // Whatever matched in the window before has fired already
+            if (m_regexWindow.size() > kRegexWindow) m_regexWindow.remove(0, m_regexWindow.size() - kRegexWindow);
+            return false;
+        }
+        case Gap:
+            if (idleNs <= qint64(m_options.gap_ms) * 1000 * 1000) return false;
+            reason = tr("line idle for %1 ms").arg(double(idleNs) / 1e6, 0, 'f', 1);
+            return true;
+    }
+    return false;
+}
+
+void TriggerCapture::fire(const QString &reason) {
+    const QString stamp    = QDateTime::currentDateTime().toString(u"yyyyMMdd-hhmmss-zzz"_s);
+    const QString fileName = QDir(m_options.directory).filePath(u"trigger-%1.cps"_s.arg(stamp));
+    QString       errorString;
+    if (m_recorder.start(fileName, &errorString) == false) {
+        // Stays armed, the ring keeps going
+        emit failed(tr("%1: %2").arg(QDir::toNativeSeparators(fileName), errorString));
+        return;
+    }
+    emit triggered(reason);
+
+    // The ring from its oldest block on, the port settings ahead of the first record
+    bool isFirst = true;
+    for (std::size_t i = 1; i <= m_ring.size(); i++) {
+        QByteArray &block = m_ring[(m_head + i) % m_ring.size()];
+        qsizetype   pos   = 0;
+        while (pos + qsizetype(sizeof(RecordHeader)) <= block.size()) {
+            RecordHeader header;
+            std::memcpy(&header, block.constData() + pos, sizeof(header));
+            if (isFirst == true) {
+                const PortSettings settings = m_worker->portSettings();
+                m_recorder.record(Settings, reinterpret_cast<const char *>(&settings), sizeof(settings),
+                                  header.timestampNs);
+                isFirst = false;
+            }
+            m_recorder.record(Direction(header.direction), block.constData() + pos + sizeof(header), header.length,
+                              header.timestampNs);
+            pos += qsizetype(sizeof(header)) + header.length;
+        }
+        block.resize(0);
+    }
+
+    m_isCapturing = true;
+    m_postTimer->start(m_options.postTrigger_ms);
+}
+
+void TriggerCapture::finishCapture() {
+    if (m_isCapturing == false) return;
+
+    m_postTimer->stop();
+    m_isCapturing = false;
+    m_recorder.stop();
+    emit saved(m_recorder.fileName(), m_recorder.bytesWritten());
+
+    // Rearmed on what comes after the capture
+    m_matcher.reset();
+    m_regexWindow.clear();
+}
@@ -0,0 +1,85 @@
+#ifndef TRIGGERCAPTURE_H
+#define TRIGGERCAPTURE_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QRegularExpression>
+#include <QString>
+#include <QTimer>
+#include <vector>
+
+#include "sequence.h"
+#include "sessionrecorder.h"
+
+class SerialWorker;
+
+// Keeps the most recent RX/TX traffic of one worker in a fixed size ring and
+// saves it as a session file when a trigger fires on the received stream,
+// followed by what comes in over the post-trigger window. The ring is a set of
+// preallocated blocks filled in turn, the oldest one being overwritten as a
+// whole, so recording costs one copy per chunk and no allocation. Lives in the
+// worker's thread, like the SequenceRunner, and rearms after every capture.
+class TriggerCapture : public QObject {
+    Q_OBJECT
+
+   public:
+    enum Type {
+        Pattern,  // the bytes show up, also across reads
+        Regex,    // matched against the received bytes as Latin-1, up to kRegexWindow back
+        Gap,      // data after the line was idle for longer than gap_ms
+    };
+
+    struct Options {
+        Type       type = Pattern;
+        QByteArray pattern;
+        QString    regex;
+        int        gap_ms         = 1000;
+        qint64     preTriggerSize = 4 * 1024 * 1024;  // bytes of the ring
+        int        postTrigger_ms = 2000;
+        QString    directory;  // captures are named trigger-<date>-<time>.cps in there
+    };
+
+    static constexpr int kRegexWindow = 256;
+
+    explicit TriggerCapture(SerialWorker *worker);
+
+    bool isArmed() const { return m_isArmed; }
+
+   public slots:
+    // Called in the worker thread
+    bool start(const Options &options, QString *errorString = nullptr);
+    void stop();
+
+   signals:
+    void triggered(const QString &reason);
+    void saved(const QString &fileName, quint64 bytes);
+    void failed(const QString &errorString);
+
+   private slots:
+    void finishCapture();
+
+   private:
+    void chunkReceived(const QByteArray &chunk, qint64 timestampNs);
+    void chunkWritten(const QByteArray &chunk, qint64 timestampNs);
+    void append(SessionFormat::Direction direction, const char *data, qsizetype size, qint64 timestampNs);
+    bool evaluate(const QByteArray &chunk, qint64 timestampNs, QString &reason);
+    void fire(const QString &reason);
+
+    SerialWorker *m_worker;
+    QTimer       *m_postTimer = nullptr;
+
+    Options            m_options;
+    StreamMatcher      m_matcher;
+    QRegularExpression m_regex;
+    QString            m_regexWindow;  // the last received bytes, for matches that span reads
+
+    std::vector<QByteArray> m_ring;  // blocks of records, as in a session file
+    std::size_t             m_head = 0;  // the block being filled
+
+    SessionRecorder m_recorder;  // the capture being saved
+    qint64          m_lastReadNs  = 0;
+    bool            m_isArmed     = false;
+    bool            m_isCapturing = false;
+};
+
+#endif  // TRIGGERCAPTURE_H
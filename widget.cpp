@@ -4,148 +4,97 @@
 
 using namespace Qt::StringLiterals;
 
-Widget::Widget(QWidget *parent)
+// Received packets are drawn at most this often, whatever rate they arrive at
+static constexpr int kFrameInterval_ms = 33;
+
+// With the display sampled, packets beyond this many per frame are only counted
+static constexpr int kSampledPacketsPerFrame = 64;
+
+// Enough for a 64 KB binary blob pasted as spaced hex, with room to spare
+static constexpr int kMaxSendTextLength = 1024 * 1024;
+
+Widget::Widget(SerialSession *session, PortMonitor *portMonitor, QWidget *parent)
     : QWidget(parent),
       m_ui(new Ui::Widget),
-      m_serialPort(new QSerialPort(this)),
-      m_receiveMessageTimer(new QTimer(this)),
-      m_repetitionTimer(new QTimer(this)),
-      m_displayTimeTimer(new QTimer(this)) {
+      m_session(session),
+      m_serialWorker(session->worker()),
+      m_portMonitor(portMonitor),
+      m_portReconnector(new PortReconnector(session->worker(), portMonitor, this)),
+      m_transmitScheduler(new TransmitScheduler(session->worker(), this)),
+      m_sequenceRunner(new SequenceRunner(session->worker())),
+      m_fileSender(new FileSender(session->worker())),
+      m_triggerCapture(new TriggerCapture(session->worker())),
+      m_serialBridge(new SerialBridge(session->worker())),
+      m_displayTimeTimer(new QTimer(this)),
+      m_renderTimer(new QTimer(this)),
+      m_logModel(session->logModel()),
+      m_logSearch(new LogSearch(session->logModel(), this)),
+      m_metrics(new MetricsCollector(session->worker(), this)) {
     m_ui->setupUi(this);
-    this->setWindowTitle("Serial Port Exercise");
+
+    // Sequences react to received chunks, so they run where the chunks are read
+    m_sequenceRunner->moveToThread(m_serialWorker->thread());
+    // Files are paced by the port's bytesWritten, which is emitted there too
+    m_fileSender->moveToThread(m_serialWorker->thread());
+    // The ring is filled with every chunk as it is read or written
+    m_triggerCapture->moveToThread(m_serialWorker->thread());
+    // Clients get the chunks as they are read, and their sockets are served there too
+    m_serialBridge->moveToThread(m_serialWorker->thread());
+
+    m_ui->dataLogView->setModel(m_logModel);
+    m_logModel->setMemoryBudget(qint64(m_ui->logLimitSpinBox->value()) * 1024 * 1024);
 
     // Create a validator
     m_hexStringValidator = new HexStringValidator(this);
 
     initialization();
 
-    adjustComboBoxViewWidth(m_ui->serialPortComboxBox);
-    adjustComboBoxViewWidth(m_ui->flowControlComboBox);
+    // Measuring every item takes a while with many ports, it waits for the first popup
+    m_unsizedComboBoxes << m_ui->serialPortComboxBox << m_ui->flowControlComboBox;
+    m_ui->serialPortComboxBox->installEventFilter(this);
+    m_ui->flowControlComboBox->installEventFilter(this);
 }
 
 Widget::~Widget() {
+    // Session viewers may be replaying through the worker, they have to go before it does
+    qDeleteAll(findChildren<SessionViewer *>(Qt::FindDirectChildrenOnly));
+    delete m_metricsPanel;
+    m_transmitScheduler->stop();
+    QMetaObject::invokeMethod(
+        m_sequenceRunner, [runner = m_sequenceRunner]() { runner->stop(); }, Qt::BlockingQueuedConnection);
+    m_sequenceRunner->deleteLater();
+    QMetaObject::invokeMethod(
+        m_fileSender, [sender = m_fileSender]() { sender->stop(); }, Qt::BlockingQueuedConnection);
+    m_fileSender->deleteLater();
+    QMetaObject::invokeMethod(
+        m_triggerCapture, [capture = m_triggerCapture]() { capture->stop(); }, Qt::BlockingQueuedConnection);
+    m_triggerCapture->deleteLater();
+    saveSettings();
+    QMetaObject::invokeMethod(
+        m_serialBridge, [bridge = m_serialBridge]() { bridge->stop(); }, Qt::BlockingQueuedConnection);
+    m_serialBridge->deleteLater();
     delete m_ui;
 }
 
-static const QString timeString(QString str, bool en) {
-    QString s = QString("[%1 %2]# %3 %4")
-                    .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd"))
-                    .arg(QDateTime::currentDateTime().toString("hh:mm:ss.zzz"))
-                    .arg(str)
-                    .arg(((en == true) ? "HEX" : "ASCII"));
-    return s;
-}
-
-static const QByteArray insertSpaceBetweenByte(QByteArray input) {
-    quint8     cursorSpace = 0;
-    QByteArray output      = nullptr;
-    for (int index = 0; index < input.toHex().size(); index++) {
-        output.append(input.toHex().toUpper().at(index));
-        if ((++cursorSpace >= 2) && (index < (input.toHex().size() - 1))) {
-            cursorSpace = 0;
-            output.append(' ');
-        }
-    }
-    return output;
-}
-
-static const QRegularExpression &threeHexDigitsPattern() {
-    static const QRegularExpression result(u"[[:xdigit:]]{3}"_s);
-    Q_ASSERT(result.isValid());
-    return result;
-}
-
-static const QRegularExpression &oneDigitAndSpacePattern() {
-    static const QRegularExpression result(u"((\\s+)|^)([[:xdigit:]]{1})(\\s+)"_s);
-    Q_ASSERT(result.isValid());
-    return result;
-}
-
-const QRegularExpression &hexNumberPattern() {
-    static const QRegularExpression result;
-    Q_ASSERT(result.isValid());
-    return result;
-}
-
-const QRegularExpression &twoSpacesPattern() {
-    static const QRegularExpression result(u"([\\s]{2})"_s);
-    Q_ASSERT(result.isValid());
-    return result;
-}
-
-// Formats a string of hex characters with a space between every byte
-// Example: "012345" -> "01 23 45"
-static QString formatHexData(const QString &input) {
-    QString            out = input;
-    QRegularExpression regx(u"(\\s[[:xdigit:]])$"_s);
-
-    while (true) {
-        if (auto match = threeHexDigitsPattern().match(out); match.hasMatch()) {
-            out.insert(match.capturedEnd() - 1, u' ');
-        } else if (match = oneDigitAndSpacePattern().match(out); match.hasMatch()) {
-            const auto pos = match.capturedEnd() - 1;
-            if (out.at(pos) == u' ') {
-                out.insert(pos - 1, u'0');
-            }
-        } else {
-            if (match = regx.match(out); match.hasMatch()) {
-                const auto pos = match.capturedEnd() - 1;
-                out.insert(pos, u'0');
-            }
-            break;
-        }
-    }
-
-    return out.simplified().toUpper();
-}
-
 HexStringValidator::HexStringValidator(QObject *parent) : QValidator(parent) {
 }
 
 QValidator::State HexStringValidator::validate(QString &input, int &pos) const {
-    QRegularExpression regxNonHexdecimal(u"[^[:xdigit:]|^ ]+"_s);
-    QString            data = nullptr;
-
-    data = input.replace(regxNonHexdecimal, u""_s);
-
-    data.remove(u' ');
-
-    if (data.isEmpty()) return Intermediate;
-
-    // check if all input is valid
-    if (!hexNumberPattern().match(data).hasMatch()) return Invalid;
-
-    // don't allow user to enter more than one space
-    if (const auto match = twoSpacesPattern().match(input); match.hasMatch()) {
-        input.replace(match.capturedStart(), 2, ' ');
-        pos = match.capturedEnd() - 1;
-    }
-
-    // insert a space after every two hex nibbles
-    while (true) {
-        const QRegularExpressionMatch match = threeHexDigitsPattern().match(input);
-        if (!match.hasMatch()) break;
-        const auto start = match.capturedStart();
-        const auto end   = match.capturedEnd();
-        if (pos == start + 1) {
-            // add one hex nibble before two - Abc
-            input.insert(pos + 1, u' ');
-        } else if (pos == start + 2) {
-            // add hex nibble in the middle - aBc
-            input.insert(end - 1, u' ');
-            pos = end;
-        } else {
-            // add one hex nibble after two - abC
-            input.insert(end - 1, u' ');
-            pos = end + 1;
-        }
-    }
-
-    return Acceptable;
+    // One linear pass per keystroke, pasting a large blob costs the same as typing it
+    HexDump::normalizeHexInput(input, pos);
+    return (input.isEmpty() == true) ? Intermediate : Acceptable;
 }
 
 void Widget::initialization() {
-    m_ui->repetitionLineEdit->setValidator(new QIntValidator(0, INT_FAST16_MAX, this));
+    // Periods down to a microsecond, the scheduler does not depend on the GUI event loop
+    auto *periodValidator = new QDoubleValidator(0.001, 3600000, 3, this);
+    periodValidator->setNotation(QDoubleValidator::StandardNotation);
+    periodValidator->setLocale(QLocale::c());
+    m_ui->repetitionLineEdit->setValidator(periodValidator);
+
+    // Room for pasting large hex blobs, QLineEdit stops at 32767 characters by default
+    m_ui->dataSendLineEdit->setMaxLength(kMaxSendTextLength);
+    connect(m_ui->dataSendLineEdit, &QLineEdit::textChanged, this, [this]() { m_isSendPayloadValid = false; });
 
     m_ui->recvOptionsButtonGroup->setId(m_ui->isRecvAsciiRadioButton, 0);
     m_ui->recvOptionsButtonGroup->setId(m_ui->isRecvHexRadioButton, 1);
@@ -153,114 +102,208 @@ void Widget::initialization() {
     m_ui->sendOptionsButtonGroup->setId(m_ui->isSendHexRadioButton, 1);
 
     // create connection
-    connect(m_ui->refreshPushButton, &QPushButton::clicked, this, [this]() {
-        m_ui->serialPortComboxBox->clear();
-        // Search all available serial ports
-        const auto infos = QSerialPortInfo::availablePorts();
-        for (const QSerialPortInfo &info : infos) {
-            m_ui->serialPortComboxBox->addItem(info.portName() + " #" + info.description());
-            qDebug("portName = %s", info.portName().toStdString().c_str());
-            qDebug("manufacturer = %s", info.manufacturer().toStdString().c_str());
-            qDebug("serialNumber = %s", info.serialNumber().toStdString().c_str());
-            qDebug("vendorIdentifier = 0x%04x", info.vendorIdentifier());
-            qDebug("productIdentifier = 0x%04x\r\n", info.productIdentifier());
-        }
-        adjustComboBoxViewWidth(m_ui->serialPortComboxBox);
-        adjustComboBoxViewWidth(m_ui->flowControlComboBox);
-        qDebug("refreshPushButton is Clicked !");
+    // Ports are enumerated off the GUI thread, the list follows devices as they come and go
+    connect(m_ui->refreshPushButton, &QPushButton::clicked, m_portMonitor, &PortMonitor::refresh);
+    connect(m_portMonitor, &PortMonitor::portsChanged, this, &Widget::updatePortList);
+    connect(m_ui->autoReconnectBox, &QCheckBox::toggled, m_portReconnector, &PortReconnector::setEnabled);
+    connect(m_portReconnector, &PortReconnector::connectionLost, this, [this](const QString &portName) {
+        m_logModel->append(LogModel::Status,
+                           tr("**** Serial port %1 lost, waiting for it to come back ****").arg(portName));
+    });
+    connect(m_portReconnector, &PortReconnector::reconnected, this, &Widget::portReconnected);
+    connect(m_portReconnector, &PortReconnector::gaveUp, this, [this](const QString &portName) {
+        m_logModel->append(LogModel::Status, tr("**** Serial port %1 did not come back ****").arg(portName));
+        if (m_isPortOpened == true) openSerialPort();
     });
     connect(m_ui->clearPushButton, &QPushButton::clicked, this, [this]() {
-        m_ui->dataLogTextBrowser->clear();
+        m_logModel->clear();
         qDebug("clearPushButton is Clicked !");
     });
+    connect(m_ui->recordPushButton, &QPushButton::toggled, this, &Widget::recordSession);
+    connect(m_ui->openSessionPushButton, &QPushButton::clicked, this, &Widget::openSession);
+    connect(m_ui->metricsPushButton, &QPushButton::clicked, this, &Widget::showMetrics);
     connect(m_ui->resetRecvCountPushButton, &QPushButton::clicked, this, [this]() {
-        m_numberPacketReceived = 0;
-        m_ui->recvCount->setText(QString::number(m_numberPacketReceived));
+        m_serialWorker->resetReceivedCount();
+        m_ui->recvCount->setText(QString::number(m_serialWorker->packetsReceived()));
         qDebug("resetRecvCountPushButton is Clicked !");
     });
     connect(m_ui->resetSendCountPushButton, &QPushButton::clicked, this, [this]() {
-        m_numberPacketWritten = 0;
-        m_ui->sendCount->setText(QString::number(m_numberPacketWritten));
+        m_serialWorker->resetWrittenCount();
+        m_ui->sendCount->setText(QString::number(m_serialWorker->packetsWritten()));
         qDebug("resetSendCountPushButton is Clicked !");
     });
     connect(m_ui->runPushButton, &QPushButton::clicked, this, &Widget::openSerialPort);
     connect(m_ui->recvOptionsButtonGroup, &QButtonGroup::idClicked, this, [this](int buttonId) {
         m_isRecvHexEnabled = ((buttonId == 1) ? true : false);
+        m_ui->hexOffsetCheckBox->setEnabled(m_isRecvHexEnabled);
+        m_ui->hexAsciiCheckBox->setEnabled(m_isRecvHexEnabled);
         qDebug("m_isRecvHexEnabled = 0x%d", m_isRecvHexEnabled);
     });
+    connect(m_ui->hexOffsetCheckBox, &QCheckBox::toggled, this,
+            [this](bool isChecked) { m_hexDumpOptions.showOffset = isChecked; });
+    connect(m_ui->hexAsciiCheckBox, &QCheckBox::toggled, this,
+            [this](bool isChecked) { m_hexDumpOptions.showAscii = isChecked; });
     connect(m_ui->sendOptionsButtonGroup, &QButtonGroup::idClicked, this, [this](int buttonId) {
         m_isSendHexEnabled = ((buttonId == 1) ? true : false);
-        static int prev    = -1;
-        if (prev != m_isSendHexEnabled) {
+        if (m_prevSendHexEnabled != int(m_isSendHexEnabled)) {
             QString data            = m_ui->dataSendLineEdit->text();
             QString placeholderText = "Hello World !!! :)";
             if (m_isSendHexEnabled == true) {
                 m_ui->dataSendLineEdit->setValidator(m_hexStringValidator);
-                m_ui->dataSendLineEdit->setText(QByteArray::fromHex(data.toUtf8().toHex().toHex()).toUpper());
+                m_ui->dataSendLineEdit->setText(QString::fromLatin1(HexDump::toSpacedHex(data.toUtf8())));
                 // Hello World!!! -> Hex Ascii
-                m_ui->dataSendLineEdit->setPlaceholderText(insertSpaceBetweenByte(placeholderText.toUtf8()));
+                m_ui->dataSendLineEdit->setPlaceholderText(HexDump::toSpacedHex(placeholderText.toUtf8()));
             } else {
+                QByteArray bytes;
+                HexDump::fromHexText(data, bytes);
                 m_ui->dataSendLineEdit->setValidator(nullptr);
-                m_ui->dataSendLineEdit->setText(QByteArray::fromHex(data.remove(u' ').toUtf8()));
+                m_ui->dataSendLineEdit->setText(QString::fromUtf8(bytes));
                 m_ui->dataSendLineEdit->setPlaceholderText(placeholderText);
             }
+            m_isSendPayloadValid = false;
         }
-        prev = m_isSendHexEnabled;
+        m_prevSendHexEnabled = m_isSendHexEnabled;
         qDebug("m_isSendHexEnabled = 0x%d", m_isSendHexEnabled);
     });
     connect(m_ui->isPeriodCheckBox, &QCheckBox::stateChanged, this, [this](bool isChecked) {
         bool enable = ((isChecked == false) ? true : false);
         m_ui->repetitionLineEdit->setEnabled(enable);
         if (enable) {
-            m_repetition_ms = 0;
-            m_repetitionTimer->stop();
+            m_repetitionPeriod_us = 0;
+            m_transmitScheduler->stop();
         } else {
-            m_repetition_ms = m_ui->repetitionLineEdit->text().toInt();
+            m_repetitionPeriod_us = qRound64(m_ui->repetitionLineEdit->text().toDouble() * 1000);
         }
         qDebug("isPeriodCheckBox = 0x%d", isChecked);
     });
     connect(m_ui->sendPushButton, &QPushButton::clicked, [this]() {
-        QString data = m_ui->dataSendLineEdit->text();
-        if (m_isSendHexEnabled == true) {
-            m_ui->dataSendLineEdit->setText(formatHexData(data));
+        // Show the hex the way it is sent, the bytes stay the same so the encoding is kept
+        sendPayload();
+        if ((m_isSendHexEnabled == true) && (m_ui->dataSendLineEdit->text() != m_sendFieldText)) {
+            const QSignalBlocker blocker(m_ui->dataSendLineEdit);
+            m_ui->dataSendLineEdit->setText(m_sendFieldText);
         }
         sendButton_clicked();
     });
-    connect(m_ui->endCursorButton, &QPushButton::clicked, [this]() {
-        m_ui->dataLogTextBrowser->moveCursor(QTextCursor::End);
-        connect(m_ui->dataLogTextBrowser, &QTextBrowser::textChanged,
-                [this]() { m_ui->dataLogTextBrowser->moveCursor(QTextCursor::End); });
-    });
-    connect(m_ui->dataLogTextBrowser->verticalScrollBar(), &QScrollBar::valueChanged, [this](int value) {
-        static int temp  = value;
-        static int temp1 = this->height();
-        if ((value < temp) && (temp1 == this->height())) {
-            disconnect(m_ui->dataLogTextBrowser, &QTextBrowser::textChanged, 0, 0);
-        }
-        temp  = value;
-        temp1 = this->height();
+    // The log view keeps following new lines for as long as it is scrolled to the bottom
+    connect(m_ui->endCursorButton, &QPushButton::clicked, m_ui->dataLogView, &LogView::scrollToBottom);
+    connect(m_ui->logLimitSpinBox, &QSpinBox::valueChanged, this, [this](int value) {
+        m_logModel->setMemoryBudget(qint64(value) * 1024 * 1024);
+        qDebug("logLimit = %d MB", value);
     });
     connect(m_ui->freezeWindowsBox, &QCheckBox::clicked, [this](bool isChecked) {
-        m_ui->dataLogTextBrowser->setEnabled(!isChecked);
+        m_ui->dataLogView->setEnabled(!isChecked);
         m_isFreezeWindows = isChecked;
     });
+    connect(m_ui->sampleDisplayBox, &QCheckBox::toggled, this,
+            [this](bool isChecked) { m_isDisplaySampled = isChecked; });
+
+    connect(m_ui->searchLineEdit, &QLineEdit::textChanged, this, &Widget::searchLog);
+    connect(m_ui->searchModeComboBox, &QComboBox::currentIndexChanged, this, &Widget::searchLog);
+    connect(m_ui->searchLineEdit, &QLineEdit::returnPressed, this, [this]() { findMatch(true); });
+    connect(m_ui->searchNextPushButton, &QPushButton::clicked, this, [this]() { findMatch(true); });
+    connect(m_ui->searchPreviousPushButton, &QPushButton::clicked, this, [this]() { findMatch(false); });
+    connect(m_ui->searchFilterBox, &QCheckBox::toggled, this, [this](bool isChecked) {
+        m_ui->dataLogView->setModel(isChecked ? static_cast<QAbstractItemModel *>(m_logSearch) : m_logModel);
+        m_ui->dataLogView->scrollToBottom();
+    });
+    connect(m_logSearch, &LogSearch::matchesChanged, this, &Widget::updateSearchStatus);
+    // Every port tab has its own search field
+    auto *findShortcut = new QShortcut(QKeySequence::Find, this);
+    findShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+    connect(findShortcut, &QShortcut::activated, this, [this]() {
+        m_ui->searchLineEdit->setFocus();
+        m_ui->searchLineEdit->selectAll();
+    });
 
-    connect(m_serialPort, &QSerialPort::errorOccurred, [this](QSerialPort::SerialPortError error) {
-        // this is called when a serial communication error occurs
-        qDebug() << "An error occured: " << error;
+    connect(m_serialWorker, &SerialWorker::errorOccurred, this, [this](QSerialPort::SerialPortError error) {
+        if (error == QSerialPort::NoError || m_isPortOpened == false) return;
+        if (m_portReconnector->isReconnecting() == true) return;
+
+        m_logModel->append(LogModel::Status, tr("**** Serial port %1: %2 ****")
+                                                 .arg(m_session->name(), MetricsCollector::serialErrorName(error)));
+        // Without reconnecting a vanished device leaves nothing to keep open
+        if (error == QSerialPort::ResourceError && m_portReconnector->isEnabled() == false) openSerialPort();
+    });
+    connect(m_serialWorker, &SerialWorker::recordingFailed, this,
+            [this](const QString &fileName, const QString &errorString) {
+                QString s =
+                    tr("**** Unable to record to %1: %2 ****").arg(QDir::toNativeSeparators(fileName), errorString);
+                m_logModel->append(LogModel::Status, s);
+                const QSignalBlocker blocker(m_ui->recordPushButton);
+                m_ui->recordPushButton->setChecked(false);
+            });
+
+    connect(m_ui->packetGapSpinBox, &QSpinBox::valueChanged, this, [this](int value) {
+        QMetaObject::invokeMethod(m_serialWorker, [this, value]() { m_serialWorker->setPacketGap(value); });
+        qDebug("packetGap_ms = %d", value);
+    });
+    connect(m_ui->framingComboBox, &QComboBox::currentIndexChanged, this, &Widget::applyFraming);
+    connect(m_ui->delimiterLineEdit, &QLineEdit::editingFinished, this, &Widget::applyFraming);
+    m_dissectors.push_back(Dissector::modbusRtu());
+    connect(m_ui->dissectorComboBox, &QComboBox::currentIndexChanged, this, [this](int index) {
+        m_dissector = (index > 0) ? m_dissectors[index - 1].get() : nullptr;
+    });
+    connect(m_ui->dissectorLoadPushButton, &QPushButton::clicked, this, &Widget::loadDissector);
+    connect(m_ui->sendChecksumComboBox, &QComboBox::currentIndexChanged, this, [this](int index) {
+        m_sendChecksum       = Checksum::Type(qMax(0, index));
+        m_isSendPayloadValid = false;
+    });
+    connect(m_ui->recvChecksumComboBox, &QComboBox::currentIndexChanged, this,
+            [this](int index) { m_recvChecksum = Checksum::Type(qMax(0, index)); });
+    // Time, Time (us), Delta, Delta (us)
+    connect(m_ui->timeFormatComboBox, &QComboBox::currentIndexChanged, this, [this](int index) {
+        index = qMax(0, index);
+        m_logModel->setTimeFormat(LogModel::TimeFormat(index / 2), TimestampFormatter::Resolution(index % 2));
     });
 
     connect(m_displayTimeTimer, &QTimer::timeout, this, &Widget::displayTime);
-    connect(m_receiveMessageTimer, &QTimer::timeout, this, &Widget::receiveMessage);
-    connect(m_repetitionTimer, &QTimer::timeout, this, &Widget::transmitMessage);
+    connect(m_serialWorker, &SerialWorker::packetsAvailable, this, &Widget::scheduleRender);
+    connect(m_renderTimer, &QTimer::timeout, this, &Widget::receiveMessage);
+    connect(m_transmitScheduler, &TransmitScheduler::summary, this, &Widget::transmitSummary);
+    connect(m_ui->sequencePushButton, &QPushButton::toggled, this, &Widget::runSequence);
+    connect(m_sequenceRunner, &SequenceRunner::loopFinished, this, [this](int loop, int loops) {
+        m_ui->sequencePushButton->setText((loops == 0) ? tr("Loop %1").arg(loop) : tr("Loop %1/%2").arg(loop).arg(loops));
+    });
+    connect(m_sequenceRunner, &SequenceRunner::finished, this, &Widget::sequenceFinished);
+    connect(m_ui->sendFilePushButton, &QPushButton::toggled, this, &Widget::sendFile);
+    connect(m_fileSender, &FileSender::progress, this, [this](qint64 sent, qint64 total) {
+        // Scaled to stay within the int range of the progress bar
+        m_ui->sendFileProgressBar->setValue(total > 0 ? int(sent * 1000 / total) : 0);
+    });
+    connect(m_fileSender, &FileSender::finished, this, &Widget::sendFileFinished);
+    connect(m_ui->triggerArmPushButton, &QPushButton::toggled, this, &Widget::armTrigger);
+    connect(m_triggerCapture, &TriggerCapture::triggered, this, [this](const QString &reason) {
+        m_logModel->append(LogModel::Status, tr("---- Trigger: %1, saving the capture ----").arg(reason));
+    });
+    connect(m_triggerCapture, &TriggerCapture::saved, this, [this](const QString &fileName, quint64 bytes) {
+        m_logModel->append(LogModel::Status, tr("---- Trigger capture saved to %1, %2 bytes ----")
+                                                 .arg(QDir::toNativeSeparators(fileName))
+                                                 .arg(bytes));
+    });
+    connect(m_triggerCapture, &TriggerCapture::failed, this, [this](const QString &errorString) {
+        m_logModel->append(LogModel::Status, tr("**** Unable to save the trigger capture %1 ****").arg(errorString));
+    });
+    connect(m_ui->bridgePushButton, &QPushButton::toggled, this, &Widget::shareSerialPort);
+    connect(m_serialBridge, &SerialBridge::clientsChanged, this, [this](int count) {
+        if (m_ui->bridgePushButton->isChecked() == true) m_ui->bridgePushButton->setText(tr("Unshare (%1)").arg(count));
+    });
+    connect(m_serialBridge, &SerialBridge::notice, this, [this](const QString &text) {
+        m_logModel->append(LogModel::Status, tr("---- Share: %1 ----").arg(text));
+    });
 
+    m_renderTimer->setSingleShot(true);
+    m_renderClock.start();
+    m_throughputTimer.start();
     displayTime();
     m_displayTimeTimer->start(250);
 
-    // Search all available serial ports
-    const auto infos = QSerialPortInfo::availablePorts();
-    for (const QSerialPortInfo &info : infos)
-        m_ui->serialPortComboxBox->addItem(info.portName() + " #" + info.description());
+    // The port, framing and counters live in a pool thread, away from log rendering
+    const int packetGap_ms = m_ui->packetGapSpinBox->value();
+    QMetaObject::invokeMethod(m_serialWorker, [this, packetGap_ms]() { m_serialWorker->setPacketGap(packetGap_ms); });
+
+    // Filled in once the monitor's first scan is done, if it is not already
+    updatePortList();
 
     // Show supported baud rates
     const auto baudRates     = QSerialPortInfo::standardBaudRates();
@@ -273,140 +316,189 @@ void Widget::initialization() {
     }
     m_ui->baudrateComboBox->setCurrentIndex(indexBaudrate);
 
-    const QStringList dataBits = {"5 Bits", "6 Bits", "7 Bits", "8 Bits"};
-    for (int index = 0; index < dataBits.size(); index++) m_ui->databitsComboBox->addItem(dataBits[index]);
+    // The QSerialPort enum of every choice rides along as item data
+    m_ui->databitsComboBox->addItem("5 Bits", QSerialPort::Data5);
+    m_ui->databitsComboBox->addItem("6 Bits", QSerialPort::Data6);
+    m_ui->databitsComboBox->addItem("7 Bits", QSerialPort::Data7);
+    m_ui->databitsComboBox->addItem("8 Bits", QSerialPort::Data8);
     m_ui->databitsComboBox->setCurrentIndex(3);
 
-    const QStringList stopBits = {"1 Bit", "1.5 Bits", "2 Bits"};
-    for (int index = 0; index < stopBits.size(); index++) m_ui->stopbitsComboBox->addItem(stopBits[index]);
+    m_ui->stopbitsComboBox->addItem("1 Bit", QSerialPort::OneStop);
+    m_ui->stopbitsComboBox->addItem("1.5 Bits", QSerialPort::OneAndHalfStop);
+    m_ui->stopbitsComboBox->addItem("2 Bits", QSerialPort::TwoStop);
+
+    m_ui->parityComboBox->addItem("No Parity", QSerialPort::NoParity);
+    m_ui->parityComboBox->addItem("Even Parity", QSerialPort::EvenParity);
+    m_ui->parityComboBox->addItem("Odd Parity", QSerialPort::OddParity);
+    m_ui->parityComboBox->addItem("Mark Parity", QSerialPort::MarkParity);
+    m_ui->parityComboBox->addItem("Space Parity", QSerialPort::SpaceParity);
 
-    const QStringList parity = {"No Parity", "Even Parity", "Odd Parity", "Mark Parity", "Space Parity"};
-    for (int index = 0; index < parity.size(); index++) m_ui->parityComboBox->addItem(parity[index]);
+    m_ui->flowControlComboBox->addItem("No FlowControl", QSerialPort::NoFlowControl);
+    m_ui->flowControlComboBox->addItem("Hardware FlowControl", QSerialPort::HardwareControl);
+    m_ui->flowControlComboBox->addItem("Software FlowControl", QSerialPort::SoftwareControl);
 
-    const QStringList flowControl = {"No FlowControl", "Hardware FlowControl", "Software FlowControl"};
-    for (int index = 0; index < flowControl.size(); index++) m_ui->flowControlComboBox->addItem(flowControl[index]);
+    restoreSettings();
+}
+
+void Widget::restoreSettings() {
+    const QSettings settings;
+    const auto      restoreData = [&settings](QComboBox *comboBox, const QString &key) {
+        const int index = comboBox->findData(settings.value(key, comboBox->currentData()));
+        if (index >= 0) comboBox->setCurrentIndex(index);
+    };
+
+    // Before the first scan the port is shown on its own, the scan keeps it selected if it is there
+    QComboBox    *portComboBox = m_ui->serialPortComboxBox;
+    const QString portName     = settings.value(u"port/name"_s).toString();
+    const int     portIndex    = portComboBox->findText(portName + " #", Qt::MatchStartsWith);
+    if (portName.isEmpty() == false && portIndex >= 0) portComboBox->setCurrentIndex(portIndex);
+    if (portName.isEmpty() == false && m_portMonitor->hasScanned() == false) portComboBox->addItem(portName);
+    const int baudIndex = m_ui->baudrateComboBox->findText(settings.value(u"port/baudRate"_s).toString());
+    if (baudIndex >= 0) m_ui->baudrateComboBox->setCurrentIndex(baudIndex);
+    restoreData(m_ui->databitsComboBox, u"port/dataBits"_s);
+    restoreData(m_ui->stopbitsComboBox, u"port/stopBits"_s);
+    restoreData(m_ui->parityComboBox, u"port/parity"_s);
+    restoreData(m_ui->flowControlComboBox, u"port/flowControl"_s);
+
+    m_ui->packetGapSpinBox->setValue(settings.value(u"receive/packetGap"_s, m_ui->packetGapSpinBox->value()).toInt());
+    m_ui->delimiterLineEdit->setText(
+        settings.value(u"receive/delimiter"_s, m_ui->delimiterLineEdit->text()).toString());
+    m_ui->framingComboBox->setCurrentIndex(
+        settings.value(u"receive/framing"_s, m_ui->framingComboBox->currentIndex()).toInt());
+    // Clicked, so the modes are applied as if chosen by hand
+    if (settings.value(u"receive/hex"_s, false).toBool() == true) m_ui->isRecvHexRadioButton->click();
+    if (settings.value(u"send/hex"_s, false).toBool() == true) m_ui->isSendHexRadioButton->click();
+    m_ui->repetitionLineEdit->setText(settings.value(u"send/period"_s, m_ui->repetitionLineEdit->text()).toString());
+    m_ui->sendChecksumComboBox->setCurrentIndex(settings.value(u"send/checksum"_s, 0).toInt());
+    m_ui->recvChecksumComboBox->setCurrentIndex(settings.value(u"receive/checksum"_s, 0).toInt());
+    m_ui->timeFormatComboBox->setCurrentIndex(settings.value(u"receive/timeFormat"_s, 0).toInt());
+}
+
+void Widget::saveSettings() const {
+    QSettings settings;
+    if (m_portName.isEmpty() == false) settings.setValue(u"port/name"_s, m_portName.split(" ")[0]);
+    settings.setValue(u"port/baudRate"_s, m_ui->baudrateComboBox->currentText());
+    settings.setValue(u"port/dataBits"_s, m_ui->databitsComboBox->currentData());
+    settings.setValue(u"port/stopBits"_s, m_ui->stopbitsComboBox->currentData());
+    settings.setValue(u"port/parity"_s, m_ui->parityComboBox->currentData());
+    settings.setValue(u"port/flowControl"_s, m_ui->flowControlComboBox->currentData());
+    settings.setValue(u"receive/framing"_s, m_ui->framingComboBox->currentIndex());
+    settings.setValue(u"receive/delimiter"_s, m_ui->delimiterLineEdit->text());
+    settings.setValue(u"receive/packetGap"_s, m_ui->packetGapSpinBox->value());
+    settings.setValue(u"receive/hex"_s, m_isRecvHexEnabled);
+    settings.setValue(u"send/hex"_s, m_isSendHexEnabled);
+    settings.setValue(u"send/period"_s, m_ui->repetitionLineEdit->text());
+    settings.setValue(u"send/checksum"_s, m_ui->sendChecksumComboBox->currentIndex());
+    settings.setValue(u"receive/checksum"_s, m_ui->recvChecksumComboBox->currentIndex());
+    settings.setValue(u"receive/timeFormat"_s, m_ui->timeFormatComboBox->currentIndex());
 }
 
 void Widget::displayTime() {
     m_currentTime = QDateTime::currentDateTime().toString("A hh:mm:ss\r\nyyyy-MM-dd ddd");
     m_ui->currentTimeLabel->setText(m_currentTime);
+    m_ui->sendCount->setText(QString::number(m_serialWorker->packetsWritten()));
+
+    const quint64 bytesReceived = m_serialWorker->bytesReceived();
+    const qint64  elapsed_ms    = qMax<qint64>(1, m_throughputTimer.restart());
+    const double  kbPerSecond   = double(bytesReceived - m_lastBytesReceived) * 1000.0 / 1024.0 / double(elapsed_ms);
+    m_lastBytesReceived         = bytesReceived;
+    m_ui->recvStatsLabel->setText(tr("%1 err, %2 KB/s").arg(m_serialWorker->frameErrors()).arg(kbPerSecond, 0, 'f', 1));
+}
+
+void Widget::scheduleRender() {
+    // Whatever arrives until the timer fires is drawn in the same frame
+    if (m_renderTimer->isActive() == true) return;
+    m_renderTimer->start(int(qMax<qint64>(0, kFrameInterval_ms - m_renderClock.elapsed())));
 }
 
 void Widget::receiveMessage() {
-    static qint64 prev        = 0;
-    quint8        cursorSpace = 0;
-    QByteArray    data        = nullptr;
-    QByteArray    dataAcsii   = nullptr;
-    QString       timeMessage = timeString("RECV", m_isRecvHexEnabled);
+    SerialPacket packet;
+    int          count        = 0;
+    int          shown        = 0;
+    quint64      frozen       = 0;
+    quint64      skipped      = 0;  // left out by sampling
+    quint64      skippedBytes = 0;
 
-    if ((m_serialPort->bytesAvailable() == prev) && (prev != 0)) {
-        data = m_serialPort->readAll();
+    m_renderTimer->stop();
+    m_renderClock.restart();
+    m_serialWorker->acknowledgePackets();
+    while (m_serialWorker->takePacket(packet) == true) {
+        count++;
+        emit packetReceived(packet);
+        if (m_isFreezeWindows == true) {
+            frozen++;
+            continue;
+        }
+        if (m_isDisplaySampled == true && shown >= kSampledPacketsPerFrame) {
+            skipped++;
+            skippedBytes += quint64(packet.data.size());
+            continue;
+        }
+        shown++;
 
-        if (m_isRecvHexEnabled == true) {
-            dataAcsii = insertSpaceBetweenByte(data);
+        m_logModel->appendTimestamp(packet.timestampNs, packet.realtimeNs,
+                                    (m_isRecvHexEnabled == true) ? u"RECV HEX"_s : u"RECV ASCII"_s);
+        if (m_isRecvHexEnabled == false) {
+            m_logModel->append(LogModel::Received, packet.data);
+        } else if ((m_hexDumpOptions.showOffset == true) || (m_hexDumpOptions.showAscii == true)) {
+            const QList<QByteArray> lines = HexDump::toLines(packet.data, m_hexDumpOptions);
+            for (const QByteArray &line : lines) m_logModel->append(LogModel::Received, QString::fromLatin1(line));
         } else {
-            dataAcsii = data;
+            HexDump::toSpacedHex(packet.data, m_hexBuffer);
+            m_logModel->append(LogModel::Received, QString::fromLatin1(m_hexBuffer));
         }
-
-        if (m_isFreezeWindows == false) {
-            m_ui->dataLogTextBrowser->setTextColor(Qt::gray);
-            m_ui->dataLogTextBrowser->append(timeMessage);
-
-            m_ui->dataLogTextBrowser->setTextColor(Qt::blue);
-            m_ui->dataLogTextBrowser->append(dataAcsii);
+        if (m_dissector != nullptr) {
+            m_dissector->dissect(packet.data, m_dissection);
+            if (m_dissection.status != Dissector::NoMatch) {
+                m_logModel->append(LogModel::Decoded, m_dissector->format(m_dissection, packet.data));
+            }
+        }
+        if (m_recvChecksum != Checksum::None) {
+            m_logModel->append(LogModel::Decoded, Checksum::describe(m_recvChecksum, packet.data));
         }
+        m_metrics->recordLatency(SessionFormat::monotonicNs() - packet.timestampNs);
+    }
 
-        m_ui->recvCount->setText(QString::number(++m_numberPacketReceived));
+    if (frozen + skipped > 0) m_metrics->recordDropped(frozen + skipped);
+    if (skipped > 0) {
+        QString s = tr("---- %1 packets, %2 bytes not displayed ----").arg(skipped).arg(skippedBytes);
+        m_logModel->append(LogModel::Status, s);
     }
-    prev = m_serialPort->bytesAvailable();
+    m_logModel->flush();
+
+    if (count > 0) m_ui->recvCount->setText(QString::number(m_serialWorker->packetsReceived()));
 }
 
 void Widget::openSerialPort() {
-    static bool isOpened = false;
-    m_portName           = m_ui->serialPortComboxBox->currentText();
-    if (isOpened == false) {
+    m_portName = m_ui->serialPortComboxBox->currentText();
+    if (m_isPortOpened == false) {
         // Serial Port Settings
-        if (m_serialPort->isOpen() == false) {
-            m_serialPort->setPortName(m_portName.split(" ")[0]);
-            m_serialPort->setBaudRate(m_ui->baudrateComboBox->currentText().toInt());
-
-            qint8 configDataBits = m_ui->databitsComboBox->currentIndex();
-            switch (configDataBits) {
-                case 0:
-                    m_serialPort->setDataBits(QSerialPort::Data5);
-                    break;
-                case 1:
-                    m_serialPort->setDataBits(QSerialPort::Data6);
-                    break;
-                case 2:
-                    m_serialPort->setDataBits(QSerialPort::Data7);
-                    break;
-                case 3:
-                default:
-                    m_serialPort->setDataBits(QSerialPort::Data8);
-                    break;
-            }
-
-            qint8 configStopBits = m_ui->stopbitsComboBox->currentIndex();
-            switch (configStopBits) {
-                case 0:
-                default:
-                    m_serialPort->setStopBits(QSerialPort::OneStop);
-                    break;
-                case 1:
-                    m_serialPort->setStopBits(QSerialPort::OneAndHalfStop);
-                    break;
-                case 2:
-                    m_serialPort->setStopBits(QSerialPort::TwoStop);
-                    break;
-            }
-
-            qint8 configParity = m_ui->parityComboBox->currentIndex();
-            switch (configParity) {
-                case 0:
-                default:
-                    m_serialPort->setParity(QSerialPort::NoParity);
-                    break;
-                case 1:
-                    m_serialPort->setParity(QSerialPort::EvenParity);
-                    break;
-                case 2:
-                    m_serialPort->setParity(QSerialPort::OddParity);
-                    break;
-                case 3:
-                    m_serialPort->setParity(QSerialPort::MarkParity);
-                    break;
-                case 4:
-                    m_serialPort->setParity(QSerialPort::SpaceParity);
-                    break;
-            }
-
-            qint8 configFlowControl = m_ui->flowControlComboBox->currentIndex();
-            switch (configFlowControl) {
-                case 0:
-                default:
-                    m_serialPort->setFlowControl(QSerialPort::NoFlowControl);
-                    break;
-                case 1:
-                    m_serialPort->setFlowControl(QSerialPort::HardwareControl);
-                    break;
-                case 2:
-                    m_serialPort->setFlowControl(QSerialPort::SoftwareControl);
-                    break;
-            }
+        SerialSettings settings;
+        if (m_serialWorker->isOpen() == false) {
+            settings.portName    = m_portName.split(" ")[0];
+            settings.baudRate    = m_ui->baudrateComboBox->currentText().toInt();
+            settings.dataBits    = QSerialPort::DataBits(m_ui->databitsComboBox->currentData().toInt());
+            settings.stopBits    = QSerialPort::StopBits(m_ui->stopbitsComboBox->currentData().toInt());
+            settings.parity      = QSerialPort::Parity(m_ui->parityComboBox->currentData().toInt());
+            settings.flowControl = QSerialPort::FlowControl(m_ui->flowControlComboBox->currentData().toInt());
         }
 
         // Open the serial port reminder box
-        m_ui->dataLogTextBrowser->setTextColor(Qt::black);  // Receieved message's color is black.
-        if (m_serialPort->open(QIODevice::ReadWrite) == true) {
+        bool isOpen = false;
+        QMetaObject::invokeMethod(
+            m_serialWorker, [this, &settings, &isOpen]() { isOpen = m_serialWorker->open(settings); },
+            Qt::BlockingQueuedConnection);
+
+        if (isOpen == true) {
             QString s = tr("---- Serial port %1 is open ----").arg(m_portName.split(" ")[0]);
-            isOpened  = true;
-            if (m_serialPort->isDataTerminalReady() == false) {
-                m_serialPort->setDataTerminalReady(true);
-            }
+            m_isPortOpened = true;
+            m_session->setName(m_portName.split(" ")[0]);
+            m_metrics->setPortName(m_session->name());
+            m_portReconnector->watch(m_session->name());
 
             m_ui->runPushButton->setText("Close");
-            m_ui->dataLogTextBrowser->append(s);
+            m_logModel->append(LogModel::Status, s);
+            saveSettings();
             m_ui->serialPortComboxBox->setEnabled(false);
             m_ui->baudrateComboBox->setEnabled(false);
             m_ui->databitsComboBox->setEnabled(false);
@@ -414,96 +506,521 @@ void Widget::openSerialPort() {
             m_ui->parityComboBox->setEnabled(false);
             m_ui->flowControlComboBox->setEnabled(false);
             m_ui->refreshPushButton->setAttribute(Qt::WA_TransparentForMouseEvents);
-            m_receiveMessageTimer->start(2);
-
-            qDebug("m_serialPort->portName() = %s", m_serialPort->portName().toStdString().c_str());
-            qDebug("m_serialPort->error() = 0x%d", m_serialPort->error());
-
-            qDebug("m_serialPort->isDataTerminalReady() = 0x%d", m_serialPort->isDataTerminalReady());
-            qDebug("m_serialPort->isBreakEnabled() = 0x%d", m_serialPort->isBreakEnabled());
-            qDebug("m_serialPort->isRequestToSend() = 0x%d", m_serialPort->isRequestToSend());
-            qDebug("m_serialPort->isSequential() = 0x%d", m_serialPort->isSequential());
-            qDebug("m_serialPort->isTextModeEnabled() = 0x%d", m_serialPort->isTextModeEnabled());
-            qDebug("m_serialPort->isOpen() = 0x%d", m_serialPort->isOpen());
-            qDebug("m_serialPort->isQuickItemType() = 0x%d", m_serialPort->isQuickItemType());
-            qDebug("m_serialPort->isTextModeEnabled() = 0x%d", m_serialPort->isTextModeEnabled());
-            qDebug("m_serialPort->isReadable() = 0x%d", m_serialPort->isReadable());
-            qDebug("m_serialPort->isWritable() = 0x%d", m_serialPort->isWritable());
         } else {
             QString s = tr("**** Unable to open serial port %1. ****").arg(m_portName.split(" ")[0]);
-            m_ui->dataLogTextBrowser->append(s);
+            m_logModel->append(LogModel::Status, s);
         }
     } else {
-        isOpened = false;
+        m_isPortOpened = false;
+        m_portReconnector->unwatch();
         m_ui->runPushButton->setText("Open");
-        if (m_serialPort->isOpen() == true) {
-            QString s = tr("---- Serial port %1 closed ----").arg(m_portName.split(" ")[0]);
-            m_ui->dataLogTextBrowser->setTextColor(Qt::black);  // Receieved message's color is black.
-            m_ui->dataLogTextBrowser->append(s);
-            m_ui->sendPushButton->setText("Send");
-            m_ui->dataSendLineEdit->setEnabled(true);
-            m_ui->isPeriodCheckBox->setEnabled(true);
-            m_ui->serialPortComboxBox->setEnabled(true);
-            m_ui->baudrateComboBox->setEnabled(true);
-            m_ui->databitsComboBox->setEnabled(true);
-            m_ui->stopbitsComboBox->setEnabled(true);
-            m_ui->parityComboBox->setEnabled(true);
-            m_ui->flowControlComboBox->setEnabled(true);
-            m_ui->refreshPushButton->setAttribute(Qt::WA_TransparentForMouseEvents, false);
-            m_serialPort->close();
-            m_repetitionTimer->stop();
-            m_receiveMessageTimer->stop();
+        if (m_serialWorker->isOpen() == true) {
+            // The worker hands over whatever is still buffered before the port closes
+            QMetaObject::invokeMethod(
+                m_serialWorker, [this]() { m_serialWorker->close(); }, Qt::BlockingQueuedConnection);
+            receiveMessage();
+
+            QString s = tr("---- Serial port %1 closed ----").arg(m_session->name());
+            m_logModel->append(LogModel::Status, s);
         }
+        // Also when the device went away and the port is already closed
+        m_ui->sendPushButton->setText("Send");
+        m_ui->dataSendLineEdit->setEnabled(true);
+        m_ui->isPeriodCheckBox->setEnabled(true);
+        m_ui->serialPortComboxBox->setEnabled(true);
+        m_ui->baudrateComboBox->setEnabled(true);
+        m_ui->databitsComboBox->setEnabled(true);
+        m_ui->stopbitsComboBox->setEnabled(true);
+        m_ui->parityComboBox->setEnabled(true);
+        m_ui->flowControlComboBox->setEnabled(true);
+        m_ui->refreshPushButton->setAttribute(Qt::WA_TransparentForMouseEvents, false);
+        m_transmitScheduler->stop();
+        m_ui->sequencePushButton->setChecked(false);
+        m_ui->sendFilePushButton->setChecked(false);
+        updatePortList();
     }
     qDebug("runPushButton is Clicked !");
 }
 
+const QByteArray &Widget::sendPayload() {
+    if (m_isSendPayloadValid == true) return m_sendPayload;
+
+    const QString text = m_ui->dataSendLineEdit->text();
+    if (m_isSendHexEnabled == true) {
+        // The validator only lets hex digits and spaces through
+        HexDump::fromHexText(text, m_sendPayload);
+        m_sendFieldText = QString::fromLatin1(HexDump::toSpacedHex(m_sendPayload));
+    } else {
+        m_sendPayload   = text.toUtf8();
+        m_sendFieldText = text;
+    }
+    m_sendLogText = m_sendFieldText;
+
+    // Part of the cached payload, so periodic sends do not compute it again
+    const int checksumSize = Checksum::size(m_sendChecksum);
+    if (checksumSize > 0 && m_sendPayload.isEmpty() == false) {
+        Checksum::append(m_sendChecksum, m_sendPayload);
+        const QByteArray checksum = HexDump::toSpacedHex(QByteArrayView(m_sendPayload).last(checksumSize));
+        m_sendLogText += u" [%1 %2]"_s.arg(Checksum::name(m_sendChecksum), QString::fromLatin1(checksum));
+    }
+    m_isSendPayloadValid = true;
+    return m_sendPayload;
+}
+
 void Widget::transmitMessage() {
-    QString timeMessage = timeString("SEND", m_isSendHexEnabled);
-    QString data        = m_ui->dataSendLineEdit->text();
-
-    if (data.size() != 0) {
-        if (m_isSendHexEnabled == true) {
-            m_ui->dataLogTextBrowser->setTextColor(Qt::gray);
-            m_ui->dataLogTextBrowser->append(timeMessage);
-            m_ui->dataLogTextBrowser->setTextColor(Qt::darkGreen);
-            m_ui->dataLogTextBrowser->append(data.toUpper());
-            m_serialPort->write(QByteArray::fromHex(data.remove(u' ').toLatin1()));
-        } else {
-            m_ui->dataLogTextBrowser->setTextColor(Qt::gray);
-            m_ui->dataLogTextBrowser->append(timeMessage);
-            m_ui->dataLogTextBrowser->setTextColor(Qt::darkGreen);
-            m_ui->dataLogTextBrowser->append(data);
-            m_serialPort->write(data.toUtf8());
-        }
-        m_ui->sendCount->setText(QString::number(++m_numberPacketWritten));
+    const QByteArray &payload = sendPayload();
+
+    if (payload.isEmpty() == false) {
+        const QString label = (m_isSendHexEnabled == true) ? u"SEND HEX"_s : u"SEND ASCII"_s;
+        writeSerialPort(payload, label, m_sendLogText);
     } else {
         m_ui->sendPushButton->setText("Send");
         m_ui->dataSendLineEdit->setEnabled(true);
         m_ui->isPeriodCheckBox->setEnabled(true);
-        m_repetitionTimer->stop();
         QMessageBox::information(this, "Hint", "Data Send field cannot be blank");
     }
 }
 
+bool Widget::startPeriodicTransmit() {
+    if (sendPayload().isEmpty() == true) {
+        QMessageBox::information(this, "Hint", "Data Send field cannot be blank");
+        return false;
+    }
+
+    // Encoded once, every period sends the same bytes
+    TransmitScheduler::Options options;
+    options.period_us = m_repetitionPeriod_us;
+    options.burst     = m_ui->burstSpinBox->value();
+    options.payload   = m_sendPayload;
+    const QString label = (m_isSendHexEnabled == true) ? u"SEND HEX"_s : u"SEND ASCII"_s;
+    m_logModel->appendTimestamp(SessionFormat::monotonicNs(), SessionFormat::realtimeNs(), label);
+    m_logModel->append(LogModel::Transmitted, m_sendLogText);
+
+    QString s = tr("---- Sending every %1 us, %2 per period ----").arg(options.period_us).arg(options.burst);
+    m_logModel->append(LogModel::Status, s);
+    m_transmitScheduler->start(options);
+    return true;
+}
+
+void Widget::transmitSummary(const QString &text, bool isFinal) {
+    QString s = (isFinal == true) ? tr("---- Periodic send stopped, %1 ----").arg(text) : tr("---- %1 ----").arg(text);
+    m_logModel->append(LogModel::Status, s);
+}
+
+void Widget::recordSession(bool isChecked) {
+    if (isChecked == false) {
+        QMetaObject::invokeMethod(
+            m_serialWorker, [this]() { m_serialWorker->stopRecording(); }, Qt::BlockingQueuedConnection);
+        QString s = tr("---- Recording stopped, %1 bytes written ----").arg(m_serialWorker->recordedBytes());
+        m_logModel->append(LogModel::Status, s);
+        return;
+    }
+
+    const QString defaultName = u"session-%1.cps"_s.arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"));
+    const QString fileName =
+        QFileDialog::getSaveFileName(this, tr("Record Session"), defaultName, tr("ComPort Session (*.cps)"));
+    if (fileName.isEmpty() == true) {
+        const QSignalBlocker blocker(m_ui->recordPushButton);
+        m_ui->recordPushButton->setChecked(false);
+        return;
+    }
+
+    bool    isRecording = false;
+    QString errorString;
+    QMetaObject::invokeMethod(
+        m_serialWorker,
+        [this, &fileName, &errorString, &isRecording]() {
+            isRecording = m_serialWorker->startRecording(fileName, &errorString);
+        },
+        Qt::BlockingQueuedConnection);
+
+    if (isRecording == true) {
+        QString s = tr("---- Recording to %1 ----").arg(QDir::toNativeSeparators(fileName));
+        m_logModel->append(LogModel::Status, s);
+    } else {
+        QString s = tr("**** Unable to record to %1: %2 ****").arg(QDir::toNativeSeparators(fileName), errorString);
+        m_logModel->append(LogModel::Status, s);
+        const QSignalBlocker blocker(m_ui->recordPushButton);
+        m_ui->recordPushButton->setChecked(false);
+    }
+}
+
+void Widget::runSequence(bool isChecked) {
+    if (isChecked == false) {
+        QMetaObject::invokeMethod(m_sequenceRunner, [runner = m_sequenceRunner]() { runner->stop(); });
+        return;
+    }
+
+    const QSignalBlocker blocker(m_ui->sequencePushButton);
+    if (m_serialWorker->isOpen() == false) {
+        QString s = tr("**** The serial port %1 has not been opened. ****").arg(m_portName.split(" ")[0]);
+        QMessageBox::information(this, "Hint", s);
+        m_ui->sequencePushButton->setChecked(false);
+        return;
+    }
+
+    Sequence      sequence;
+    QString       errorString;
+    const QString fileName = QFileDialog::getOpenFileName(this, tr("Run Sequence"), QString(),
+                                                          tr("ComPort Sequence (*.seq *.txt);;All Files (*)"));
+    if (fileName.isEmpty() == true) {
+        m_ui->sequencePushButton->setChecked(false);
+        return;
+    }
+    if (Sequence::load(fileName, sequence, &errorString) == false) {
+        QString s = tr("**** Unable to load %1: %2 ****").arg(QDir::toNativeSeparators(fileName), errorString);
+        m_logModel->append(LogModel::Status, s);
+        m_ui->sequencePushButton->setChecked(false);
+        return;
+    }
+
+    QString s = tr("---- Running %1, %2 steps ----").arg(QDir::toNativeSeparators(fileName)).arg(sequence.steps.size());
+    m_logModel->append(LogModel::Status, s);
+    m_ui->sequencePushButton->setText(tr("Stop"));
+    QMetaObject::invokeMethod(m_sequenceRunner,
+                              [runner = m_sequenceRunner, sequence]() { runner->start(sequence); });
+}
+
+void Widget::sequenceFinished(const QStringList &report) {
+    for (const QString &line : report) m_logModel->append(LogModel::Status, tr("---- %1 ----").arg(line));
+
+    const QSignalBlocker blocker(m_ui->sequencePushButton);
+    m_ui->sequencePushButton->setChecked(false);
+    m_ui->sequencePushButton->setText(tr("Sequence"));
+}
+
+void Widget::sendFile(bool isChecked) {
+    if (isChecked == false) {
+        QMetaObject::invokeMethod(m_fileSender, [sender = m_fileSender]() { sender->stop(); });
+        return;
+    }
+
+    const QSignalBlocker blocker(m_ui->sendFilePushButton);
+    if (m_serialWorker->isOpen() == false) {
+        QString s = tr("**** The serial port %1 has not been opened. ****").arg(m_portName.split(" ")[0]);
+        QMessageBox::information(this, "Hint", s);
+        m_ui->sendFilePushButton->setChecked(false);
+        return;
+    }
+
+    FileSender::Options options;
+    options.fileName      = QFileDialog::getOpenFileName(this, tr("Send File"), QString(), tr("All Files (*)"));
+    options.chunkSize     = m_ui->chunkSizeSpinBox->value();
+    options.chunkDelay_ms = m_ui->chunkDelaySpinBox->value();
+    if (options.fileName.isEmpty() == true) {
+        m_ui->sendFilePushButton->setChecked(false);
+        return;
+    }
+
+    bool    isStarted = false;
+    QString errorString;
+    QMetaObject::invokeMethod(
+        m_fileSender,
+        [sender = m_fileSender, &options, &errorString, &isStarted]() {
+            isStarted = sender->start(options, &errorString);
+        },
+        Qt::BlockingQueuedConnection);
+
+    if (isStarted == false) {
+        QString s = tr("**** Unable to send %1: %2 ****").arg(QDir::toNativeSeparators(options.fileName), errorString);
+        m_logModel->append(LogModel::Status, s);
+        m_ui->sendFilePushButton->setChecked(false);
+        return;
+    }
+
+    QString s = tr("---- Sending %1 ----").arg(QDir::toNativeSeparators(options.fileName));
+    m_logModel->append(LogModel::Status, s);
+    m_ui->sendFilePushButton->setText(tr("Stop"));
+    m_ui->chunkSizeSpinBox->setEnabled(false);
+    m_ui->chunkDelaySpinBox->setEnabled(false);
+}
+
+void Widget::sendFileFinished(const QString &report) {
+    m_logModel->append(LogModel::Status, tr("---- File transfer: %1 ----").arg(report));
+
+    const QSignalBlocker blocker(m_ui->sendFilePushButton);
+    m_ui->sendFilePushButton->setChecked(false);
+    m_ui->sendFilePushButton->setText(tr("Send File"));
+    m_ui->chunkSizeSpinBox->setEnabled(true);
+    m_ui->chunkDelaySpinBox->setEnabled(true);
+}
+
+void Widget::armTrigger(bool isChecked) {
+    const auto setArmed = [this](bool isArmed) {
+        const QSignalBlocker blocker(m_ui->triggerArmPushButton);
+        m_ui->triggerArmPushButton->setChecked(isArmed);
+        m_ui->triggerArmPushButton->setText(isArmed ? tr("Disarm") : tr("Arm"));
+        m_ui->triggerTypeComboBox->setEnabled(!isArmed);
+        m_ui->triggerLineEdit->setEnabled(!isArmed);
+        m_ui->triggerPreSpinBox->setEnabled(!isArmed);
+        m_ui->triggerPostSpinBox->setEnabled(!isArmed);
+    };
+
+    if (isChecked == false) {
+        QMetaObject::invokeMethod(
+            m_triggerCapture, [capture = m_triggerCapture]() { capture->stop(); }, Qt::BlockingQueuedConnection);
+        m_logModel->append(LogModel::Status, tr("---- Trigger disarmed ----"));
+        setArmed(false);
+        return;
+    }
+
+    // Text and hex both become a byte pattern
+    TriggerCapture::Options options;
+    const QString           text    = m_ui->triggerLineEdit->text();
+    bool                    isValid = true;
+    switch (m_ui->triggerTypeComboBox->currentIndex()) {
+        case 0:
+            options.type    = TriggerCapture::Pattern;
+            options.pattern = Sequence::unescape(text.toUtf8());
+            break;
+        case 1:
+            options.type = TriggerCapture::Pattern;
+            isValid      = HexDump::fromHexText(text, options.pattern);
+            break;
+        case 2:
+            options.type  = TriggerCapture::Regex;
+            options.regex = text;
+            break;
+        default:
+            options.type   = TriggerCapture::Gap;
+            options.gap_ms = text.toInt(&isValid);
+            isValid        = isValid && options.gap_ms > 0;
+            break;
+    }
+    options.preTriggerSize = qint64(m_ui->triggerPreSpinBox->value()) * 1024 * 1024;
+    options.postTrigger_ms = m_ui->triggerPostSpinBox->value();
+
+    if (isValid == false) {
+        m_logModel->append(LogModel::Status, tr("**** Invalid trigger \"%1\" ****").arg(text));
+        setArmed(false);
+        return;
+    }
+    options.directory = QFileDialog::getExistingDirectory(this, tr("Save Trigger Captures To"));
+    if (options.directory.isEmpty() == true) {
+        setArmed(false);
+        return;
+    }
+
+    bool    isArmed = false;
+    QString errorString;
+    QMetaObject::invokeMethod(
+        m_triggerCapture,
+        [capture = m_triggerCapture, &options, &errorString, &isArmed]() {
+            isArmed = capture->start(options, &errorString);
+        },
+        Qt::BlockingQueuedConnection);
+
+    if (isArmed == false) {
+        m_logModel->append(LogModel::Status, tr("**** Unable to arm the trigger: %1 ****").arg(errorString));
+        setArmed(false);
+        return;
+    }
+
+    QString s = tr("---- Trigger armed, captures go to %1 ----").arg(QDir::toNativeSeparators(options.directory));
+    m_logModel->append(LogModel::Status, s);
+    setArmed(true);
+}
+
+void Widget::shareSerialPort(bool isChecked) {
+    const auto setShared = [this](bool isShared) {
+        const QSignalBlocker blocker(m_ui->bridgePushButton);
+        m_ui->bridgePushButton->setChecked(isShared);
+        m_ui->bridgePushButton->setText(isShared ? tr("Unshare (%1)").arg(m_serialBridge->clientCount()) : tr("Share"));
+        m_ui->bridgeTcpSpinBox->setEnabled(!isShared);
+        m_ui->bridgeWebSocketSpinBox->setEnabled(!isShared);
+    };
+
+    if (isChecked == false) {
+        QMetaObject::invokeMethod(
+            m_serialBridge, [bridge = m_serialBridge]() { bridge->stop(); }, Qt::BlockingQueuedConnection);
+        m_logModel->append(LogModel::Status, tr("---- Serial port no longer shared ----"));
+        setShared(false);
+        return;
+    }
+
+    SerialBridge::Options options;
+    options.tcpPort       = quint16(m_ui->bridgeTcpSpinBox->value());
+    options.webSocketPort = quint16(m_ui->bridgeWebSocketSpinBox->value());
+    if (options.tcpPort == 0 && options.webSocketPort == 0) {
+        m_logModel->append(LogModel::Status, tr("**** Set a TCP or WebSocket port to share the serial port on ****"));
+        setShared(false);
+        return;
+    }
+
+    bool    isShared = false;
+    QString errorString;
+    QMetaObject::invokeMethod(
+        m_serialBridge,
+        [bridge = m_serialBridge, &options, &errorString, &isShared]() {
+            isShared = bridge->start(options, &errorString);
+        },
+        Qt::BlockingQueuedConnection);
+
+    if (isShared == false) {
+        m_logModel->append(LogModel::Status, tr("**** Unable to share the serial port: %1 ****").arg(errorString));
+        setShared(false);
+        return;
+    }
+
+    QStringList ports;
+    if (options.tcpPort != 0) ports << tr("TCP port %1").arg(options.tcpPort);
+    if (options.webSocketPort != 0) ports << tr("WebSocket port %1").arg(options.webSocketPort);
+    m_logModel->append(LogModel::Status, tr("---- Serial port shared on %1 ----").arg(ports.join(u", "_s)));
+    setShared(true);
+}
+
+void Widget::searchLog() {
+    const auto mode = LogSearch::Mode(m_ui->searchModeComboBox->currentIndex());
+    QString    errorString;
+    if (m_logSearch->setQuery(m_ui->searchLineEdit->text(), mode, &errorString) == false) {
+        // Nothing is shown as matching a query that cannot be run
+        m_logSearch->setQuery(QString(), mode);
+        m_ui->searchStatusLabel->setText(errorString);
+    }
+    m_ui->searchFilterBox->setEnabled(m_logSearch->isActive());
+    if (m_logSearch->isActive() == false) m_ui->searchFilterBox->setChecked(false);
+}
+
+void Widget::updateSearchStatus() {
+    if (m_logSearch->isActive() == false) {
+        if (m_ui->searchLineEdit->text().isEmpty() == true) m_ui->searchStatusLabel->clear();
+        return;
+    }
+    QString text = tr("%1 matches").arg(m_logSearch->matchCount());
+    if (m_logSearch->isScanning() == true) text += tr(", searching...");
+    m_ui->searchStatusLabel->setText(text);
+}
+
+void Widget::findMatch(bool isForward) {
+    LogView   *view       = m_ui->dataLogView;
+    const bool isFiltered = (view->model() == m_logSearch);
+
+    // On from the selected line, else from the start or the end of the log
+    int logRow = view->currentRow();
+    if (isFiltered == true && logRow >= 0) logRow = m_logSearch->logRow(logRow);
+    if (logRow < 0) logRow = (isForward == true) ? -1 : m_logModel->rowCount();
+
+    const int match = (isForward == true) ? m_logSearch->nextMatch(logRow) : m_logSearch->previousMatch(logRow);
+    if (match >= 0) view->selectRow((isFiltered == true) ? m_logSearch->row(match) : match);
+}
+
+void Widget::updatePortList() {
+    // The list is frozen while a port is open, it shows which one
+    if (m_isPortOpened == true) return;
+
+    // Filled in one go, the popup is measured when it is opened
+    QComboBox    *comboBox = m_ui->serialPortComboxBox;
+    const QString current  = comboBox->currentText().split(" ")[0];
+    QStringList   items;
+    int           currentIndex = -1;
+    for (const QSerialPortInfo &info : m_portMonitor->ports()) {
+        if (info.portName() == current) currentIndex = int(items.size());
+        items << info.portName() + " #" + info.description();
+    }
+    comboBox->clear();
+    comboBox->addItems(items);
+    if (currentIndex >= 0) comboBox->setCurrentIndex(currentIndex);
+    if (m_unsizedComboBoxes.contains(comboBox) == false) m_unsizedComboBoxes << comboBox;
+}
+
+void Widget::portReconnected(const QString &portName, qint64 downtime_ms) {
+    // The device may have come back under another name
+    m_session->setName(portName);
+    m_metrics->setPortName(portName);
+    m_logModel->append(LogModel::Status,
+                       tr("---- Serial port %1 reopened after %2 ms ----").arg(portName).arg(downtime_ms));
+}
+
+void Widget::applyFraming() {
+    Framer::Options options;
+    options.type      = Framer::Type(m_ui->framingComboBox->currentIndex());
+    options.delimiter = Sequence::unescape(m_ui->delimiterLineEdit->text().toUtf8());
+    if (options.delimiter.isEmpty() == true) options.delimiter = "\n";
+
+    // The packet gap only matters while framing by time
+    m_ui->packetGapSpinBox->setEnabled(options.type == Framer::PacketGap);
+    m_ui->delimiterLineEdit->setEnabled(options.type == Framer::Delimiter);
+
+    QMetaObject::invokeMethod(m_serialWorker, [this, options]() { m_serialWorker->setFraming(options); });
+    qDebug("framing = %d", int(options.type));
+}
+
+void Widget::loadDissector() {
+    const QString fileName = QFileDialog::getOpenFileName(this, tr("Load Field Layout"), QString(),
+                                                          tr("Field Layout (*.json);;All Files (*)"));
+    if (fileName.isEmpty() == true) return;
+
+    QString                    errorString;
+    std::unique_ptr<Dissector> dissector = Dissector::load(fileName, &errorString);
+    if (dissector == nullptr) {
+        QString s = tr("**** Unable to load %1: %2 ****").arg(QDir::toNativeSeparators(fileName), errorString);
+        m_logModel->append(LogModel::Status, s);
+        return;
+    }
+
+    // Selecting it takes the new entry from the list, so it goes in there first
+    m_dissectors.push_back(std::move(dissector));
+    m_ui->dissectorComboBox->addItem(m_dissectors.back()->name());
+    m_ui->dissectorComboBox->setCurrentIndex(m_ui->dissectorComboBox->count() - 1);
+}
+
+void Widget::openSession() {
+    const QString fileName =
+        QFileDialog::getOpenFileName(this, tr("Open Session"), QString(), tr("ComPort Session (*.cps)"));
+    if (fileName.isEmpty() == true) return;
+
+    QString errorString;
+    auto   *viewer = new SessionViewer(m_serialWorker, this);
+    if (viewer->open(fileName, &errorString) == false) {
+        delete viewer;
+        QMessageBox::information(this, "Hint", tr("Unable to open %1: %2").arg(fileName, errorString));
+        return;
+    }
+    viewer->show();
+}
+
+void Widget::showMetrics() {
+    // One panel per port, it only reads the collector which keeps sampling while it is closed
+    if (m_metricsPanel == nullptr) {
+        m_metricsPanel = new MetricsPanel(m_metrics, this);
+        m_metricsPanel->setAttribute(Qt::WA_DeleteOnClose);
+        m_metricsPanel->setWindowTitle(tr("Metrics - %1").arg(m_session->name()));
+    }
+    m_metricsPanel->show();
+    m_metricsPanel->raise();
+    m_metricsPanel->activateWindow();
+}
+
+void Widget::writeSerialPort(const QByteArray &data, const QString &label, const QString &logText) {
+    // The time stamp is the one the recording and chunkWritten have, not when the button was pressed
+    QMetaObject::invokeMethod(m_serialWorker, [this, data, label, logText]() {
+        const SerialWriteTime time = m_serialWorker->write(data);
+        if (time.timestampNs == 0) return;  // the port closed in the meantime
+
+        QMetaObject::invokeMethod(this, [this, time, label, logText]() {
+            m_logModel->appendTimestamp(time.timestampNs, time.realtimeNs, label);
+            m_logModel->append(LogModel::Transmitted, logText);
+        });
+    });
+}
+
 void Widget::sendButton_clicked() {
-    if (m_serialPort->isOpen() == true) {
+    if (m_serialWorker->isOpen() == true) {
         if (m_ui->isPeriodCheckBox->isChecked() == true) {
-            if (m_repetitionTimer->isActive() == false) {
-                if (m_repetition_ms > 0) {
+            if (m_transmitScheduler->isRunning() == false) {
+                if (m_repetitionPeriod_us <= 0) {
+                    m_ui->isPeriodCheckBox->setChecked(false);
+                    transmitMessage();
+                } else if (startPeriodicTransmit() == true) {
                     m_ui->sendPushButton->setText("Stop");
                     m_ui->dataSendLineEdit->setEnabled(false);
                     m_ui->isPeriodCheckBox->setEnabled(false);
-                    m_repetitionTimer->start(m_repetition_ms);
-                } else {
-                    m_ui->isPeriodCheckBox->setChecked(false);
                 }
-                transmitMessage();
             } else {
                 m_ui->sendPushButton->setText("Send");
                 m_ui->dataSendLineEdit->setEnabled(true);
                 m_ui->isPeriodCheckBox->setEnabled(true);
-                m_repetitionTimer->stop();
+                m_transmitScheduler->stop();
             }
         } else {
             if (m_ui->dataSendLineEdit->isEnabled() == false) {
@@ -520,6 +1037,16 @@ void Widget::sendButton_clicked() {
     }
 }
 
+bool Widget::eventFilter(QObject *watched, QEvent *event) {
+    // Every way of opening the popup starts with a press
+    const bool isPress  = event->type() == QEvent::MouseButtonPress || event->type() == QEvent::KeyPress;
+    auto      *comboBox = qobject_cast<QComboBox *>(watched);
+    if (isPress == true && comboBox != nullptr && m_unsizedComboBoxes.removeOne(comboBox) == true) {
+        adjustComboBoxViewWidth(comboBox);
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
 void Widget::adjustComboBoxViewWidth(QComboBox *combox) {
     QFontMetrics fm(combox->font());
     QRect        rect;
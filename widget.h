@@ -5,8 +5,15 @@
 #include <QButtonGroup>
 #include <QComboBox>
 #include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileDialog>
 #include <QMessageBox>
+#include <QPointer>
 #include <QScrollBar>
+#include <QSettings>
+#include <QShortcut>
+#include <QThread>
 #include <QTime>
 #include <QTimer>
 #include <QValidator>
@@ -14,6 +21,25 @@
 #include <QtSerialPort/QSerialPort>
 #include <QtSerialPort/QSerialPortInfo>
 
+#include "checksum.h"
+#include "dissector.h"
+#include "filesender.h"
+#include "hexdump.h"
+#include "logmodel.h"
+#include "logsearch.h"
+#include "logview.h"
+#include "metrics.h"
+#include "metricspanel.h"
+#include "portmonitor.h"
+#include "portreconnector.h"
+#include "serialsession.h"
+#include "sequencerunner.h"
+#include "serialbridge.h"
+#include "serialworker.h"
+#include "sessionviewer.h"
+#include "transmitscheduler.h"
+#include "triggercapture.h"
+
 QT_BEGIN_NAMESPACE
 namespace Ui {
 class Widget;
@@ -33,14 +59,39 @@ class Widget : public QWidget {
     Q_OBJECT
 
    public:
-    Widget(QWidget *parent = nullptr);
+    Widget(SerialSession *session, PortMonitor *portMonitor, QWidget *parent = nullptr);
     ~Widget();
 
+    SerialSession *session() const { return m_session; }
+
+   signals:
+    // Every packet taken from the worker, also those that are frozen or sampled away
+    void packetReceived(const SerialPacket &packet);
+
+   protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
    private slots:
     void displayTime();
     void receiveMessage();
     void transmitMessage();
     void sendButton_clicked();
+    void recordSession(bool isChecked);
+    void openSession();
+    void applyFraming();
+    void transmitSummary(const QString &text, bool isFinal);
+    void runSequence(bool isChecked);
+    void sequenceFinished(const QStringList &report);
+    void showMetrics();
+    void sendFile(bool isChecked);
+    void sendFileFinished(const QString &report);
+    void searchLog();
+    void updateSearchStatus();
+    void updatePortList();
+    void portReconnected(const QString &portName, qint64 downtime_ms);
+    void loadDissector();
+    void armTrigger(bool isChecked);
+    void shareSerialPort(bool isChecked);
 
    private:
     Ui::Widget *m_ui;
@@ -48,22 +99,65 @@ class Widget : public QWidget {
     void initialization();
     void openSerialPort();
     void adjustComboBoxViewWidth(QComboBox *);
+    // The last used port and line settings, shared by all tabs
+    void restoreSettings();
+    void saveSettings() const;
+    // Logged under label once the worker wrote it, with the time it did
+    void writeSerialPort(const QByteArray &data, const QString &label, const QString &logText);
+    bool startPeriodicTransmit();
+    // The send field encoded for the current mode, cached until the text or mode changes
+    const QByteArray &sendPayload();
+    void scheduleRender();
+    void findMatch(bool isForward);
+
+    SerialSession      *m_session            = nullptr;
+    SerialWorker       *m_serialWorker       = nullptr;
+    PortMonitor        *m_portMonitor        = nullptr;
+    PortReconnector    *m_portReconnector    = nullptr;
+    TransmitScheduler  *m_transmitScheduler  = nullptr;
+    SequenceRunner     *m_sequenceRunner     = nullptr;  // lives in the worker thread
+    FileSender         *m_fileSender         = nullptr;  // lives in the worker thread
+    TriggerCapture     *m_triggerCapture     = nullptr;  // lives in the worker thread
+    SerialBridge       *m_serialBridge       = nullptr;  // lives in the worker thread
+    QTimer             *m_displayTimeTimer   = nullptr;
+    QTimer             *m_renderTimer        = nullptr;
+    LogModel           *m_logModel           = nullptr;
+    LogSearch          *m_logSearch          = nullptr;
+    MetricsCollector   *m_metrics            = nullptr;
+    HexStringValidator *m_hexStringValidator = nullptr;
+
+    QPointer<MetricsPanel> m_metricsPanel;
+
+    // Popups measured when they are next opened, not every time their items change
+    QList<QComboBox *> m_unsizedComboBoxes;
+
+    std::vector<std::unique_ptr<Dissector>> m_dissectors;  // the decode choices after None, in order
+    const Dissector                        *m_dissector = nullptr;
+    Dissector::Dissection                   m_dissection;  // reused for every received packet
+
+    QString          m_portName;
+    QString          m_currentTime;
+    QByteArray       m_hexBuffer;  // reused for every received packet
+    QByteArray       m_sendPayload;
+    QString          m_sendLogText;    // how the payload is shown in the log
+    QString          m_sendFieldText;  // the same without the checksum, as the send field shows it
+    HexDump::Options m_hexDumpOptions;
+    QElapsedTimer    m_throughputTimer;
+    QElapsedTimer    m_renderClock;  // since received packets were last drawn
+    quint64          m_lastBytesReceived = 0;
+
+    bool m_isRecvHexEnabled   = false;
+    bool m_isSendHexEnabled   = false;
+    bool m_isFreezeWindows    = false;
+    bool m_isDisplaySampled   = false;
+    bool m_isSendPayloadValid = false;
+    bool m_isPortOpened       = false;
+    int  m_prevSendHexEnabled = -1;
+
+    qint64 m_repetitionPeriod_us = 0;
 
-    QSerialPort        *m_serialPort          = nullptr;
-    QTimer             *m_receiveMessageTimer = nullptr;
-    QTimer             *m_repetitionTimer     = nullptr;
-    QTimer             *m_displayTimeTimer    = nullptr;
-    HexStringValidator *m_hexStringValidator  = nullptr;
-
-    QString m_portName;
-    QString m_currentTime;
-
-    bool m_isRecvHexEnabled     = false;
-    bool m_isSendHexEnabled     = false;
-    bool m_isFreezeWindows      = false;
-    int  m_numberPacketReceived = 0;
-    int  m_numberPacketWritten  = 0;
-    int  m_repetition_ms        = 0;
+    Checksum::Type m_sendChecksum = Checksum::None;  // appended to what is sent
+    Checksum::Type m_recvChecksum = Checksum::None;  // checked on every received frame
 };
 
 #endif  // WIDGET_H